@@ -17,8 +17,28 @@ CONFIG += silent
 # Don't allow deprecated versions of methods (before Qt 6.8)
 DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060800
 
-# Resources
-RESOURCES = GuessWord.qrc
+# No call tracing in release builds (see src/Tracing.h); profiling builds
+# (qmake CONFIG+=profiling) record calls in ring buffers instead, see
+# src/RingTracer.h and tools/TraceToChrome.cpp
+CONFIG(release, debug|release) {
+    profiling {
+        DEFINES += GUESSWORD_TRACE_LEVEL=1
+    } else {
+        DEFINES += GUESSWORD_TRACE_LEVEL=0
+    }
+}
+
+# Resources (the dictionary blob, generated with its resource file)
+include(WordBlob.pri)
+
+# Converter for ring tracer dumps (not needed for the application; build
+# with "make trace_converter")
+trace_converter.target = $$OUT_PWD/build/TraceToChrome
+trace_converter.commands = \
+    $(CXX) $(CXXFLAGS) $(LFLAGS) \
+    -o $$OUT_PWD/build/TraceToChrome $$PWD/tools/TraceToChrome.cpp
+trace_converter.depends = $$PWD/tools/TraceToChrome.cpp
+QMAKE_EXTRA_TARGETS += trace_converter
 
 # Shared classes
 HEADERS += ../Shared/CallTracer.h
@@ -29,11 +49,45 @@ HEADERS += ../Shared/StringHelper.h
 SOURCES += ../Shared/StringHelper.cpp
 
 # Specific classes
+HEADERS += src/AliasSampler.h
+SOURCES += src/AliasSampler.cpp
 HEADERS += src/AllWords.h
 SOURCES += src/AllWords.cpp
 HEADERS += src/Application.h
 SOURCES += src/Application.cpp
+HEADERS += src/AsyncMessageLogger.h
+SOURCES += src/AsyncMessageLogger.cpp
+HEADERS += src/BitVector.h
+SOURCES += src/BitVector.cpp
+HEADERS += src/CallProfiler.h
+SOURCES += src/CallProfiler.cpp
+HEADERS += src/CandidateFilter.h
+SOURCES += src/CandidateFilter.cpp
 HEADERS += src/Deploy.h
+HEADERS += src/Feedback.h
+SOURCES += src/Feedback.cpp
+HEADERS += src/GameSession.h
+SOURCES += src/GameSession.cpp
+HEADERS += src/LatencyStatistics.h
+SOURCES += src/LatencyStatistics.cpp
 SOURCES += src/main.cpp
 HEADERS += src/MainWindow.h
 SOURCES += src/MainWindow.cpp
+HEADERS += src/ParallelLoop.h
+SOURCES += src/ParallelLoop.cpp
+HEADERS += src/RandomStream.h
+SOURCES += src/RandomStream.cpp
+HEADERS += src/RenderScheduler.h
+SOURCES += src/RenderScheduler.cpp
+HEADERS += src/RingTracer.h
+SOURCES += src/RingTracer.cpp
+HEADERS += src/Solver.h
+SOURCES += src/Solver.cpp
+HEADERS += src/TileCache.h
+SOURCES += src/TileCache.cpp
+HEADERS += src/TracedCall.h
+SOURCES += src/TracedCall.cpp
+HEADERS += src/Tracing.h
+HEADERS += src/WordBlob.h
+HEADERS += src/WordGraph.h
+SOURCES += src/WordGraph.cpp
@@ -0,0 +1,42 @@
+# Dictionary blob: the word list is validated, deduplicated, sorted and
+# hashed at build time, and the result is embedded as resources/Words.blob
+# through a resource file written next to it. Both are in the build
+# directory, so shadow builds work. The compiler only needs the standard
+# library, so it is built first. Shared by the application, the
+# simulation (simulation/GuessWordSimulation.pro), the benchmark suite
+# (benchmark/GuessWordBenchmark.pro), the server (server/GuessWordServer.pro)
+# and its load generator (loadgenerator/GuessWordLoadGenerator.pro).
+WORD_BLOB_COMPILER = $$OUT_PWD/build/WordBlobCompiler
+word_blob_compiler.target = $$WORD_BLOB_COMPILER
+word_blob_compiler.commands = \
+    $(CXX) $(CXXFLAGS) $(LFLAGS) -I$$PWD/src \
+    -o $$WORD_BLOB_COMPILER $$PWD/tools/WordBlobCompiler.cpp
+word_blob_compiler.depends = \
+    $$PWD/tools/WordBlobCompiler.cpp $$PWD/src/WordBlob.h
+QMAKE_EXTRA_TARGETS += word_blob_compiler
+
+WORD_LISTS = $$PWD/resources/Words.txt
+word_blob.input = WORD_LISTS
+word_blob.output = $$OUT_PWD/build/${QMAKE_FILE_BASE}.blob
+word_blob.commands = $$WORD_BLOB_COMPILER ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+word_blob.depends = $$WORD_BLOB_COMPILER
+word_blob.CONFIG += no_link target_predeps
+QMAKE_EXTRA_COMPILERS += word_blob
+
+# Resource file (paths in it are relative to its own location)
+WORD_BLOB_QRC = $$OUT_PWD/build/Words.qrc
+WORD_BLOB_FILE = \
+    "<file alias=\"resources/Words.blob\" compression-algorithm=\"none\">"
+WORD_BLOB_QRC_LINES = \
+    "<!DOCTYPE RCC><RCC version=\"1.0\">" \
+    "<qresource>" \
+    "    $${WORD_BLOB_FILE}Words.blob</file>" \
+    "</qresource>" \
+    "</RCC>"
+!write_file($$WORD_BLOB_QRC, WORD_BLOB_QRC_LINES) {
+    error("Could not write $$WORD_BLOB_QRC")
+}
+RESOURCES += $$WORD_BLOB_QRC
+
+# Resources can only be compiled once the blob is there
+rcc.depends += $$OUT_PWD/build/Words.blob
@@ -0,0 +1,459 @@
+// GuessWordBenchmark.cpp
+// Microbenchmarks for the dictionary and game hot paths: time per
+// operation, heap allocations per operation and peak resident set size.
+// Results are printed as a table and, if a file name is given, written as
+// JSON (one object per benchmark) for tracking regressions.
+//
+// Learned words go to Qt's test mode data directory (which is removed before
+// and after), so the user's journal is never touched.
+//
+// Usage: GuessWordBenchmark [JSON file]
+
+// Project includes
+#include "AllWords.h"
+#include "CandidateFilter.h"
+#include "Feedback.h"
+#include "GameSession.h"
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QStandardPaths>
+#include <QString>
+#include <QSysInfo>
+
+// System includes
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+
+// Heap allocations so far. On glibc, malloc itself is replaced, so
+// allocations inside Qt (e.g. QString data) count, too; elsewhere, only
+// operator new is counted.
+static std::atomic < quint64 > s_NumberOfAllocations { 0 };
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void * __libc_malloc(size_t mSize);
+    void * __libc_calloc(size_t mNumber, size_t mSize);
+    void * __libc_realloc(void * mpMemory, size_t mSize);
+    void __libc_free(void * mpMemory);
+
+    void * malloc(size_t mSize)
+    {
+        s_NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(mSize);
+    }
+    void * calloc(size_t mNumber, size_t mSize)
+    {
+        s_NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(mNumber, mSize);
+    }
+    void * realloc(void * mpMemory, size_t mSize)
+    {
+        s_NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(mpMemory, mSize);
+    }
+    void free(void * mpMemory)
+    {
+        __libc_free(mpMemory);
+    }
+}
+#else
+void * operator new(size_t mSize)
+{
+    s_NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+    void * memory = std::malloc(mSize ? mSize : 1);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void operator delete(void * mpMemory) noexcept
+{
+    std::free(mpMemory);
+}
+void operator delete(void * mpMemory, size_t) noexcept
+{
+    std::free(mpMemory);
+}
+#endif
+
+
+
+// Results so far
+static QJsonArray s_Results;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Peak resident set size (in bytes)
+static qint64 GetPeakResidentSetSize()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+        sizeof(counters)))
+    {
+        return 0;
+    }
+    return qint64(counters.PeakWorkingSetSize);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(Q_OS_MACOS)
+    // Bytes
+    return qint64(usage.ru_maxrss);
+#else
+    // Kilobytes
+    return qint64(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Run mcrOperation(index) for all indices [0, mcNumberOfOperations) and
+// record time and allocations per operation
+static void Measure(const QString mcName, const int mcNumberOfOperations,
+    const std::function < void(int) > & mcrOperation)
+{
+    const quint64 allocations_before =
+        s_NumberOfAllocations.load(std::memory_order_relaxed);
+    QElapsedTimer timer;
+    timer.start();
+    for (int index = 0;
+         index < mcNumberOfOperations;
+         index++)
+    {
+        mcrOperation(index);
+    }
+    const qint64 nanoseconds = timer.nsecsElapsed();
+    const quint64 allocations =
+        s_NumberOfAllocations.load(std::memory_order_relaxed) -
+        allocations_before;
+
+    const double ns_per_op = double(nanoseconds) / mcNumberOfOperations;
+    const double allocations_per_op =
+        double(allocations) / mcNumberOfOperations;
+    const qint64 peak_rss = GetPeakResidentSetSize();
+    qDebug().noquote() << QString("%1%2 ns/op%3 allocs/op%4 MiB peak RSS")
+        .arg(mcName.leftJustified(32, ' '),
+             QString::number(ns_per_op, 'f', 1).rightJustified(14, ' '),
+             QString::number(allocations_per_op, 'f', 2)
+                .rightJustified(10, ' '),
+             QString::number(peak_rss / 1048576., 'f', 1)
+                .rightJustified(8, ' '));
+
+    QJsonObject result;
+    result["name"] = mcName;
+    result["operations"] = mcNumberOfOperations;
+    result["ns_per_op"] = ns_per_op;
+    result["allocations_per_op"] = allocations_per_op;
+    result["peak_rss_bytes"] = double(peak_rss);
+    s_Results << result;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    QCoreApplication app(mNumParameters, mpParameter);
+    const QString json_filename =
+        mNumParameters > 1 ? QString(mpParameter[1]) : QString();
+
+    // Keep learned words away from the user's data
+    QStandardPaths::setTestModeEnabled(true);
+    QDir data_directory(
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    data_directory.removeRecursively();
+
+    // == InitWords
+    AllWords * aw = nullptr;
+    Measure("InitWords (cold)", 1,
+        [&](const int)
+        {
+            aw = AllWords::Instance();
+        });
+    Measure("InitWords (warm)", 10,
+        [&](const int)
+        {
+            aw -> InitWords();
+        });
+
+    // Sample of valid words (five letters, as in the game) and of words that
+    // are not valid
+    const int num_five = aw -> GetSlabSize(5);
+    const quint32 * five_ids = aw -> GetSlabIDs(5);
+    QList < QString > words;
+    for (int index = 0;
+         index < 1024;
+         index++)
+    {
+        words << aw -> GetWordText(five_ids[(index * 7919) % num_five]);
+    }
+    QList < QString > mixed_words = words;
+    for (int index = 0;
+         index < mixed_words.size();
+         index += 2)
+    {
+        mixed_words[index][0] = QChar('q');
+        mixed_words[index][1] = QChar('x');
+    }
+    QList < QByteArray > mixed_bytes;
+    for (const QString & word : std::as_const(mixed_words))
+    {
+        mixed_bytes << word.toLatin1();
+    }
+
+    // == IsValid, HasDuplicateLetters
+    Measure("IsValid (QString)", 2000000,
+        [&](const int mcIndex)
+        {
+            aw -> IsValid(mixed_words[mcIndex % 1024]);
+        });
+    Measure("IsValid (characters)", 2000000,
+        [&](const int mcIndex)
+        {
+            const QByteArray & word = mixed_bytes[mcIndex % 1024];
+            aw -> IsValid(word.constData(), int(word.size()));
+        });
+    Measure("HasDuplicateLetters", 2000000,
+        [&](const int mcIndex)
+        {
+            aw -> HasDuplicateLetters(words[mcIndex % 1024]);
+        });
+
+    // == GetWord with some of the words already used (same words every run)
+    aw -> SetSeed(1);
+    for (const int fill_percent : { 0, 50, 90, 99 })
+    {
+        aw -> ResetUsage();
+        const int num_available = aw -> GetNumberOfAvailableWords();
+        const int num_used = qint64(num_available) * fill_percent / 100;
+        for (int index = 0;
+             index < num_used;
+             index++)
+        {
+            aw -> GetWord();
+        }
+        const int num_picks =
+            qBound(1, (num_available - num_used) / 2, 1000);
+        Measure(QString("GetWord (%1% used)").arg(fill_percent), num_picks,
+            [&](const int)
+            {
+                aw -> GetWord();
+            });
+    }
+
+    // Same with very uneven (Zipf like) weights, as corpus frequencies are
+    QList < float > weights;
+    for (quint32 word_id = 0;
+         word_id < quint32(aw -> GetNumberOfWords());
+         word_id++)
+    {
+        weights << aw -> GetWordWeight(word_id);
+        aw -> SetWordWeight(word_id, 1.0f / (1 + word_id % 1000));
+    }
+    aw -> ResetUsage();
+    Measure("GetWord (weighted)", qBound(1,
+        aw -> GetNumberOfAvailableWords() / 2, 1000),
+        [&](const int)
+        {
+            aw -> GetWord();
+        });
+    for (quint32 word_id = 0;
+         word_id < quint32(weights.size());
+         word_id++)
+    {
+        aw -> SetWordWeight(word_id, weights[word_id]);
+    }
+    aw -> ResetUsage();
+    Measure("GetWordForGame", 1000000,
+        [&](const int mcIndex)
+        {
+            aw -> GetWordIDForGame(1, quint64(mcIndex));
+        });
+
+    // == Learning words, one by one and in bulk
+    QList < QString > new_words;
+    QSet < QString > new_word_set;
+    quint32 state = 12345;
+    while (new_words.size() < 10100)
+    {
+        QString word;
+        for (int index = 0;
+             index < 9;
+             index++)
+        {
+            state = state * 1103515245 + 12345;
+            word += QChar('a' + (state >> 16) % 26);
+        }
+        if (!aw -> IsValid(word) &&
+            !new_word_set.contains(word))
+        {
+            new_words << word;
+            new_word_set.insert(word);
+        }
+    }
+    Measure("AddWord", 100,
+        [&](const int mcIndex)
+        {
+            aw -> AddWord(new_words[mcIndex]);
+        });
+    const QString list_filename = data_directory.filePath("Benchmark.txt");
+    data_directory.mkpath(".");
+    QFile list_file(list_filename);
+    if (list_file.open(QIODevice::WriteOnly))
+    {
+        list_file.write(new_words.mid(100).join("\n").toLatin1());
+        list_file.close();
+    }
+    qint64 num_loaded = 0;
+    Measure("LoadWordList (one call)", 1,
+        [&](const int)
+        {
+            num_loaded = aw -> LoadWordList(list_filename);
+        });
+    if (num_loaded != new_words.size() - 100)
+    {
+        qDebug().noquote() << QString("LoadWordList added %1 words, "
+            "expected %2.")
+            .arg(QString::number(num_loaded),
+                 QString::number(new_words.size() - 100));
+    }
+
+    // == Submitting a try as done by MainWindow::CheckNewTry() (without the
+    // dialogs and drawing); a game is six tries
+    CandidateFilter filter;
+    GameSession session;
+    quint8 guess_letters[Feedback::MAXIMUM_WORD_LENGTH];
+    Measure("CheckNewTry (scoring)", 60000,
+        [&](const int mcIndex)
+        {
+            if (mcIndex % 6 == 0 ||
+                session.IsFinished())
+            {
+                filter.Reset(5);
+                session.Start(aw -> GetWordID(words[(mcIndex / 6) % 1024]));
+            }
+            AllWords::EncodeWord(words[(mcIndex * 31) % 1024], guess_letters);
+            if (session.Submit(guess_letters) == GameSession::Submit_Accepted)
+            {
+                filter.AddGuess(guess_letters,
+                    session.GetTryCode(0, session.GetNumberOfTries() - 1));
+            }
+        });
+
+    // == Typing: five letters of a word, then deleting them again (checks
+    // if the try can still become a word on every key)
+    session.Start(aw -> GetWordID(words[0]));
+    Measure("GameSession (keystroke)", 1000000,
+        [&](const int mcIndex)
+        {
+            const int step = mcIndex % 10;
+            if (step == 0)
+            {
+                AllWords::EncodeWord(words[(mcIndex / 10) % 1024],
+                    guess_letters);
+            }
+            if (step < 5)
+            {
+                session.AddLetter(guess_letters[step]);
+            } else
+            {
+                session.RemoveLetter();
+            }
+        });
+
+    // == A try on 16 boards at once (one batched scoring call and the
+    // combined alphabet)
+    const int num_boards = GameSession::MAXIMUM_NUMBER_OF_BOARDS;
+    quint32 board_ids[num_boards];
+    Measure("CheckNewTry (16 boards)", 60000,
+        [&](const int mcIndex)
+        {
+            if (mcIndex % 6 == 0 ||
+                session.IsFinished())
+            {
+                for (int board = 0;
+                     board < num_boards;
+                     board++)
+                {
+                    board_ids[board] = five_ids[
+                        (mcIndex * num_boards + board * 7919) % num_five];
+                }
+                session.Start(board_ids, num_boards);
+            }
+            AllWords::EncodeWord(words[(mcIndex * 31) % 1024], guess_letters);
+            session.Submit(guess_letters);
+        });
+
+    // == One guess against all words of five letters
+    const quint8 * answers = aw -> GetSlabLetters(5);
+    QList < quint32 > codes(num_five);
+    Measure(QString("ScoreBatchScalar (%1 words)").arg(num_five), 2000,
+        [&](const int mcIndex)
+        {
+            Feedback::ScoreBatchScalar(answers + (mcIndex % num_five) * 5,
+                answers, num_five, 5, codes.data());
+        });
+    Measure(QString("ScoreBatchSimd (%1 words)").arg(num_five), 2000,
+        [&](const int mcIndex)
+        {
+            Feedback::ScoreBatchSimd(answers + (mcIndex % num_five) * 5,
+                answers, num_five, 5, codes.data());
+        });
+
+    // Leave nothing behind
+    aw -> FlushJournal();
+    data_directory.removeRecursively();
+
+    // Machine readable results
+    if (!json_filename.isEmpty())
+    {
+        QJsonObject report;
+        report["timestamp"] =
+            QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["qt_version"] = QString(qVersion());
+        report["cpu"] = QSysInfo::currentCpuArchitecture();
+        report["os"] = QSysInfo::prettyProductName();
+        report["benchmarks"] = s_Results;
+        QFile json_file(json_filename);
+        if (!json_file.open(QIODevice::WriteOnly) ||
+            json_file.write(QJsonDocument(report).toJson()) < 0)
+        {
+            qDebug().noquote() << QString("Could not write \"%1\".")
+                .arg(json_filename);
+            return 1;
+        }
+    }
+
+    return 0;
+}
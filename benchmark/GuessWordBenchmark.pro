@@ -0,0 +1,72 @@
+# Benchmark suite: dictionary and game hot paths (time and allocations per
+# operation, peak RSS; optionally as JSON)
+
+# Where files can be found
+INCLUDEPATH += ../src/
+INCLUDEPATH += ../../Shared/
+
+# Where files go
+OBJECTS_DIR = build/
+MOC_DIR = build/
+
+# Frameworks and compiler
+TEMPLATE = app
+TARGET = GuessWordBenchmark
+QT += gui
+QT += widgets
+CONFIG += c++17
+CONFIG += release
+CONFIG += silent
+CONFIG += console
+CONFIG -= app_bundle
+
+# Don't allow deprecated versions of methods (before Qt 6.8)
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060800
+
+# No call tracing in release builds (see ../src/Tracing.h)
+CONFIG(release, debug|release): DEFINES += GUESSWORD_TRACE_LEVEL=0
+
+# Peak memory on Windows
+win32: LIBS += -lpsapi
+
+# Resources (the dictionary blob, generated with its resource file)
+include(../WordBlob.pri)
+
+# Shared classes
+HEADERS += ../../Shared/CallTracer.h
+SOURCES += ../../Shared/CallTracer.cpp
+HEADERS += ../../Shared/MessageLogger.h
+SOURCES += ../../Shared/MessageLogger.cpp
+HEADERS += ../../Shared/StringHelper.h
+SOURCES += ../../Shared/StringHelper.cpp
+
+# Specific classes
+HEADERS += ../src/AliasSampler.h
+SOURCES += ../src/AliasSampler.cpp
+HEADERS += ../src/AllWords.h
+SOURCES += ../src/AllWords.cpp
+HEADERS += ../src/AsyncMessageLogger.h
+SOURCES += ../src/AsyncMessageLogger.cpp
+HEADERS += ../src/BitVector.h
+SOURCES += ../src/BitVector.cpp
+HEADERS += ../src/CallProfiler.h
+SOURCES += ../src/CallProfiler.cpp
+HEADERS += ../src/CandidateFilter.h
+SOURCES += ../src/CandidateFilter.cpp
+HEADERS += ../src/Feedback.h
+SOURCES += ../src/Feedback.cpp
+HEADERS += ../src/GameSession.h
+SOURCES += ../src/GameSession.cpp
+HEADERS += ../src/ParallelLoop.h
+SOURCES += ../src/ParallelLoop.cpp
+HEADERS += ../src/RandomStream.h
+SOURCES += ../src/RandomStream.cpp
+HEADERS += ../src/RingTracer.h
+SOURCES += ../src/RingTracer.cpp
+HEADERS += ../src/TracedCall.h
+SOURCES += ../src/TracedCall.cpp
+HEADERS += ../src/Tracing.h
+HEADERS += ../src/WordBlob.h
+HEADERS += ../src/WordGraph.h
+SOURCES += ../src/WordGraph.cpp
+SOURCES += GuessWordBenchmark.cpp
@@ -0,0 +1,146 @@
+// TracingBenchmark.cpp
+// Cost of CALL_IN()/CALL_OUT() per call: the same functions with full
+// tracing (GUESSWORD_TRACE_LEVEL 2, debug builds; measured while disabled
+// at runtime, so the arguments are never formatted), with ring buffer
+// tracing (level 1, profiling builds; measured while recording) and with
+// tracing compiled out (level 0, release builds).
+//
+// Usage: TracingBenchmark
+
+// Project includes
+#include "RingTracer.h"
+#include "TracedCall.h"
+#include "TracingBenchmarkFunctions.h"
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+// System includes
+#include <functional>
+
+
+
+// Number of calls per measurement
+static const int NUMBER_OF_CALLS = 1000000;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Time per call (in nanoseconds)
+static double Measure(const std::function < int(int) > & mcrCall,
+    const int mcNumberOfCalls)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int result = 0;
+    for (int index = 0;
+         index < mcNumberOfCalls;
+         index++)
+    {
+        result += mcrCall(index);
+    }
+    const qint64 nanoseconds = timer.nsecsElapsed();
+
+    // Make sure the calls are not optimized away
+    if (result == -1)
+    {
+        qDebug() << result;
+    }
+    return double(nanoseconds) / mcNumberOfCalls;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Report a measurement
+static void Report(const QString mcWhat, const double mcTraced,
+    const double mcRing, const double mcUntraced)
+{
+    qDebug().noquote() << QString("%1: %2 ns traced (off), %3 ns ring "
+        "buffer, %4 ns untraced (tracing adds %5 ns / %6 ns per call)")
+        .arg(mcWhat.leftJustified(22, ' '),
+             QString::number(mcTraced, 'f', 1),
+             QString::number(mcRing, 'f', 1),
+             QString::number(mcUntraced, 'f', 1),
+             QString::number(mcTraced - mcUntraced, 'f', 1),
+             QString::number(mcRing - mcUntraced, 'f', 1));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    Q_UNUSED(mNumParameters)
+    Q_UNUSED(mpParameter)
+
+    // Typical arguments
+    const QList < QString > words { "cares", "apple", "crane", "sissy" };
+    QSet < int > selection;
+    for (int id = 1;
+         id <= 20;
+         id++)
+    {
+        selection.insert(id * 37);
+    }
+
+    // Ring buffer is measured while recording, full tracing while disabled
+    // (as it is unless GUESSWORD_TRACE_CALLS is set)
+    RingTracer::SetEnabled(true);
+    TracedCall::SetEnabled(false);
+
+    // == HasDuplicateLetters
+    double traced = Measure([&](const int mcIndex)
+        {
+            return int(Traced::HasDuplicateLetters(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    double ring = Measure([&](const int mcIndex)
+        {
+            return int(Ring::HasDuplicateLetters(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    double untraced = Measure([&](const int mcIndex)
+        {
+            return int(Untraced::HasDuplicateLetters(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    Report("HasDuplicateLetters", traced, ring, untraced);
+
+    // == IsValid
+    traced = Measure([&](const int mcIndex)
+        {
+            return int(Traced::IsValid(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    ring = Measure([&](const int mcIndex)
+        {
+            return int(Ring::IsValid(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    untraced = Measure([&](const int mcIndex)
+        {
+            return int(Untraced::IsValid(words[mcIndex % 4]));
+        }, NUMBER_OF_CALLS);
+    Report("IsValid", traced, ring, untraced);
+
+    // == SetSelection (20 IDs formatted and sorted)
+    traced = Measure([&](const int mcIndex)
+        {
+            Q_UNUSED(mcIndex)
+            return Traced::SetSelection(selection);
+        }, NUMBER_OF_CALLS / 10);
+    ring = Measure([&](const int mcIndex)
+        {
+            Q_UNUSED(mcIndex)
+            return Ring::SetSelection(selection);
+        }, NUMBER_OF_CALLS / 10);
+    untraced = Measure([&](const int mcIndex)
+        {
+            Q_UNUSED(mcIndex)
+            return Untraced::SetSelection(selection);
+        }, NUMBER_OF_CALLS / 10);
+    Report("SetSelection", traced, ring, untraced);
+
+    return 0;
+}
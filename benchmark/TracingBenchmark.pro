@@ -0,0 +1,48 @@
+# Benchmark: cost of call tracing per call (full, ring buffer, compiled out)
+
+# Where files can be found
+INCLUDEPATH += ../src/
+INCLUDEPATH += ../../Shared/
+
+# Where files go
+OBJECTS_DIR = build/
+MOC_DIR = build/
+
+# Frameworks and compiler
+TEMPLATE = app
+TARGET = TracingBenchmark
+QT += gui
+QT += widgets
+CONFIG += c++17
+CONFIG += release
+CONFIG += silent
+CONFIG += console
+CONFIG -= app_bundle
+
+# Don't allow deprecated versions of methods (before Qt 6.8)
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060800
+
+# No GUESSWORD_TRACE_LEVEL here: the function sources set their own
+
+# Shared classes
+HEADERS += ../../Shared/CallTracer.h
+SOURCES += ../../Shared/CallTracer.cpp
+HEADERS += ../../Shared/MessageLogger.h
+SOURCES += ../../Shared/MessageLogger.cpp
+HEADERS += ../../Shared/StringHelper.h
+SOURCES += ../../Shared/StringHelper.cpp
+
+# Specific classes
+HEADERS += ../src/CallProfiler.h
+SOURCES += ../src/CallProfiler.cpp
+HEADERS += ../src/RingTracer.h
+SOURCES += ../src/RingTracer.cpp
+HEADERS += ../src/TracedCall.h
+SOURCES += ../src/TracedCall.cpp
+HEADERS += ../src/Tracing.h
+SOURCES += TracingBenchmark.cpp
+HEADERS += TracingBenchmarkFunctions.h
+HEADERS += TracingBenchmarkFunctionsBody.h
+SOURCES += TracingBenchmarkRing.cpp
+SOURCES += TracingBenchmarkTraced.cpp
+SOURCES += TracingBenchmarkUntraced.cpp
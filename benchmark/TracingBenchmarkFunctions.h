@@ -0,0 +1,48 @@
+// TracingBenchmarkFunctions.h
+// The same functions, compiled with full tracing
+// (TracingBenchmarkTraced.cpp), ring buffer tracing
+// (TracingBenchmarkRing.cpp) and without tracing
+// (TracingBenchmarkUntraced.cpp). They live in separate translation units
+// so the compiler cannot inline them into the benchmark loop, just like
+// calls between classes of the application.
+
+#ifndef TRACINGBENCHMARKFUNCTIONS_H
+#define TRACINGBENCHMARKFUNCTIONS_H
+
+// Qt includes
+#include <QSet>
+#include <QString>
+
+
+
+// Traced (GUESSWORD_TRACE_LEVEL 2)
+namespace Traced
+{
+    // Same as AllWords::HasDuplicateLetters()
+    bool HasDuplicateLetters(const QString mcWord);
+
+    // Word check with a trivial body (i.e. mostly tracing)
+    bool IsValid(const QString mcWord);
+
+    // Sorted ID list formatted within CALL_IN() (by a lambda, so only
+    // while tracing is enabled)
+    int SetSelection(const QSet < int > mcNewSelectedIDs);
+}
+
+// Ring buffer (GUESSWORD_TRACE_LEVEL 1)
+namespace Ring
+{
+    bool HasDuplicateLetters(const QString mcWord);
+    bool IsValid(const QString mcWord);
+    int SetSelection(const QSet < int > mcNewSelectedIDs);
+}
+
+// Compiled out (GUESSWORD_TRACE_LEVEL 0)
+namespace Untraced
+{
+    bool HasDuplicateLetters(const QString mcWord);
+    bool IsValid(const QString mcWord);
+    int SetSelection(const QSet < int > mcNewSelectedIDs);
+}
+
+#endif
@@ -0,0 +1,90 @@
+// TracingBenchmarkFunctionsBody.h
+// Definitions of the functions in TracingBenchmarkFunctions.h. Included
+// (deliberately without include guard) by TracingBenchmarkTraced.cpp,
+// TracingBenchmarkRing.cpp and TracingBenchmarkUntraced.cpp after they set
+// GUESSWORD_TRACE_LEVEL and TRACING_BENCHMARK_NAMESPACE.
+
+// Project includes
+#include "TracingBenchmarkFunctions.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QList>
+
+// System includes
+#include <algorithm>
+
+
+
+namespace TRACING_BENCHMARK_NAMESPACE
+{
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word has duplicate letters
+bool HasDuplicateLetters(const QString mcWord)
+{
+    CALL_IN(QString("mcWord=\"%1\"")
+        .arg(mcWord));
+
+    // Letters a-z: keep track of what we have seen in a bit mask
+    quint32 letters_used = 0;
+    for (int index = 0;
+         index < mcWord.size();
+         index++)
+    {
+        const char16_t letter = mcWord[index].unicode();
+        if (letter < 'a' || letter > 'z')
+        {
+            continue;
+        }
+        const quint32 bit = quint32(1) << (letter - 'a');
+        if (letters_used & bit)
+        {
+            CALL_OUT("");
+            return true;
+        }
+        letters_used |= bit;
+    }
+
+    CALL_OUT("");
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word is valid
+bool IsValid(const QString mcWord)
+{
+    CALL_IN(QString("mcWord=\"%1\"")
+        .arg(mcWord));
+
+    CALL_OUT("");
+    return !mcWord.isEmpty();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Set selection
+int SetSelection(const QSet < int > mcNewSelectedIDs)
+{
+    CALL_IN(QString("mcNewSelectedIDs={%1}")
+        .arg([&]()
+            {
+                QList < QString > all_ids;
+                for (const int id : mcNewSelectedIDs)
+                {
+                    all_ids << QString::number(id);
+                }
+                std::sort(all_ids.begin(), all_ids.end());
+                return all_ids.join(", ");
+            }()));
+
+    CALL_OUT("");
+    return mcNewSelectedIDs.size();
+}
+
+}
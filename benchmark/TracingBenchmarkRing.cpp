@@ -0,0 +1,6 @@
+// TracingBenchmarkRing.cpp
+// Benchmark functions with ring buffer tracing
+
+#define GUESSWORD_TRACE_LEVEL 1
+#define TRACING_BENCHMARK_NAMESPACE Ring
+#include "TracingBenchmarkFunctionsBody.h"
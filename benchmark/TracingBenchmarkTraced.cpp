@@ -0,0 +1,6 @@
+// TracingBenchmarkTraced.cpp
+// Benchmark functions with call tracing
+
+#define GUESSWORD_TRACE_LEVEL 2
+#define TRACING_BENCHMARK_NAMESPACE Traced
+#include "TracingBenchmarkFunctionsBody.h"
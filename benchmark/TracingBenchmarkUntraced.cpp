@@ -0,0 +1,6 @@
+// TracingBenchmarkUntraced.cpp
+// Benchmark functions with call tracing compiled out
+
+#define GUESSWORD_TRACE_LEVEL 0
+#define TRACING_BENCHMARK_NAMESPACE Untraced
+#include "TracingBenchmarkFunctionsBody.h"
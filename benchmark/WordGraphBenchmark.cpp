@@ -0,0 +1,213 @@
+// WordGraphBenchmark.cpp
+// Compares the word graph with a hash set of strings (the way the word list
+// used to be kept): load time, memory and lookup throughput.
+//
+// Usage: WordGraphBenchmark [word list]
+
+// Project includes
+#include "WordGraph.h"
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QString>
+
+
+
+// Number of lookups per measurement
+static const int NUMBER_OF_LOOKUPS = 2000000;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Read word list (same rules as the dictionary)
+static QList < QString > ReadWords(const QString mcFileName)
+{
+    QList < QString > words;
+    QFile word_file(mcFileName);
+    if (!word_file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug().noquote() << QString("Could not open \"%1\".")
+            .arg(mcFileName);
+        return words;
+    }
+    while (!word_file.atEnd())
+    {
+        const QString word = word_file.readLine().trimmed().toLower();
+        if (word.isEmpty() ||
+            word[0] == '#')
+        {
+            continue;
+        }
+        bool valid = true;
+        for (const QChar character : word)
+        {
+            valid = valid &&
+                character >= QChar('a') &&
+                character <= QChar('z');
+        }
+        if (valid)
+        {
+            words << word;
+        }
+    }
+    return words;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter codes for a word
+static QByteArray ToLetters(const QString mcWord)
+{
+    QByteArray letters(mcWord.size(), 0);
+    for (int index = 0;
+         index < mcWord.size();
+         index++)
+    {
+        letters[index] = char(mcWord[index].unicode() - 'a');
+    }
+    return letters;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Report a measurement
+static void Report(const QString mcWhat, const qint64 mcNanoseconds,
+    const int mcCount)
+{
+    qDebug().noquote() << QString("%1: %2 ms (%3 ns each)")
+        .arg(mcWhat.leftJustified(36, ' '),
+             QString::number(mcNanoseconds / 1e6, 'f', 2),
+             QString::number(double(mcNanoseconds) / mcCount, 'f', 1));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    const QString filename = mNumParameters > 1 ?
+        QString(mpParameter[1]) : QString("../resources/Words.txt");
+    QElapsedTimer timer;
+
+    // Text is read the same way for both
+    timer.start();
+    const QList < QString > words = ReadWords(filename);
+    Report("Reading word list", timer.nsecsElapsed(), words.size());
+    if (words.isEmpty())
+    {
+        return 1;
+    }
+
+    // == Load
+    timer.start();
+    QSet < QString > word_set;
+    for (const QString & word : words)
+    {
+        word_set.insert(word);
+    }
+    Report("Hash set: insert all words", timer.nsecsElapsed(),
+        words.size());
+
+    timer.start();
+    QList < QByteArray > letters;
+    letters.reserve(words.size());
+    for (const QString & word : words)
+    {
+        letters << ToLetters(word);
+    }
+    WordGraph graph;
+    graph.Build(letters);
+    Report("Word graph: encode and build", timer.nsecsElapsed(),
+        words.size());
+
+    // == Memory (hash set: string headers and data plus one slot per
+    // bucket; allocator overhead not included)
+    qint64 set_memory = qint64(word_set.capacity()) * sizeof(QString);
+    for (const QString & word : word_set)
+    {
+        set_memory += 16 + 2 * (word.size() + 1);
+    }
+    qDebug().noquote() << QString("Hash set: about %1 kB for %2 words")
+        .arg(QString::number(set_memory / 1024),
+             QString::number(word_set.size()));
+    qDebug().noquote() << QString("Word graph: %1 kB for %2 words "
+        "(%3 nodes, %4 edges)")
+        .arg(QString::number(graph.GetMemoryUsage() / 1024),
+             QString::number(graph.GetNumberOfWords()),
+             QString::number(graph.GetNumberOfNodes()),
+             QString::number(graph.GetNumberOfEdges()));
+
+    // == Lookups: half words from the list, half with one letter changed
+    // (mostly not words)
+    QList < QString > queries;
+    QRandomGenerator random(1);
+    for (int index = 0;
+         index < 4096;
+         index++)
+    {
+        QString word = words[random.bounded(int(words.size()))];
+        if (index % 2)
+        {
+            word[random.bounded(int(word.size()))] =
+                QChar('a' + random.bounded(26));
+        }
+        queries << word;
+    }
+    QList < QByteArray > query_letters;
+    for (const QString & query : queries)
+    {
+        query_letters << ToLetters(query);
+    }
+
+    timer.start();
+    int found = 0;
+    for (int index = 0;
+         index < NUMBER_OF_LOOKUPS;
+         index++)
+    {
+        found += word_set.contains(queries[index % 4096]);
+    }
+    Report(QString("Hash set: contains (%1 found)")
+        .arg(QString::number(found)), timer.nsecsElapsed(),
+        NUMBER_OF_LOOKUPS);
+
+    timer.start();
+    found = 0;
+    for (int index = 0;
+         index < NUMBER_OF_LOOKUPS;
+         index++)
+    {
+        const QByteArray & query = query_letters[index % 4096];
+        found += graph.Contains(
+            reinterpret_cast < const quint8 * >(query.constData()),
+            query.size());
+    }
+    Report(QString("Word graph: contains (%1 found)")
+        .arg(QString::number(found)), timer.nsecsElapsed(),
+        NUMBER_OF_LOOKUPS);
+
+    // == Prefixes (the hash set cannot do these)
+    timer.start();
+    found = 0;
+    for (int index = 0;
+         index < NUMBER_OF_LOOKUPS;
+         index++)
+    {
+        const QByteArray & query = query_letters[index % 4096];
+        found += graph.IsPrefix(
+            reinterpret_cast < const quint8 * >(query.constData()),
+            query.size() / 2 + 1, query.size());
+    }
+    Report(QString("Word graph: prefix (%1 found)")
+        .arg(QString::number(found)), timer.nsecsElapsed(),
+        NUMBER_OF_LOOKUPS);
+
+    return 0;
+}
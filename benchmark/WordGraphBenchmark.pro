@@ -0,0 +1,46 @@
+# Benchmark: word graph vs. hash set of strings (load time, memory, lookups)
+
+# Where files can be found
+INCLUDEPATH += ../src/
+INCLUDEPATH += ../../Shared/
+
+# Where files go
+OBJECTS_DIR = build/
+MOC_DIR = build/
+
+# Frameworks and compiler
+TEMPLATE = app
+TARGET = WordGraphBenchmark
+QT += gui
+QT += widgets
+CONFIG += c++17
+CONFIG += release
+CONFIG += silent
+CONFIG += console
+CONFIG -= app_bundle
+
+# Don't allow deprecated versions of methods (before Qt 6.8)
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060800
+
+# No call tracing in release builds (see ../src/Tracing.h)
+CONFIG(release, debug|release): DEFINES += GUESSWORD_TRACE_LEVEL=0
+
+# Shared classes
+HEADERS += ../../Shared/CallTracer.h
+SOURCES += ../../Shared/CallTracer.cpp
+HEADERS += ../../Shared/MessageLogger.h
+SOURCES += ../../Shared/MessageLogger.cpp
+HEADERS += ../../Shared/StringHelper.h
+SOURCES += ../../Shared/StringHelper.cpp
+
+# Specific classes
+HEADERS += ../src/CallProfiler.h
+SOURCES += ../src/CallProfiler.cpp
+HEADERS += ../src/RingTracer.h
+SOURCES += ../src/RingTracer.cpp
+HEADERS += ../src/TracedCall.h
+SOURCES += ../src/TracedCall.cpp
+HEADERS += ../src/Tracing.h
+HEADERS += ../src/WordGraph.h
+SOURCES += ../src/WordGraph.cpp
+SOURCES += WordGraphBenchmark.cpp
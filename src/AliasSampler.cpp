@@ -0,0 +1,394 @@
+// AliasSampler.cpp
+// Class definition
+
+// Project includes
+#include "AliasSampler.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+AliasSampler::AliasSampler()
+{
+    CALL_IN("");
+
+    m_NumberOfActiveItems = 0;
+    m_TopTotalWeight = 0;
+    m_TotalWeight = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+AliasSampler::~AliasSampler()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Weights
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// (Re)build everything
+void AliasSampler::Build(const QList < float > & mcrWeights,
+    const BitVector & mcrActive)
+{
+    CALL_IN("mcrWeights=..., mcrActive=...");
+
+    const int num_items = mcrActive.GetSize();
+    m_Weights.resize(num_items);
+    m_NumberOfActiveItems = 0;
+    for (int item = 0;
+         item < num_items;
+         item++)
+    {
+        // Also catches NaN
+        const float weight = item < mcrWeights.size() ? mcrWeights[item] : 0;
+        if (mcrActive.Test(item) &&
+            weight > 0)
+        {
+            m_Weights[item] = weight;
+            m_NumberOfActiveItems++;
+        } else
+        {
+            m_Weights[item] = 0;
+        }
+    }
+
+    // Blocks
+    const int num_blocks = (num_items + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_BlockWeights.resize(num_blocks);
+    m_BlockCounts.resize(num_blocks);
+    m_BlockItems.resize(num_blocks * BLOCK_SIZE);
+    m_BlockThresholds.resize(num_blocks * BLOCK_SIZE);
+    m_BlockAliases.resize(num_blocks * BLOCK_SIZE);
+    for (int block = 0;
+         block < num_blocks;
+         block++)
+    {
+        BuildBlock(block);
+    }
+    BuildTop();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of items
+void AliasSampler::Resize(const int mcNumberOfItems)
+{
+    CALL_IN(QString("mcNumberOfItems=%1")
+        .arg(QString::number(mcNumberOfItems)));
+
+    if (mcNumberOfItems < 0)
+    {
+        CALL_OUT("");
+        return;
+    }
+    const int old_num_items = m_Weights.size();
+    if (mcNumberOfItems < old_num_items)
+    {
+        // Shrinking is rare; start over
+        BitVector active;
+        active.Resize(mcNumberOfItems);
+        active.Fill(true);
+        Build(m_Weights, active);
+        CALL_OUT("");
+        return;
+    }
+
+    // New items have no weight, so all tables stay valid; new blocks are
+    // not in the top level table, which is rebuilt once they get a weight
+    m_Weights.resize(mcNumberOfItems, 0);
+    const int num_blocks = (mcNumberOfItems + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_BlockWeights.resize(num_blocks, 0);
+    m_BlockCounts.resize(num_blocks, 0);
+    m_BlockItems.resize(num_blocks * BLOCK_SIZE);
+    m_BlockThresholds.resize(num_blocks * BLOCK_SIZE);
+    m_BlockAliases.resize(num_blocks * BLOCK_SIZE);
+    m_TopWeights.resize(num_blocks, 0);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of items
+int AliasSampler::GetNumberOfItems() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Weights.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Weight of a single item
+void AliasSampler::SetWeight(const int mcItem, const float mcWeight)
+{
+    CALL_IN(QString("mcItem=%1, mcWeight=%2")
+        .arg(QString::number(mcItem),
+             QString::number(mcWeight)));
+
+    if (mcItem < 0 ||
+        mcItem >= m_Weights.size())
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Also catches NaN
+    const float weight = mcWeight > 0 ? mcWeight : 0;
+    const float old_weight = m_Weights[mcItem];
+    if (weight == old_weight)
+    {
+        CALL_OUT("");
+        return;
+    }
+    m_Weights[mcItem] = weight;
+    m_NumberOfActiveItems += (weight > 0) - (old_weight > 0);
+
+    // Block
+    const int block = mcItem / BLOCK_SIZE;
+    const double old_block_weight = m_BlockWeights[block];
+    BuildBlock(block);
+    m_TotalWeight += m_BlockWeights[block] - old_block_weight;
+
+    // Top level only if it would pick the block too rarely, or if it would
+    // take too many attempts to find a block
+    if (m_BlockWeights[block] > m_TopWeights[block] ||
+        m_TotalWeight < 0.5 * m_TopTotalWeight)
+    {
+        BuildTop();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Weight of a single item
+float AliasSampler::GetWeight(const int mcItem) const
+{
+    CALL_IN(QString("mcItem=%1")
+        .arg(QString::number(mcItem)));
+
+    if (mcItem < 0 ||
+        mcItem >= m_Weights.size())
+    {
+        CALL_OUT("");
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_Weights[mcItem];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of items with a weight above 0
+int AliasSampler::GetNumberOfActiveItems() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfActiveItems;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sum of all weights
+double AliasSampler::GetTotalWeight() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_TotalWeight;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rebuild the alias table of a block
+void AliasSampler::BuildBlock(const int mcBlock)
+{
+    CALL_IN(QString("mcBlock=%1")
+        .arg(QString::number(mcBlock)));
+
+    // Items with a weight
+    const int base = mcBlock * BLOCK_SIZE;
+    const int end = qMin(base + BLOCK_SIZE, int(m_Weights.size()));
+    double weights[BLOCK_SIZE];
+    int count = 0;
+    double total_weight = 0;
+    for (int item = base;
+         item < end;
+         item++)
+    {
+        const float weight = m_Weights[item];
+        if (weight > 0)
+        {
+            m_BlockItems[base + count] = quint8(item - base);
+            weights[count] = weight;
+            total_weight += weight;
+            count++;
+        }
+    }
+    m_BlockCounts[mcBlock] = quint8(count);
+    m_BlockWeights[mcBlock] = total_weight;
+
+    // Table
+    int indices[BLOCK_SIZE];
+    BuildTable(weights, count, total_weight,
+        m_BlockThresholds.data() + base, m_BlockAliases.data() + base,
+        indices);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rebuild the top level alias table
+void AliasSampler::BuildTop()
+{
+    CALL_IN("");
+
+    m_TopWeights = m_BlockWeights;
+    m_TopTotalWeight = 0;
+    for (const double weight : m_TopWeights)
+    {
+        m_TopTotalWeight += weight;
+    }
+    m_TotalWeight = m_TopTotalWeight;
+
+    // Table
+    const int num_blocks = m_TopWeights.size();
+    m_TopThresholds.resize(num_blocks);
+    m_TopAliases.resize(num_blocks);
+    QList < int > indices(num_blocks);
+    BuildTable(m_TopWeights.constData(), num_blocks, m_TopTotalWeight,
+        m_TopThresholds.data(), m_TopAliases.data(), indices.data());
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Alias table for weights with a known sum
+void AliasSampler::BuildTable(const double * mcpWeights, const int mcNumber,
+    const double mcTotalWeight, quint32 * mpThresholds, quint32 * mpAliases,
+    int * mpIndices)
+{
+    CALL_IN(QString("mcpWeights=%1, mcNumber=%2, mcTotalWeight=%3, "
+        "mpThresholds=%4, mpAliases=%5, mpIndices=%6")
+        .arg(mcpWeights ? "..." : "nullptr",
+             QString::number(mcNumber),
+             QString::number(mcTotalWeight),
+             mpThresholds ? "..." : "nullptr",
+             mpAliases ? "..." : "nullptr",
+             mpIndices ? "..." : "nullptr"));
+
+    if (mcNumber == 0 ||
+        mcTotalWeight <= 0)
+    {
+        for (int entry = 0;
+             entry < mcNumber;
+             entry++)
+        {
+            mpThresholds[entry] = 0xffffffff;
+            mpAliases[entry] = quint32(entry);
+        }
+        CALL_OUT("");
+        return;
+    }
+
+    // Vose's variant: entries below the average weight ("small", collected
+    // from the front of mpIndices) are topped up by entries above it
+    // ("large", from the back); scaled weights average 1
+    QList < double > scaled_weights;
+    double block_scaled[BLOCK_SIZE];
+    double * scaled = block_scaled;
+    if (mcNumber > BLOCK_SIZE)
+    {
+        scaled_weights.resize(mcNumber);
+        scaled = scaled_weights.data();
+    }
+    int num_small = 0;
+    int first_large = mcNumber;
+    for (int entry = 0;
+         entry < mcNumber;
+         entry++)
+    {
+        scaled[entry] = mcpWeights[entry] * mcNumber / mcTotalWeight;
+        if (scaled[entry] < 1)
+        {
+            mpIndices[num_small++] = entry;
+        } else
+        {
+            mpIndices[--first_large] = entry;
+        }
+    }
+    while (num_small > 0 &&
+        first_large < mcNumber)
+    {
+        const int small = mpIndices[--num_small];
+        const int large = mpIndices[first_large];
+        mpThresholds[small] =
+            quint32(qMin(scaled[small] * 4294967296.0, 4294967295.0));
+        mpAliases[small] = quint32(large);
+        scaled[large] += scaled[small] - 1;
+        if (scaled[large] < 1)
+        {
+            // Now small itself
+            first_large++;
+            mpIndices[num_small++] = large;
+        }
+    }
+
+    // What is left is (up to rounding) exactly the average: never use the
+    // alias
+    for (int index = 0;
+         index < num_small;
+         index++)
+    {
+        mpThresholds[mpIndices[index]] = 0xffffffff;
+        mpAliases[mpIndices[index]] = quint32(mpIndices[index]);
+    }
+    for (int index = first_large;
+         index < mcNumber;
+         index++)
+    {
+        mpThresholds[mpIndices[index]] = 0xffffffff;
+        mpAliases[mpIndices[index]] = quint32(mpIndices[index]);
+    }
+
+    CALL_OUT("");
+}
@@ -0,0 +1,151 @@
+// AliasSampler.h
+// Class definition
+
+#ifndef ALIASSAMPLER_H
+#define ALIASSAMPLER_H
+
+// Project includes
+#include "BitVector.h"
+#include "RandomStream.h"
+
+// Qt includes
+#include <QList>
+#include <QtGlobal>
+
+
+
+// Class definition
+class AliasSampler
+{
+    // Picks items at random, each with a probability proportional to its
+    // weight, in O(1) using Walker's alias method. Items are grouped into
+    // blocks of BLOCK_SIZE, each with an alias table of its own; a top
+    // level alias table picks the block. Changing the weight of an item
+    // (e.g. to 0 once a word is used) only rebuilds the table of its block.
+    // The top level table is rebuilt if a block gets heavier than it was
+    // when that table was built, or if half of the total weight is gone;
+    // in between, a block is accepted with the probability of its current
+    // weight relative to its weight in the table, so picks stay exact and
+    // take fewer than two attempts on average.
+    //
+    // Pick() is the innermost primitive of sampling and is not traced; the
+    // rest of the class is.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    AliasSampler();
+
+    // Destructor
+    ~AliasSampler();
+
+
+
+    // ================================================================ Weights
+public:
+    // Number of items per block
+    static const int BLOCK_SIZE = 64;
+
+    // (Re)build everything: item n has weight mcrWeights[n] if bit n of
+    // mcrActive is set, and 0 otherwise. O(number of items).
+    void Build(const QList < float > & mcrWeights,
+        const BitVector & mcrActive);
+
+    // Number of items (new items have weight 0)
+    void Resize(const int mcNumberOfItems);
+    int GetNumberOfItems() const;
+
+    // Weight of a single item (negative weights count as 0). O(BLOCK_SIZE),
+    // plus O(number of blocks) when the top level table is rebuilt.
+    void SetWeight(const int mcItem, const float mcWeight);
+    float GetWeight(const int mcItem) const;
+
+    // Number of items with a weight above 0
+    int GetNumberOfActiveItems() const;
+
+    // Sum of all weights
+    double GetTotalWeight() const;
+
+private:
+    // Rebuild the alias table of a block
+    void BuildBlock(const int mcBlock);
+
+    // Rebuild the top level alias table from the current block weights
+    void BuildTop();
+
+    // Alias table for weights with a known sum: entry n is picked if the
+    // random number is below its threshold, otherwise its alias is
+    // (mpIndices is scratch space for mcNumber numbers)
+    static void BuildTable(const double * mcpWeights, const int mcNumber,
+        const double mcTotalWeight, quint32 * mpThresholds,
+        quint32 * mpAliases, int * mpIndices);
+
+    // Item weights
+    QList < float > m_Weights;
+    int m_NumberOfActiveItems;
+
+    // For each block: current weight, number of items with a weight and,
+    // BLOCK_SIZE entries each, these items (offset within the block) and
+    // their alias table
+    QList < double > m_BlockWeights;
+    QList < quint8 > m_BlockCounts;
+    QList < quint8 > m_BlockItems;
+    QList < quint32 > m_BlockThresholds;
+    QList < quint32 > m_BlockAliases;
+
+    // Top level: block weights when the table was built (never below the
+    // current ones), and the table
+    QList < double > m_TopWeights;
+    QList < quint32 > m_TopThresholds;
+    QList < quint32 > m_TopAliases;
+    double m_TopTotalWeight;
+
+    // Current sum of block weights
+    double m_TotalWeight;
+
+
+
+    // =============================================================== Sampling
+public:
+    // Pick an item; -1 if no item has a weight
+    inline int Pick(RandomStream & mrRandomStream) const
+    {
+        if (m_NumberOfActiveItems == 0)
+        {
+            return -1;
+        }
+
+        // Block: top level table, then accept with the share of the block's
+        // weight that is still there
+        const quint32 num_blocks = quint32(m_TopAliases.size());
+        int block;
+        while (true)
+        {
+            const quint64 random = mrRandomStream.Next();
+            const quint32 entry =
+                quint32((quint64(quint32(random >> 32)) * num_blocks) >> 32);
+            block = int(quint32(random) < m_TopThresholds[entry] ?
+                entry : m_TopAliases[entry]);
+            const double current_weight = m_BlockWeights[block];
+            const double top_weight = m_TopWeights[block];
+            if (current_weight >= top_weight ||
+                double(mrRandomStream.Next() >> 11) * 0x1.0p-53 * top_weight
+                    < current_weight)
+            {
+                break;
+            }
+        }
+
+        // Item within the block
+        const quint64 random = mrRandomStream.Next();
+        const int base = block * BLOCK_SIZE;
+        const quint32 entry = quint32((quint64(quint32(random >> 32))
+            * m_BlockCounts[block]) >> 32);
+        const quint32 item_entry =
+            quint32(random) < m_BlockThresholds[base + entry] ?
+                entry : m_BlockAliases[base + entry];
+        return base + m_BlockItems[base + item_entry];
+    }
+};
+
+#endif
@@ -3,14 +3,38 @@
 
 // Project includes
 #include "AllWords.h"
-#include "CallTracer.h"
+#include "Feedback.h"
 #include "MessageLogger.h"
+#include "ParallelLoop.h"
+#include "Tracing.h"
+#include "WordBlob.h"
 
 // Qt includes
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QRandomGenerator>
-#include <QRegularExpression>
+#include <QResource>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <QtNumeric>
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 
 
@@ -24,127 +48,3005 @@ AllWords::AllWords()
 {
     CALL_IN("");
 
+    // Some settings (needed to determine available words)
+    m_WordSize = 5;
+    m_AvoidDuplicateLetters = true;
+
+    // Different words every time unless seeded
+    SetSeed(QRandomGenerator::system() -> generate64());
+
+    // Journal is written in batches
+    m_NumberOfPendingJournalWords = 0;
+    m_JournalTimer.setSingleShot(true);
+    m_JournalTimer.setInterval(JOURNAL_FLUSH_DELAY);
+    connect(&m_JournalTimer, SIGNAL(timeout()),
+        this, SLOT(FlushJournal()));
+
     // Initialize words
     InitWords();
 
-    // Some other settings
-    m_WordSize = 5;
-    m_AvoidDuplicateLetters = true;
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+AllWords::~AllWords()
+{
+    CALL_IN("");
+
+    // Learned words must not get lost
+    FlushJournal();
+
+    // Unmap pattern matrices
+    for (const int length : m_PatternMatrices.keys())
+    {
+        DropPatternMatrix(length);
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Instanciator
+AllWords * AllWords::Instance()
+{
+    CALL_IN("");
+
+    if (!m_Instance)
+    {
+        m_Instance = new AllWords();
+    }
+
+    CALL_OUT("");
+    return m_Instance;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Instance
+AllWords * AllWords::m_Instance = nullptr;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialize (again)
+void AllWords::InitWords()
+{
+    CALL_IN("");
+
+    // Loaded before: pending learned words go to the journal, which is
+    // opened again, and matrices may not match the words anymore
+    if (m_JournalFile.isOpen())
+    {
+        FlushJournal();
+        m_JournalFile.close();
+    }
+    for (const int length : m_PatternMatrices.keys())
+    {
+        DropPatternMatrix(length);
+    }
+
+    // Words we know
+    m_SlabLetters.clear();
+    m_SlabIDs.clear();
+    m_IDToLength.clear();
+    m_IDToSlabIndex.clear();
+    m_IDToWeight.clear();
+    m_SlabLetterMasks.clear();
+    m_SlabLetterCounts.clear();
+    m_SlabPositionLetterBits.clear();
+    m_SlabLetterCountBits.clear();
+    m_WordsOfLength.clear();
+    m_WordsWithDuplicateLetters.Resize(0);
+    m_NumberOfBlobWords = 0;
+    m_BlobCopy.clear();
+    m_NewWords.clear();
+    RebuildLookupTable(16);
+
+    // Dictionary is compiled at build time
+    LoadWordBlob();
+
+    // Words we already had
+    m_UsedWords.Resize(0);
+    m_UsedWords.Resize(m_IDToLength.size());
+
+    // Words learned since
+    ReplayJournal();
+
+    // What we can pick from
+    UpdateAvailableWords();
+
+    // Index for filters
+    UpdateLetterIndex();
+
+    // Prefix queries
+    UpdateWordGraph();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Determine words we may pick from with the current settings
+void AllWords::UpdateAvailableWords()
+{
+    CALL_IN("");
+
+    // Words of the right size
+    const int num_words = m_IDToLength.size();
+    if (m_WordSize == -1)
+    {
+        // Any words
+        m_SelectableWords.Resize(num_words);
+        m_SelectableWords.Fill(true);
+    } else if (m_WordSize < m_WordsOfLength.size())
+    {
+        m_SelectableWords.Assign(m_WordsOfLength[m_WordSize]);
+        m_SelectableWords.Resize(num_words);
+    } else
+    {
+        m_SelectableWords.Resize(0);
+        m_SelectableWords.Resize(num_words);
+    }
+
+    // Check if we avoid duplicate letters
+    if (m_AvoidDuplicateLetters)
+    {
+        m_SelectableWords.AndNot(m_WordsWithDuplicateLetters);
+    }
+    m_SelectableWords.UpdateIndex();
+
+    // Not the ones we already had
+    m_AvailableWords.Assign(m_SelectableWords);
+    m_AvailableWords.AndNot(m_UsedWords);
+
+    // Index for picking words
+    m_AvailableWords.UpdateIndex();
+    m_WordSampler.Build(m_IDToWeight, m_AvailableWords);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Determine if a new word may be picked with the current settings
+void AllWords::UpdateAvailableWord(const quint32 mcWordID)
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if word ID is valid
+    const int num_words = m_IDToLength.size();
+    if (mcWordID >= quint32(num_words))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Same rules as for all words
+    m_SelectableWords.Resize(num_words);
+    m_AvailableWords.Resize(num_words);
+    m_WordSampler.Resize(num_words);
+    const bool selectable =
+        (m_WordSize == -1 || m_IDToLength[mcWordID] == m_WordSize) &&
+        !(m_AvoidDuplicateLetters &&
+            m_WordsWithDuplicateLetters.Test(mcWordID));
+    if (selectable)
+    {
+        m_SelectableWords.Set(mcWordID);
+        if (!m_UsedWords.Test(mcWordID))
+        {
+            m_AvailableWords.Set(mcWordID);
+            m_WordSampler.SetWeight(mcWordID, m_IDToWeight[mcWordID]);
+        }
+    }
+
+    // Resizing dropped the indices
+    m_SelectableWords.UpdateIndex();
+    m_AvailableWords.UpdateIndex();
+
+    CALL_OUT("");
+}
+
+
+
+// =============================================================== Packed words
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Invalid word ID
+const quint32 AllWords::INVALID_ID = 0xffffffff;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest word we can store
+const int AllWords::MAXIMUM_WORD_LENGTH;
+
+// Every word we store goes into the word graph, and every word a game can
+// be played with is one we store
+static_assert(AllWords::MAXIMUM_WORD_LENGTH <=
+    WordGraph::MAXIMUM_WORD_LENGTH, "Word graph is too short for words");
+static_assert(Feedback::MAXIMUM_WORD_LENGTH <=
+    AllWords::MAXIMUM_WORD_LENGTH, "Games allow longer words than stored");
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words known
+int AllWords::GetNumberOfWords() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_IDToLength.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word ID for a given word (INVALID_ID if unknown)
+quint32 AllWords::GetWordID(const QString mcWord) const
+{
+    CALL_IN(QString("mcWord=\"%1\"")
+        .arg(mcWord));
+
+    quint8 letters[MAXIMUM_WORD_LENGTH];
+    if (!EncodeWord(mcWord, letters))
+    {
+        // Cannot be a word we know
+        CALL_OUT("");
+        return INVALID_ID;
+    }
+
+    CALL_OUT("");
+    return FindPackedWord(letters, mcWord.size());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word ID for a word given as characters
+quint32 AllWords::GetWordID(const char * mcpWord, const int mcLength) const
+{
+    CALL_IN(QString("mcpWord=%1, mcLength=%2")
+        .arg(mcpWord ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    quint8 letters[MAXIMUM_WORD_LENGTH];
+    if (!EncodeWord(mcpWord, mcLength, letters))
+    {
+        // Cannot be a word we know
+        CALL_OUT("");
+        return INVALID_ID;
+    }
+
+    CALL_OUT("");
+    return FindPackedWord(letters, mcLength);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word ID for a word given as letter codes
+quint32 AllWords::GetWordIDForLetters(const quint8 * mcpLetters,
+    const int mcLength) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    // Check parameters
+    if (!mcpLetters)
+    {
+        const QString reason = tr("No letters given.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return INVALID_ID;
+    }
+
+    CALL_OUT("");
+    return FindPackedWord(mcpLetters, mcLength);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Text of a word
+QString AllWords::GetWordText(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return QString();
+    }
+
+    const int length = m_IDToLength[mcWordID];
+    const quint8 * letters = GetPackedLetters(mcWordID);
+    QString text(length, QChar('a'));
+    for (int index = 0;
+         index < length;
+         index++)
+    {
+        text[index] = QChar('a' + letters[index]);
+    }
+
+    CALL_OUT("");
+    return text;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Length of a word
+int AllWords::GetWordLength(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_IDToLength[mcWordID];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter codes (0 for "a" to 25 for "z") of a word
+const quint8 * AllWords::GetPackedLetters(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return nullptr;
+    }
+
+    // Word is at a fixed stride within the slab for its length
+    const int length = m_IDToLength[mcWordID];
+    const char * slab = m_SlabLetters[length].constData();
+
+    CALL_OUT("");
+    return reinterpret_cast < const quint8 * >(slab)
+        + qsizetype(m_IDToSlabIndex[mcWordID]) * length;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Convert a word to letter codes
+bool AllWords::EncodeWord(const QString mcWord, QByteArray & mrLetters)
+{
+    CALL_IN(QString("mcWord=\"%1\", mrLetters=...")
+        .arg(mcWord));
+
+    // Check length
+    if (mcWord.isEmpty() ||
+        mcWord.size() > MAXIMUM_WORD_LENGTH)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    // Convert letters
+    mrLetters.resize(mcWord.size());
+    const bool success = EncodeWord(mcWord,
+        reinterpret_cast < quint8 * >(mrLetters.data()));
+
+    CALL_OUT("");
+    return success;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Convert a word to letter codes (into a buffer)
+bool AllWords::EncodeWord(const QString mcWord, quint8 * mpLetters)
+{
+    CALL_IN(QString("mcWord=\"%1\", mpLetters=%2")
+        .arg(mcWord,
+             mpLetters ? "..." : "nullptr"));
+
+    // Check length
+    if (mcWord.isEmpty() ||
+        mcWord.size() > MAXIMUM_WORD_LENGTH)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    // Convert letters
+    for (int index = 0;
+         index < mcWord.size();
+         index++)
+    {
+        const char16_t letter = mcWord[index].unicode();
+        if (letter >= 'a' && letter <= 'z')
+        {
+            mpLetters[index] = quint8(letter - 'a');
+        } else if (letter >= 'A' && letter <= 'Z')
+        {
+            mpLetters[index] = quint8(letter - 'A');
+        } else
+        {
+            // Not a letter we can deal with
+            CALL_OUT("");
+            return false;
+        }
+    }
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Convert a word given as characters to letter codes (into a buffer)
+bool AllWords::EncodeWord(const char * mcpWord, const int mcLength,
+    quint8 * mpLetters)
+{
+    CALL_IN(QString("mcpWord=%1, mcLength=%2, mpLetters=%3")
+        .arg(mcpWord ? "..." : "nullptr",
+             QString::number(mcLength),
+             mpLetters ? "..." : "nullptr"));
+
+    // Check length
+    if (!mcpWord ||
+        mcLength <= 0 ||
+        mcLength > MAXIMUM_WORD_LENGTH)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    // Convert letters; upper and lower case only differ in bit 5
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        const quint8 letter = quint8((mcpWord[index] | 0x20) - 'a');
+        if (letter >= 26)
+        {
+            // Not a letter we can deal with
+            CALL_OUT("");
+            return false;
+        }
+        mpLetters[index] = letter;
+    }
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Convert letter codes back to a word
+QString AllWords::DecodeWord(const quint8 * mcpLetters, const int mcLength)
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    // Check parameters
+    if (!mcpLetters ||
+        mcLength <= 0)
+    {
+        CALL_OUT("");
+        return QString();
+    }
+
+    QString word(mcLength, QChar('a'));
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        word[index] = QChar('a' + qMin(int(mcpLetters[index]), 25));
+    }
+
+    CALL_OUT("");
+    return word;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add a new word to the packed store; returns its ID
+quint32 AllWords::AddPackedWord(const QByteArray & mcrLetters)
+{
+    CALL_IN("mcrLetters=...");
+
+    CALL_OUT("");
+    return AddPackedWords(mcrLetters, mcrLetters.size(), nullptr);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add new words of the same length to the packed store; returns the ID of
+// the first one
+quint32 AllWords::AddPackedWords(const QByteArray & mcrLetters,
+    const int mcLength, const float * mcpWeights)
+{
+    CALL_IN(QString("mcrLetters=..., mcLength=%1, mcpWeights=%2")
+        .arg(QString::number(mcLength),
+             mcpWeights ? "..." : "nullptr"));
+
+    // Check parameters
+    if (mcLength < 1 ||
+        mcLength > MAXIMUM_WORD_LENGTH ||
+        mcrLetters.size() % mcLength != 0)
+    {
+        const QString reason = tr("Invalid word length %1.")
+            .arg(QString::number(mcLength));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return INVALID_ID;
+    }
+
+    // Make sure we have a slab for this length
+    const int length = mcLength;
+    if (m_SlabLetters.size() <= length)
+    {
+        m_SlabLetters.resize(length + 1);
+        m_SlabIDs.resize(length + 1);
+        m_SlabLetterMasks.resize(length + 1);
+        m_SlabLetterCounts.resize(length + 1);
+        m_SlabPositionLetterBits.resize(length + 1);
+        m_SlabLetterCountBits.resize(length + 1);
+        m_WordsOfLength.resize(length + 1);
+    }
+
+    // Append to slab
+    const int num_new_words = mcrLetters.size() / length;
+    const quint32 first_id = m_IDToLength.size();
+    const int first_slab_index = m_SlabIDs[length].size();
+    m_SlabLetters[length].append(mcrLetters);
+    const quint8 * letters = GetSlabLetters(length)
+        + qsizetype(first_slab_index) * length;
+
+    // Grow partitions (the available words are updated separately)
+    const int num_words = first_id + num_new_words;
+    m_WordsOfLength[length].Resize(num_words);
+    m_WordsWithDuplicateLetters.Resize(num_words);
+    m_UsedWords.Resize(num_words);
+
+    // IDs, letter masks and counts (reserving for single words would defeat
+    // the geometric growth of the lists)
+    if (num_new_words > 1)
+    {
+        m_IDToLength.reserve(num_words);
+        m_IDToSlabIndex.reserve(num_words);
+        m_IDToWeight.reserve(num_words);
+        m_SlabIDs[length].reserve(first_slab_index + num_new_words);
+        m_SlabLetterMasks[length].reserve(first_slab_index + num_new_words);
+        m_SlabLetterCounts[length].reserve(
+            2 * (first_slab_index + num_new_words));
+    }
+    for (int index = 0;
+         index < num_new_words;
+         index++)
+    {
+        const quint32 word_id = first_id + index;
+        const quint8 * word_letters = letters + index * length;
+        m_IDToLength << quint8(length);
+        m_IDToSlabIndex << quint32(first_slab_index + index);
+        m_IDToWeight <<
+            (mcpWeights ? mcpWeights[index] : WordBlob::DEFAULT_WEIGHT);
+        m_SlabIDs[length] << word_id;
+        const quint32 letter_mask =
+            CalculateLetterMask(word_letters, length);
+        quint64 letter_counts[2];
+        CalculateLetterCounts(word_letters, length, letter_counts);
+        m_SlabLetterMasks[length] << letter_mask;
+        m_SlabLetterCounts[length] << letter_counts[0] << letter_counts[1];
+        m_WordsOfLength[length].Set(word_id);
+        if (qPopulationCount(letter_mask) != length)
+        {
+            m_WordsWithDuplicateLetters.Set(word_id);
+        }
+    }
+
+    // Keep lookup table at most half full
+    if (2 * (num_words - m_NumberOfBlobWords) > m_LookupTable.size())
+    {
+        RebuildLookupTable(2 * m_LookupTable.size());
+    } else
+    {
+        const quint32 mask = m_LookupTable.size() - 1;
+        for (int index = 0;
+             index < num_new_words;
+             index++)
+        {
+            quint32 slot =
+                HashLetters(letters + index * length, length) & mask;
+            while (m_LookupTable[slot] != INVALID_ID)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_LookupTable[slot] = first_id + index;
+        }
+    }
+
+    CALL_OUT("");
+    return first_id;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Find the ID of a word given as letter codes (INVALID_ID if unknown). This
+// is the innermost loop of batch validation and loading (where it runs on
+// several threads), so it is not traced.
+quint32 AllWords::FindPackedWord(const quint8 * mcpLetters,
+    const int mcLength) const
+{
+    // Nothing to find if we don't have words of this length
+    if (mcLength <= 0 ||
+        mcLength >= m_SlabLetters.size())
+    {
+        return INVALID_ID;
+    }
+
+    // Words from the blob: the perfect hash gives the only candidate, and
+    // its fingerprint rules out most other words
+    const quint8 * slab = reinterpret_cast < const quint8 * >(
+        m_SlabLetters[mcLength].constData());
+    if (m_NumberOfBlobWords > 0)
+    {
+        const quint64 hash =
+            WordBlob::Hash(mcpLetters, mcLength, m_BlobHashSeed);
+        const quint32 bucket =
+            WordBlob::GetBucket(hash, m_BlobNumberOfBuckets);
+        const quint32 slot = WordBlob::GetSlot(hash,
+            WordBlob::Read(m_BlobDisplacements + 4 * bucket),
+            m_NumberOfBlobWords);
+        if (m_BlobFingerprints[slot] == WordBlob::GetFingerprint(hash))
+        {
+            const quint32 word_id = WordBlob::Read(m_BlobSlots + 4 * slot);
+            if (m_IDToLength[word_id] == mcLength &&
+                memcmp(slab + qsizetype(m_IDToSlabIndex[word_id]) * mcLength,
+                    mcpLetters, mcLength) == 0)
+            {
+                return word_id;
+            }
+        }
+    }
+
+    // Nothing else to check if no words were added later
+    if (m_IDToLength.size() == m_NumberOfBlobWords)
+    {
+        return INVALID_ID;
+    }
+
+    // Overflow table: linear probing
+    const quint32 mask = m_LookupTable.size() - 1;
+    quint32 slot = HashLetters(mcpLetters, mcLength) & mask;
+    while (m_LookupTable[slot] != INVALID_ID)
+    {
+        const quint32 word_id = m_LookupTable[slot];
+        if (m_IDToLength[word_id] == mcLength &&
+            memcmp(slab + qsizetype(m_IDToSlabIndex[word_id]) * mcLength,
+                mcpLetters, mcLength) == 0)
+        {
+            return word_id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Not found
+    return INVALID_ID;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Hash for letter codes (not traced, see FindPackedWord)
+quint32 AllWords::HashLetters(const quint8 * mcpLetters, const int mcLength)
+{
+    // FNV-1a, followed by a final avalanche so the low bits (which we use for
+    // the table index) depend on all letters
+    quint32 hash = 2166136261u;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        hash = (hash ^ mcpLetters[index]) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rebuild the lookup table
+void AllWords::RebuildLookupTable(const int mcCapacity)
+{
+    CALL_IN(QString("mcCapacity=%1")
+        .arg(QString::number(mcCapacity)));
+
+    // Capacity must be a power of two
+    const int num_words = m_IDToLength.size() - m_NumberOfBlobWords;
+    int capacity = 16;
+    while (capacity < mcCapacity ||
+        capacity < 2 * num_words)
+    {
+        capacity *= 2;
+    }
+
+    // Insert all words that are not in the blob again
+    m_LookupTable.fill(INVALID_ID, capacity);
+    const quint32 mask = capacity - 1;
+    for (quint32 word_id = m_NumberOfBlobWords;
+         word_id < quint32(m_IDToLength.size());
+         word_id++)
+    {
+        quint32 slot = HashLetters(GetPackedLetters(word_id),
+            m_IDToLength[word_id]) & mask;
+        while (m_LookupTable[slot] != INVALID_ID)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_LookupTable[slot] = word_id;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Load the dictionary blob compiled at build time
+bool AllWords::LoadWordBlob()
+{
+    CALL_IN("");
+
+    // Resource data is used in place (unless it was compressed)
+    QResource resource(":/resources/Words.blob");
+    if (!resource.isValid())
+    {
+        const QString reason = tr("Could not open \"Words.blob\".");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    const quint8 * blob;
+    qint64 blob_size;
+    if (resource.compressionAlgorithm() == QResource::NoCompression)
+    {
+        blob = resource.data();
+        blob_size = resource.size();
+    } else
+    {
+        m_BlobCopy = resource.uncompressedData();
+        blob = reinterpret_cast < const quint8 * >(m_BlobCopy.constData());
+        blob_size = m_BlobCopy.size();
+    }
+
+    // Check header and section sizes
+    const QString invalid_reason = tr("\"Words.blob\" is not valid.");
+    if (blob_size < WordBlob::HEADER_SIZE ||
+        WordBlob::Read(blob + 4 * WordBlob::Header_Magic) !=
+            WordBlob::MAGIC ||
+        WordBlob::Read(blob + 4 * WordBlob::Header_Version) !=
+            WordBlob::VERSION)
+    {
+        MessageLogger::Error(CALL_METHOD,
+            invalid_reason);
+        CALL_OUT(invalid_reason);
+        return false;
+    }
+    const quint32 num_words =
+        WordBlob::Read(blob + 4 * WordBlob::Header_NumberOfWords);
+    const quint32 maximum_length =
+        WordBlob::Read(blob + 4 * WordBlob::Header_MaximumWordLength);
+    const quint32 num_buckets =
+        WordBlob::Read(blob + 4 * WordBlob::Header_NumberOfBuckets);
+    const qint64 partitions_offset = WordBlob::HEADER_SIZE;
+    const qint64 displacements_offset = partitions_offset
+        + qint64(WordBlob::PARTITION_SIZE) * (maximum_length + 1);
+    const qint64 slots_offset = displacements_offset + 4 * qint64(num_buckets);
+    const qint64 weights_offset = slots_offset + 4 * qint64(num_words);
+    const qint64 fingerprints_offset =
+        weights_offset + 4 * qint64(num_words);
+    const qint64 letters_offset =
+        fingerprints_offset + (qint64(num_words) + 3) / 4 * 4;
+    if (maximum_length > quint32(MAXIMUM_WORD_LENGTH) ||
+        num_buckets == 0 ||
+        letters_offset > blob_size)
+    {
+        MessageLogger::Error(CALL_METHOD,
+            invalid_reason);
+        CALL_OUT(invalid_reason);
+        return false;
+    }
+
+    // Check partitions: contiguous IDs and letters within the blob
+    const quint8 * partitions = blob + partitions_offset;
+    quint32 next_word_id = 0;
+    for (quint32 length = 0;
+         length <= maximum_length;
+         length++)
+    {
+        const quint8 * partition =
+            partitions + WordBlob::PARTITION_SIZE * length;
+        const quint32 count = WordBlob::Read(
+            partition + 4 * WordBlob::Partition_NumberOfWords);
+        if (count == 0)
+        {
+            continue;
+        }
+        const quint32 first_id = WordBlob::Read(
+            partition + 4 * WordBlob::Partition_FirstWordID);
+        const qint64 letter_offset = WordBlob::Read(
+            partition + 4 * WordBlob::Partition_LetterOffset);
+        if (length == 0 ||
+            first_id != next_word_id ||
+            letters_offset + letter_offset + qint64(count) * length >
+                blob_size)
+        {
+            MessageLogger::Error(CALL_METHOD,
+                invalid_reason);
+            CALL_OUT(invalid_reason);
+            return false;
+        }
+        next_word_id += count;
+    }
+    bool slots_valid = (next_word_id == num_words);
+    for (quint32 slot = 0;
+         slots_valid && slot < num_words;
+         slot++)
+    {
+        slots_valid =
+            WordBlob::Read(blob + slots_offset + 4 * slot) < num_words;
+    }
+    if (!slots_valid)
+    {
+        MessageLogger::Error(CALL_METHOD,
+            invalid_reason);
+        CALL_OUT(invalid_reason);
+        return false;
+    }
+
+    // Check weights (finite and not negative; the negation also catches
+    // NaN)
+    const quint8 * weights = blob + weights_offset;
+    bool weights_valid = true;
+    for (quint32 word_id = 0;
+         weights_valid && word_id < num_words;
+         word_id++)
+    {
+        const float weight = WordBlob::ReadFloat(weights + 4 * word_id);
+        weights_valid = (weight >= 0 && qIsFinite(weight));
+    }
+    if (!weights_valid)
+    {
+        MessageLogger::Error(CALL_METHOD,
+            invalid_reason);
+        CALL_OUT(invalid_reason);
+        return false;
+    }
+
+    // Set up slabs
+    const int num_lengths = maximum_length + 1;
+    m_SlabLetters.resize(num_lengths);
+    m_SlabIDs.resize(num_lengths);
+    m_SlabLetterMasks.resize(num_lengths);
+    m_SlabLetterCounts.resize(num_lengths);
+    m_SlabPositionLetterBits.resize(num_lengths);
+    m_SlabLetterCountBits.resize(num_lengths);
+    m_WordsOfLength.resize(num_lengths);
+    m_IDToLength.resize(num_words);
+    m_IDToSlabIndex.resize(num_words);
+    m_IDToWeight.resize(num_words);
+    m_WordsWithDuplicateLetters.Resize(num_words);
+    for (int length = 1;
+         length < num_lengths;
+         length++)
+    {
+        const quint8 * partition =
+            partitions + WordBlob::PARTITION_SIZE * length;
+        const int count = WordBlob::Read(
+            partition + 4 * WordBlob::Partition_NumberOfWords);
+        if (count == 0)
+        {
+            continue;
+        }
+        const quint32 first_id = WordBlob::Read(
+            partition + 4 * WordBlob::Partition_FirstWordID);
+        const quint8 * letters = blob + letters_offset + WordBlob::Read(
+            partition + 4 * WordBlob::Partition_LetterOffset);
+
+        // Letters stay where they are
+        m_SlabLetters[length] = QByteArray::fromRawData(
+            reinterpret_cast < const char * >(letters),
+            qsizetype(count) * length);
+
+        // Everything else follows from the letters
+        QList < quint32 > & slab_ids = m_SlabIDs[length];
+        QList < quint32 > & letter_masks = m_SlabLetterMasks[length];
+        QList < quint64 > & letter_counts = m_SlabLetterCounts[length];
+        slab_ids.resize(count);
+        letter_masks.resize(count);
+        letter_counts.resize(2 * count);
+        m_WordsOfLength[length].Resize(num_words);
+        for (int slab_index = 0;
+             slab_index < count;
+             slab_index++)
+        {
+            const quint32 word_id = first_id + slab_index;
+            const quint8 * word_letters = letters + slab_index * length;
+            slab_ids[slab_index] = word_id;
+            m_IDToLength[word_id] = quint8(length);
+            m_IDToSlabIndex[word_id] = slab_index;
+            m_IDToWeight[word_id] =
+                WordBlob::ReadFloat(weights + 4 * word_id);
+            letter_masks[slab_index] =
+                CalculateLetterMask(word_letters, length);
+            CalculateLetterCounts(word_letters, length,
+                &letter_counts[2 * slab_index]);
+            m_WordsOfLength[length].Set(word_id);
+            if (qPopulationCount(letter_masks[slab_index]) != length)
+            {
+                m_WordsWithDuplicateLetters.Set(word_id);
+            }
+        }
+    }
+
+    // Lookups go through the perfect hash
+    m_NumberOfBlobWords = num_words;
+    m_BlobHashSeed = WordBlob::Read(blob + 4 * WordBlob::Header_HashSeed);
+    m_BlobNumberOfBuckets = num_buckets;
+    m_BlobDisplacements = blob + displacements_offset;
+    m_BlobSlots = blob + slots_offset;
+    m_BlobFingerprints = blob + fingerprints_offset;
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Weight for picking a word
+void AllWords::SetWordWeight(const quint32 mcWordID, const float mcWeight)
+{
+    CALL_IN(QString("mcWordID=%1, mcWeight=%2")
+        .arg(QString::number(mcWordID),
+             QString::number(mcWeight)));
+
+    // Check parameters
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+    if (!(mcWeight >= 0 && qIsFinite(mcWeight)))
+    {
+        const QString reason = tr("Invalid weight %1.")
+            .arg(QString::number(mcWeight));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Only its block of the sampler changes
+    m_IDToWeight[mcWordID] = mcWeight;
+    if (m_AvailableWords.Test(mcWordID))
+    {
+        m_WordSampler.SetWeight(mcWordID, mcWeight);
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Weight for picking a word
+float AllWords::GetWordWeight(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check parameters
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_IDToWeight[mcWordID];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add the words of an external word list
+int AllWords::LoadWordList(const QString mcFileName)
+{
+    CALL_IN(QString("mcFileName=\"%1\"")
+        .arg(mcFileName));
+
+    // Add them
+    const quint32 first_new_id = quint32(m_IDToLength.size());
+    const int num_added = AddWordList(mcFileName);
+
+    // Bring everything else up to date
+    if (num_added > 0)
+    {
+        UpdateAvailableWords();
+        UpdateLetterIndex();
+        AddToWordGraph(first_new_id, num_added);
+    }
+
+    CALL_OUT("");
+    return num_added;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add the words of a word list without updating anything else
+int AllWords::AddWordList(const QString mcFileName)
+{
+    CALL_IN(QString("mcFileName=\"%1\"")
+        .arg(mcFileName));
+
+    // Map the file; lines are parsed in place
+    QFile word_file(mcFileName);
+    if (!word_file.open(QIODevice::ReadOnly))
+    {
+        const QString reason = tr("Could not open \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return -1;
+    }
+    const qint64 file_size = word_file.size();
+    if (file_size == 0)
+    {
+        CALL_OUT("");
+        return 0;
+    }
+    const char * data = reinterpret_cast < const char * >(
+        word_file.map(0, file_size));
+    if (!data)
+    {
+        const QString reason = tr("Could not map \"%1\": %2")
+            .arg(mcFileName,
+                 word_file.errorString());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return -1;
+    }
+
+    // Chunks of about 1 MB, each ending after a line break
+    const qint64 chunk_size = 1 << 20;
+    QList < qint64 > chunk_starts;
+    qint64 position = 0;
+    while (position < file_size)
+    {
+        chunk_starts << position;
+        qint64 end = qMin(position + chunk_size, file_size);
+        if (end < file_size)
+        {
+            const void * line_end = memchr(data + end, '\n', file_size - end);
+            end = line_end ?
+                static_cast < const char * >(line_end) - data + 1 :
+                file_size;
+        }
+        position = end;
+    }
+    chunk_starts << file_size;
+    const int num_chunks = chunk_starts.size() - 1;
+
+    // Words are deduplicated in partitions (by hash), so partitions can be
+    // done in parallel
+    const int num_partitions = 64;
+    const int max_invalid_samples = 10;
+    struct Chunk
+    {
+        // Letter codes of the valid words, back to back
+        QByteArray m_Letters;
+        QList < qint64 > m_Offsets;
+        QList < quint8 > m_Lengths;
+
+        // Weights of the valid words
+        QList < float > m_Weights;
+
+        // Indices of the valid words in each partition
+        QList < QList < int > > m_Partitions;
+
+        // Words to be added
+        QByteArray m_Keep;
+
+        // Lines, invalid lines and the first few of those
+        int m_NumberOfLines = 0;
+        int m_NumberOfInvalidLines = 0;
+        QList < int > m_InvalidLines;
+        QList < QByteArray > m_InvalidText;
+    };
+    QList < Chunk > chunks(num_chunks);
+    const int num_threads = ParallelLoop::GetDefaultNumberOfThreads();
+
+    // == Phase 1: parse and validate (nothing traced in here, it runs on
+    // worker threads)
+    ParallelLoop::Run(num_chunks, 1, num_threads,
+        [&](const int mcWorker, const int mcFirst, const int mcLast)
+        {
+            Q_UNUSED(mcWorker);
+            for (int chunk_index = mcFirst;
+                 chunk_index < mcLast;
+                 chunk_index++)
+            {
+                Chunk & chunk = chunks[chunk_index];
+                chunk.m_Partitions.resize(num_partitions);
+                const char * current = data + chunk_starts[chunk_index];
+                const char * chunk_end = data + chunk_starts[chunk_index + 1];
+                while (current < chunk_end)
+                {
+                    // Next line
+                    const void * found =
+                        memchr(current, '\n', chunk_end - current);
+                    const char * line_end = found ?
+                        static_cast < const char * >(found) : chunk_end;
+                    const char * first = current;
+                    const char * last = line_end;
+                    current = line_end + 1;
+                    const int line = chunk.m_NumberOfLines++;
+
+                    // Trim, skip comments and empty lines
+                    while (first < last &&
+                        (*first == ' ' || *first == '\t' || *first == '\r'))
+                    {
+                        first++;
+                    }
+                    while (last > first &&
+                        (last[-1] == ' ' || last[-1] == '\t' ||
+                         last[-1] == '\r'))
+                    {
+                        last--;
+                    }
+                    if (first == last ||
+                        *first == '#')
+                    {
+                        continue;
+                    }
+
+                    // Weight, if there is one (same rules as the word
+                    // blob compiler: finite and not negative)
+                    float weight = WordBlob::DEFAULT_WEIGHT;
+                    bool valid = true;
+                    const char * word_last = first;
+                    while (word_last < last &&
+                        *word_last != ' ' && *word_last != '\t')
+                    {
+                        word_last++;
+                    }
+                    if (word_last < last)
+                    {
+                        const char * weight_first = word_last;
+                        while (*weight_first == ' ' ||
+                            *weight_first == '\t')
+                        {
+                            weight_first++;
+                        }
+                        char weight_text[32];
+                        const int weight_length = int(last - weight_first);
+                        valid = weight_length < int(sizeof(weight_text));
+                        if (valid)
+                        {
+                            memcpy(weight_text, weight_first,
+                                size_t(weight_length));
+                            weight_text[weight_length] = 0;
+                            char * weight_end = nullptr;
+                            weight = std::strtof(weight_text, &weight_end);
+                            valid = weight_end == weight_text + weight_length
+                                && std::isfinite(weight) && weight >= 0;
+                        }
+                    }
+
+                    // Validate and encode
+                    const int length = int(qMin(word_last - first,
+                        qint64(MAXIMUM_WORD_LENGTH + 1)));
+                    quint8 letters[MAXIMUM_WORD_LENGTH];
+                    valid = valid && length <= MAXIMUM_WORD_LENGTH;
+                    for (int index = 0;
+                         valid && index < length;
+                         index++)
+                    {
+                        letters[index] = quint8((first[index] | 0x20) - 'a');
+                        valid = letters[index] < 26;
+                    }
+                    if (!valid)
+                    {
+                        chunk.m_NumberOfInvalidLines++;
+                        if (chunk.m_InvalidLines.size() < max_invalid_samples)
+                        {
+                            chunk.m_InvalidLines << line;
+                            chunk.m_InvalidText <<
+                                QByteArray(first, int(qMin(last - first,
+                                    qint64(2 * MAXIMUM_WORD_LENGTH))));
+                        }
+                        continue;
+                    }
+
+                    // Remember it
+                    const quint32 hash = HashLetters(letters, length);
+                    chunk.m_Partitions[hash >> 26] <<
+                        int(chunk.m_Lengths.size());
+                    chunk.m_Offsets << chunk.m_Letters.size();
+                    chunk.m_Lengths << quint8(length);
+                    chunk.m_Weights << weight;
+                    chunk.m_Letters.append(
+                        reinterpret_cast < const char * >(letters), length);
+                }
+                chunk.m_Keep = QByteArray(chunk.m_Lengths.size(), 0);
+            }
+        });
+
+    // Line numbers of the first line in each chunk
+    QList < int > first_lines(num_chunks, 0);
+    int num_lines = 0;
+    int num_invalid = 0;
+    for (int chunk_index = 0;
+         chunk_index < num_chunks;
+         chunk_index++)
+    {
+        first_lines[chunk_index] = num_lines;
+        num_lines += chunks[chunk_index].m_NumberOfLines;
+        num_invalid += chunks[chunk_index].m_NumberOfInvalidLines;
+    }
+
+    // == Phase 2: deduplicate, partition by partition, chunks in file
+    // order (so the first occurrence of a word is the one we keep)
+    QList < char * > keep;
+    for (Chunk & chunk : chunks)
+    {
+        keep << chunk.m_Keep.data();
+    }
+    QList < int > num_known(num_partitions, 0);
+    QList < int > num_duplicates(num_partitions, 0);
+    ParallelLoop::Run(num_partitions, 1, num_threads,
+        [&](const int mcWorker, const int mcFirst, const int mcLast)
+        {
+            Q_UNUSED(mcWorker);
+            for (int partition = mcFirst;
+                 partition < mcLast;
+                 partition++)
+            {
+                QSet < QByteArray > seen;
+                for (int chunk_index = 0;
+                     chunk_index < num_chunks;
+                     chunk_index++)
+                {
+                    const Chunk & chunk = chunks.at(chunk_index);
+                    for (const int word : chunk.m_Partitions[partition])
+                    {
+                        const char * word_letters = chunk.m_Letters.constData()
+                            + chunk.m_Offsets[word];
+                        const int length = chunk.m_Lengths[word];
+                        if (FindPackedWord(reinterpret_cast < const quint8 * >(
+                            word_letters), length) != INVALID_ID)
+                        {
+                            num_known[partition]++;
+                            continue;
+                        }
+                        const QByteArray key =
+                            QByteArray::fromRawData(word_letters, length);
+                        if (seen.contains(key))
+                        {
+                            num_duplicates[partition]++;
+                            continue;
+                        }
+                        seen.insert(key);
+                        keep.at(chunk_index)[word] = 1;
+                    }
+                }
+            }
+        });
+
+    // == Phase 3: merge, in file order, one bulk insert per word length
+    QList < QByteArray > new_letters;
+    QList < QList < float > > new_weights;
+    for (const Chunk & chunk : chunks)
+    {
+        for (int word = 0;
+             word < chunk.m_Lengths.size();
+             word++)
+        {
+            if (!chunk.m_Keep[word])
+            {
+                continue;
+            }
+            const int length = chunk.m_Lengths[word];
+            if (new_letters.size() <= length)
+            {
+                new_letters.resize(length + 1);
+                new_weights.resize(length + 1);
+            }
+            new_letters[length].append(
+                chunk.m_Letters.constData() + chunk.m_Offsets[word], length);
+            new_weights[length] << chunk.m_Weights[word];
+        }
+    }
+    int num_added = 0;
+    for (int length = 1;
+         length < new_letters.size();
+         length++)
+    {
+        if (!new_letters[length].isEmpty())
+        {
+            AddPackedWords(new_letters[length], length,
+                new_weights[length].constData());
+            num_added += new_letters[length].size() / length;
+        }
+    }
+    CALL_MARK(num_added);
+
+    // Report in one go
+    int total_known = 0;
+    int total_duplicates = 0;
+    for (int partition = 0;
+         partition < num_partitions;
+         partition++)
+    {
+        total_known += num_known[partition];
+        total_duplicates += num_duplicates[partition];
+    }
+    qDebug().noquote() << tr("Loaded \"%1\" (%2 lines): %3 words added, "
+        "%4 already known, %5 duplicates, %6 invalid lines")
+        .arg(mcFileName,
+             QString::number(num_lines),
+             QString::number(num_added),
+             QString::number(total_known),
+             QString::number(total_duplicates),
+             QString::number(num_invalid));
+    int num_samples = 0;
+    for (int chunk_index = 0;
+         chunk_index < num_chunks;
+         chunk_index++)
+    {
+        const Chunk & chunk = chunks[chunk_index];
+        for (int sample = 0;
+             sample < chunk.m_InvalidLines.size() &&
+                num_samples < max_invalid_samples;
+             sample++, num_samples++)
+        {
+            qDebug().noquote() << tr("  line %1: \"%2\"")
+                .arg(QString::number(first_lines[chunk_index]
+                        + chunk.m_InvalidLines[sample] + 1),
+                     QString::fromUtf8(chunk.m_InvalidText[sample]));
+        }
+    }
+
+    CALL_OUT("");
+    return num_added;
+}
+
+
+
+// =============================================================== Letter masks
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of letters in the alphabet
+const int AllWords::NUMBER_OF_LETTERS = 26;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letters present in a word
+quint32 AllWords::GetLetterMask(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_SlabLetterMasks[m_IDToLength[mcWordID]]
+        [m_IDToSlabIndex[mcWordID]];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word contains a given letter
+bool AllWords::ContainsLetter(const quint32 mcWordID, const int mcLetter) const
+{
+    CALL_IN(QString("mcWordID=%1, mcLetter=%2")
+        .arg(QString::number(mcWordID),
+             QString::number(mcLetter)));
+
+    // Check if letter is valid
+    if (mcLetter < 0 ||
+        mcLetter >= NUMBER_OF_LETTERS)
+    {
+        const QString reason = tr("Invalid letter %1.")
+            .arg(QString::number(mcLetter));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    CALL_OUT("");
+    return (GetLetterMask(mcWordID) >> mcLetter) & 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of occurrences of a given letter in a word
+int AllWords::GetLetterCount(const quint32 mcWordID, const int mcLetter) const
+{
+    CALL_IN(QString("mcWordID=%1, mcLetter=%2")
+        .arg(QString::number(mcWordID),
+             QString::number(mcLetter)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    // Check if letter is valid
+    if (mcLetter < 0 ||
+        mcLetter >= NUMBER_OF_LETTERS)
+    {
+        const QString reason = tr("Invalid letter %1.")
+            .arg(QString::number(mcLetter));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    const quint64 packed_counts =
+        m_SlabLetterCounts[m_IDToLength[mcWordID]]
+            [2 * m_IDToSlabIndex[mcWordID] + mcLetter / 16];
+
+    CALL_OUT("");
+    return (packed_counts >> (4 * (mcLetter % 16))) & 0xf;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of occurrences of each letter
+void AllWords::GetLetterCounts(const quint32 mcWordID,
+    quint8 * mpCounts) const
+{
+    CALL_IN(QString("mcWordID=%1, mpCounts=%2")
+        .arg(QString::number(mcWordID),
+             mpCounts ? "..." : "nullptr"));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Unpack
+    const quint64 * packed_counts =
+        m_SlabLetterCounts[m_IDToLength[mcWordID]].constData()
+            + 2 * m_IDToSlabIndex[mcWordID];
+    for (int letter = 0;
+         letter < NUMBER_OF_LETTERS;
+         letter++)
+    {
+        mpCounts[letter] =
+            (packed_counts[letter / 16] >> (4 * (letter % 16))) & 0xf;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word (by ID) has duplicate letters
+bool AllWords::HasDuplicateLetters(const quint32 mcWordID) const
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
+    {
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Fewer distinct letters than letters
+    CALL_OUT("");
+    return qPopulationCount(GetLetterMask(mcWordID))
+        != m_IDToLength[mcWordID];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter mask for letter codes
+quint32 AllWords::CalculateLetterMask(const quint8 * mcpLetters,
+    const int mcLength)
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    quint32 mask = 0;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        mask |= quint32(1) << mcpLetters[index];
+    }
+
+    CALL_OUT("");
+    return mask;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Packed letter counts for letter codes
+void AllWords::CalculateLetterCounts(const quint8 * mcpLetters,
+    const int mcLength, quint64 * mpPackedCounts)
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2, mpPackedCounts=%3")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength),
+             mpPackedCounts ? "..." : "nullptr"));
+
+    mpPackedCounts[0] = 0;
+    mpPackedCounts[1] = 0;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        // Add one to the letter's nibble unless it is saturated
+        const int letter = mcpLetters[index];
+        const int shift = 4 * (letter % 16);
+        quint64 & packed = mpPackedCounts[letter / 16];
+        if (((packed >> shift) & 0xf) != 0xf)
+        {
+            packed += quint64(1) << shift;
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+// =============================================================== Letter index
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words in a slab
+int AllWords::GetSlabSize(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // No slab, no words
+    if (mcLength < 0 ||
+        mcLength >= m_SlabIDs.size())
+    {
+        CALL_OUT("");
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_SlabIDs[mcLength].size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter codes of all words in a slab
+const quint8 * AllWords::GetSlabLetters(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // No slab, no words
+    if (mcLength < 0 ||
+        mcLength >= m_SlabLetters.size())
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return reinterpret_cast < const quint8 * >(
+        m_SlabLetters[mcLength].constData());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word IDs of all words in a slab
+const quint32 * AllWords::GetSlabIDs(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // No slab, no words
+    if (mcLength < 0 ||
+        mcLength >= m_SlabIDs.size())
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_SlabIDs[mcLength].constData();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter masks of all words in a slab
+const quint32 * AllWords::GetSlabLetterMasks(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // No slab, no words
+    if (mcLength < 0 ||
+        mcLength >= m_SlabLetterMasks.size())
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_SlabLetterMasks[mcLength].constData();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Packed letter counts of all words in a slab
+const quint64 * AllWords::GetSlabLetterCounts(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // No slab, no words
+    if (mcLength < 0 ||
+        mcLength >= m_SlabLetterCounts.size())
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_SlabLetterCounts[mcLength].constData();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words of a slab with a given letter at a given position
+const BitVector & AllWords::GetPositionLetterBits(const int mcLength,
+    const int mcPosition, const int mcLetter) const
+{
+    CALL_IN(QString("mcLength=%1, mcPosition=%2, mcLetter=%3")
+        .arg(QString::number(mcLength),
+             QString::number(mcPosition),
+             QString::number(mcLetter)));
+
+    // Check parameters
+    if (mcLength < 0 ||
+        mcLength >= m_SlabPositionLetterBits.size() ||
+        mcPosition < 0 ||
+        mcPosition >= mcLength ||
+        mcLetter < 0 ||
+        mcLetter >= NUMBER_OF_LETTERS ||
+        m_SlabPositionLetterBits[mcLength].isEmpty())
+    {
+        const QString reason = tr("Invalid length %1, position %2 "
+            "or letter %3.")
+            .arg(QString::number(mcLength),
+                 QString::number(mcPosition),
+                 QString::number(mcLetter));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        static const BitVector no_bits;
+        CALL_OUT(reason);
+        return no_bits;
+    }
+
+    CALL_OUT("");
+    return m_SlabPositionLetterBits[mcLength]
+        [mcPosition * NUMBER_OF_LETTERS + mcLetter];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Maximum count supported by GetLetterCountBits()
+const int AllWords::MAXIMUM_INDEXED_LETTER_COUNT = 2;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words of a slab with at least a given number of occurrences of a letter
+const BitVector & AllWords::GetLetterCountBits(const int mcLength,
+    const int mcLetter, const int mcMinimumCount) const
+{
+    CALL_IN(QString("mcLength=%1, mcLetter=%2, mcMinimumCount=%3")
+        .arg(QString::number(mcLength),
+             QString::number(mcLetter),
+             QString::number(mcMinimumCount)));
+
+    // Check parameters
+    if (mcLength < 0 ||
+        mcLength >= m_SlabLetterCountBits.size() ||
+        mcLetter < 0 ||
+        mcLetter >= NUMBER_OF_LETTERS ||
+        mcMinimumCount < 1 ||
+        mcMinimumCount > MAXIMUM_INDEXED_LETTER_COUNT ||
+        m_SlabLetterCountBits[mcLength].isEmpty())
+    {
+        const QString reason = tr("Invalid length %1, letter %2 "
+            "or count %3.")
+            .arg(QString::number(mcLength),
+                 QString::number(mcLetter),
+                 QString::number(mcMinimumCount));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        static const BitVector no_bits;
+        CALL_OUT(reason);
+        return no_bits;
+    }
+
+    CALL_OUT("");
+    return m_SlabLetterCountBits[mcLength]
+        [(mcMinimumCount - 1) * NUMBER_OF_LETTERS + mcLetter];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bring letter index up to date with the slabs
+void AllWords::UpdateLetterIndex()
+{
+    CALL_IN("");
+
+    for (int length = 1;
+         length < m_SlabIDs.size();
+         length++)
+    {
+        // Check if this slab has changed since we last indexed it
+        const int num_words = m_SlabIDs[length].size();
+        QList < BitVector > & position_bits = m_SlabPositionLetterBits[length];
+        QList < BitVector > & count_bits = m_SlabLetterCountBits[length];
+        const int num_indexed =
+            position_bits.isEmpty() ? 0 : position_bits.first().GetSize();
+        if (num_words == 0 ||
+            num_indexed == num_words)
+        {
+            continue;
+        }
+
+        // Words are only ever appended to a slab, so only the new ones need
+        // bits (resizing clears them); the feedback matrix is rebuilt once a
+        // solver asks for it (see PreparePatternMatrix())
+        int first_new_index = num_indexed;
+        if (num_indexed == 0 ||
+            num_indexed > num_words)
+        {
+            position_bits.resize(length * NUMBER_OF_LETTERS);
+            count_bits.resize(
+                MAXIMUM_INDEXED_LETTER_COUNT * NUMBER_OF_LETTERS);
+            first_new_index = 0;
+        }
+        for (BitVector & bits : position_bits)
+        {
+            if (first_new_index == 0)
+            {
+                bits.Resize(0);
+            }
+            bits.Resize(num_words);
+        }
+        for (BitVector & bits : count_bits)
+        {
+            if (first_new_index == 0)
+            {
+                bits.Resize(0);
+            }
+            bits.Resize(num_words);
+        }
+
+        // Raw words for speed
+        QList < quint64 * > position_words;
+        for (BitVector & bits : position_bits)
+        {
+            position_words << bits.GetWords();
+        }
+        QList < quint64 * > count_words;
+        for (BitVector & bits : count_bits)
+        {
+            count_words << bits.GetWords();
+        }
+
+        // Go through the new part of the slab
+        const quint8 * letters = GetSlabLetters(length);
+        const quint64 * packed_counts = GetSlabLetterCounts(length);
+        for (int slab_index = first_new_index;
+             slab_index < num_words;
+             slab_index++)
+        {
+            const quint64 bit = quint64(1) << (slab_index % 64);
+            const int word_index = slab_index / 64;
+            for (int position = 0;
+                 position < length;
+                 position++)
+            {
+                const int letter = letters[slab_index * length + position];
+                position_words[position * NUMBER_OF_LETTERS + letter]
+                    [word_index] |= bit;
+            }
+            for (int letter = 0;
+                 letter < NUMBER_OF_LETTERS;
+                 letter++)
+            {
+                const int count =
+                    (packed_counts[2 * slab_index + letter / 16]
+                        >> (4 * (letter % 16))) & 0xf;
+                for (int at_least = 1;
+                     at_least <= qMin(count, MAXIMUM_INDEXED_LETTER_COUNT);
+                     at_least++)
+                {
+                    count_words[(at_least - 1) * NUMBER_OF_LETTERS + letter]
+                        [word_index] |= bit;
+                }
+            }
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+// ============================================================= Pattern matrix
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest words whose feedback code fits in a byte
+const int AllWords::MAXIMUM_PATTERN_MATRIX_WORD_LENGTH = 5;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Largest slab we build a matrix for (256 MB)
+const int AllWords::MAXIMUM_PATTERN_MATRIX_WORDS = 16384;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of all cache files together (1 GB)
+const qint64 AllWords::MAXIMUM_PATTERN_MATRIX_CACHE_SIZE = 1024ll << 20;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Make the feedback matrix for a word length available
+bool AllWords::PreparePatternMatrix(const int mcLength)
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // Already there? (Words added since have no row or column yet; then
+    // it is built again.)
+    const int num_words = GetSlabSize(mcLength);
+    if (m_PatternMatrices.contains(mcLength))
+    {
+        if (m_PatternMatrixSizes.value(mcLength) == num_words)
+        {
+            CALL_OUT("");
+            return true;
+        }
+        DropPatternMatrix(mcLength);
+    }
+
+    // Check if we can have a matrix for this length
+    if (mcLength < 1 ||
+        mcLength > MAXIMUM_PATTERN_MATRIX_WORD_LENGTH ||
+        num_words == 0 ||
+        num_words > MAXIMUM_PATTERN_MATRIX_WORDS)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    // Try the cache first
+    const quint64 slab_hash = CalculateSlabHash(mcLength);
+    const QString filename = GetPatternMatrixFileName(mcLength, slab_hash);
+    if (MapPatternMatrix(mcLength, filename, slab_hash))
+    {
+        CALL_OUT("");
+        return true;
+    }
+
+    // Build it: every row (guess) is independent and scored in one batch
+    const quint8 * letters = GetSlabLetters(mcLength);
+    QByteArray matrix(qsizetype(num_words) * num_words, Qt::Uninitialized);
+    quint8 * matrix_data = reinterpret_cast < quint8 * >(matrix.data());
+    const int num_threads = ParallelLoop::GetDefaultNumberOfThreads();
+    QList < QList < quint32 > > row_codes(num_threads,
+        QList < quint32 >(num_words));
+    ParallelLoop::Run(num_words, 16, num_threads,
+        [&](const int mcWorker, const int mcFirstGuess, const int mcLastGuess)
+        {
+            quint32 * codes = row_codes[mcWorker].data();
+            for (int guess = mcFirstGuess;
+                 guess < mcLastGuess;
+                 guess++)
+            {
+                Feedback::ScoreBatch(letters + guess * mcLength, letters,
+                    num_words, mcLength, codes);
+                quint8 * row = matrix_data + qsizetype(guess) * num_words;
+                for (int answer = 0;
+                     answer < num_words;
+                     answer++)
+                {
+                    row[answer] = quint8(codes[answer]);
+                }
+            }
+        });
+
+    // Save and map; keep it in memory if that does not work
+    if (SavePatternMatrix(mcLength, filename, slab_hash, matrix) &&
+        MapPatternMatrix(mcLength, filename, slab_hash))
+    {
+        CALL_OUT("");
+        return true;
+    }
+    m_PatternMatrixData[mcLength] = matrix;
+    m_PatternMatrices[mcLength] = reinterpret_cast < const quint8 * >(
+        m_PatternMatrixData[mcLength].constData());
+    m_PatternMatrixSizes[mcLength] = num_words;
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Feedback code for every guess (row) and answer (column)
+const quint8 * AllWords::GetPatternMatrix(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // Not if words were added since it was prepared
+    if (m_PatternMatrixSizes.value(mcLength) != GetSlabSize(mcLength))
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_PatternMatrices.value(mcLength, nullptr);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Hash of all words in a slab
+quint64 AllWords::CalculateSlabHash(const int mcLength) const
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // 64 bit FNV-1a over the letter codes (the slab holds the words from
+    // Words.txt as well as learned words, in order)
+    const QByteArray & slab = m_SlabLetters[mcLength];
+    quint64 hash = 14695981039346656037ull;
+    for (const char letter : slab)
+    {
+        hash = (hash ^ quint8(letter)) * 1099511628211ull;
+    }
+
+    CALL_OUT("");
+    return hash;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Cache file for a matrix
+QString AllWords::GetPatternMatrixFileName(const int mcLength,
+    const quint64 mcSlabHash) const
+{
+    CALL_IN(QString("mcLength=%1, mcSlabHash=%2")
+        .arg(QString::number(mcLength),
+             QString::number(mcSlabHash, 16)));
+
+    const QString directory =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QString filename = QString("%1/PatternMatrix-%2-%3.bin")
+        .arg(directory,
+             QString::number(mcLength),
+             QString::number(mcSlabHash, 16));
+
+    CALL_OUT("");
+    return filename;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Pattern matrix file format
+//   quint32 magic number
+//   quint32 version
+//   quint32 word length
+//   quint32 number of words
+//   quint64 slab hash
+//   quint8 feedback codes (number of words squared, row by row)
+// Header is written by QDataStream (big endian).
+static const quint32 PATTERN_MATRIX_MAGIC = 0x47575041;
+static const quint32 PATTERN_MATRIX_VERSION = 1;
+static const int PATTERN_MATRIX_HEADER_SIZE = 24;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Map matrix from the cache
+bool AllWords::MapPatternMatrix(const int mcLength, const QString mcFileName,
+    const quint64 mcSlabHash)
+{
+    CALL_IN(QString("mcLength=%1, mcFileName=\"%2\", mcSlabHash=%3")
+        .arg(QString::number(mcLength),
+             mcFileName,
+             QString::number(mcSlabHash, 16)));
+
+    // Open file
+    QFile * file = new QFile(mcFileName);
+    if (!file -> open(QIODevice::ReadOnly))
+    {
+        // Not cached yet. Not an error.
+        delete file;
+        CALL_OUT("");
+        return false;
+    }
+
+    // Check header
+    const int num_words = GetSlabSize(mcLength);
+    const qint64 matrix_size = qint64(num_words) * num_words;
+    QDataStream in(file);
+    quint32 magic;
+    quint32 version;
+    quint32 length;
+    quint32 file_num_words;
+    quint64 slab_hash;
+    in >> magic >> version >> length >> file_num_words >> slab_hash;
+    if (in.status() != QDataStream::Ok ||
+        magic != PATTERN_MATRIX_MAGIC ||
+        version != PATTERN_MATRIX_VERSION ||
+        length != quint32(mcLength) ||
+        file_num_words != quint32(num_words) ||
+        slab_hash != mcSlabHash ||
+        file -> size() != PATTERN_MATRIX_HEADER_SIZE + matrix_size)
+    {
+        // Outdated or broken; we'll overwrite it.
+        delete file;
+        CALL_OUT("");
+        return false;
+    }
+
+    // Map (pages are only read once they are used)
+    uchar * data = file -> map(PATTERN_MATRIX_HEADER_SIZE, matrix_size);
+    if (!data)
+    {
+        const QString reason = tr("Could not map \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        delete file;
+        CALL_OUT(reason);
+        return false;
+    }
+    m_PatternMatrixFiles[mcLength] = file;
+    m_PatternMatrices[mcLength] = data;
+    m_PatternMatrixSizes[mcLength] = num_words;
+
+    // Modification time tells when a cache file was last used
+    file -> setFileTime(QDateTime::currentDateTimeUtc(),
+        QFileDevice::FileModificationTime);
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Save matrix to the cache
+bool AllWords::SavePatternMatrix(const int mcLength, const QString mcFileName,
+    const quint64 mcSlabHash, const QByteArray & mcrMatrix)
+{
+    CALL_IN(QString("mcLength=%1, mcFileName=\"%2\", mcSlabHash=%3, "
+        "mcrMatrix=...")
+        .arg(QString::number(mcLength),
+             mcFileName,
+             QString::number(mcSlabHash, 16)));
+
+    // Make sure directory exists
+    const QFileInfo file_info(mcFileName);
+    QDir directory = file_info.dir();
+    if (!directory.mkpath("."))
+    {
+        const QString reason = tr("Could not create directory \"%1\".")
+            .arg(directory.path());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Matrices of other word lists stay until the cache is full
+    TrimPatternMatrixCache(directory.path(),
+        PATTERN_MATRIX_HEADER_SIZE + qint64(mcrMatrix.size()));
+
+    // Write everything; QSaveFile only replaces the file once complete
+    QSaveFile file(mcFileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        const QString reason = tr("Could not write \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    QDataStream out(&file);
+    out << PATTERN_MATRIX_MAGIC
+        << PATTERN_MATRIX_VERSION
+        << quint32(mcLength)
+        << quint32(GetSlabSize(mcLength))
+        << mcSlabHash;
+    out.writeRawData(mcrMatrix.constData(), mcrMatrix.size());
+    if (out.status() != QDataStream::Ok ||
+        !file.commit())
+    {
+        const QString reason = tr("Could not write \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Remove least recently used cache files
+void AllWords::TrimPatternMatrixCache(const QString mcDirectory,
+    const qint64 mcNewFileSize)
+{
+    CALL_IN(QString("mcDirectory=\"%1\", mcNewFileSize=%2")
+        .arg(mcDirectory,
+             QString::number(mcNewFileSize)));
+
+    // Files in use
+    QSet < QString > files_in_use;
+    for (const QFile * file : std::as_const(m_PatternMatrixFiles))
+    {
+        files_in_use.insert(QFileInfo(*file).absoluteFilePath());
+    }
+
+    // Keep the most recently used files that fit along with the new one
+    QDir directory(mcDirectory);
+    const QFileInfoList cache_files = directory.entryInfoList(
+        QStringList("PatternMatrix-*.bin"), QDir::Files, QDir::Time);
+    qint64 total_size = mcNewFileSize;
+    for (const QFileInfo & cache_file : cache_files)
+    {
+        total_size += cache_file.size();
+        if (total_size <= MAXIMUM_PATTERN_MATRIX_CACHE_SIZE ||
+            files_in_use.contains(cache_file.absoluteFilePath()))
+        {
+            continue;
+        }
+        if (directory.remove(cache_file.fileName()))
+        {
+            total_size -= cache_file.size();
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Forget matrix
+void AllWords::DropPatternMatrix(const int mcLength)
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    m_PatternMatrices.remove(mcLength);
+    m_PatternMatrixSizes.remove(mcLength);
+    m_PatternMatrixData.remove(mcLength);
+    if (m_PatternMatrixFiles.contains(mcLength))
+    {
+        // Closing the file also unmaps it
+        QFile * file = m_PatternMatrixFiles.take(mcLength);
+        file -> close();
+        delete file;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+// ================================================================= Word graph
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if any word starts with the given letters
+bool AllWords::IsValidPrefix(const QString mcPrefix,
+    const int mcWordLength) const
+{
+    CALL_IN(QString("mcPrefix=\"%1\", mcWordLength=%2")
+        .arg(mcPrefix,
+             QString::number(mcWordLength)));
+
+    // Nothing starts with letters we don't have (empty prefix is fine)
+    quint8 letters[MAXIMUM_WORD_LENGTH];
+    if (!mcPrefix.isEmpty() &&
+        !EncodeWord(mcPrefix, letters))
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    CALL_OUT("");
+    return IsValidPrefixForLetters(letters, mcPrefix.size(), mcWordLength);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if any word starts with the given letter codes
+bool AllWords::IsValidPrefixForLetters(const quint8 * mcpLetters,
+    const int mcLength, const int mcWordLength) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2, mcWordLength=%3")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength),
+             QString::number(mcWordLength)));
+
+    // Check parameters
+    if (!mcpLetters &&
+        mcLength > 0)
+    {
+        const QString reason = tr("No letters given.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Graph first, then the words added since it was built
+    if (m_WordGraph.IsPrefix(mcpLetters, mcLength, mcWordLength))
+    {
+        CALL_OUT("");
+        return true;
+    }
+    for (const quint32 word_id : m_UngraphedWords)
+    {
+        if (UngraphedWordHasPrefix(word_id, mcpLetters, mcLength,
+            mcWordLength))
+        {
+            CALL_OUT("");
+            return true;
+        }
+    }
+
+    CALL_OUT("");
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words starting with the given letters
+QList < QString > AllWords::GetWordsWithPrefix(const QString mcPrefix,
+    const int mcWordLength, const int mcMaximumNumber) const
+{
+    CALL_IN(QString("mcPrefix=\"%1\", mcWordLength=%2, mcMaximumNumber=%3")
+        .arg(mcPrefix,
+             QString::number(mcWordLength),
+             QString::number(mcMaximumNumber)));
+
+    // Nothing starts with letters we don't have (empty prefix is fine)
+    QList < QString > words;
+    quint8 letters[MAXIMUM_WORD_LENGTH];
+    if (!mcPrefix.isEmpty() &&
+        !EncodeWord(mcPrefix, letters))
+    {
+        CALL_OUT("");
+        return words;
+    }
+
+    // Graph, then the words added since it was built (the first ones of
+    // both together are the first ones overall)
+    QList < QByteArray > found = m_WordGraph.GetWordsWithPrefix(
+        letters, mcPrefix.size(), mcWordLength, mcMaximumNumber);
+    bool added = false;
+    for (const quint32 word_id : m_UngraphedWords)
+    {
+        if (UngraphedWordHasPrefix(word_id, letters, mcPrefix.size(),
+            mcWordLength))
+        {
+            found << QByteArray(reinterpret_cast < const char * >(
+                GetPackedLetters(word_id)), GetWordLength(word_id));
+            added = true;
+        }
+    }
+    if (added)
+    {
+        std::sort(found.begin(), found.end());
+        if (mcMaximumNumber >= 0 &&
+            found.size() > mcMaximumNumber)
+        {
+            found.resize(mcMaximumNumber);
+        }
+    }
+
+    // Convert to text
+    for (const QByteArray & word : found)
+    {
+        QString text(word.size(), QChar('a'));
+        for (int index = 0;
+             index < word.size();
+             index++)
+        {
+            text[index] = QChar('a' + word[index]);
+        }
+        words << text;
+    }
+
+    CALL_OUT("");
+    return words;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Graph of all words
+const WordGraph & AllWords::GetWordGraph() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_WordGraph;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rebuild the graph from the slabs
+void AllWords::UpdateWordGraph()
+{
+    CALL_IN("");
+
+    // Words are referenced in place
+    QList < QByteArray > words;
+    words.reserve(m_IDToLength.size());
+    for (int length = 1;
+         length < m_SlabLetters.size();
+         length++)
+    {
+        const char * slab = m_SlabLetters[length].constData();
+        const int num_words = m_SlabIDs[length].size();
+        for (int slab_index = 0;
+             slab_index < num_words;
+             slab_index++)
+        {
+            words << QByteArray::fromRawData(slab + slab_index * length,
+                length);
+        }
+    }
+    m_WordGraph.Build(words);
+    m_UngraphedWords.clear();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most words added before the graph is rebuilt
+const int AllWords::MAXIMUM_NUMBER_OF_UNGRAPHED_WORDS = 256;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words were added
+void AllWords::AddToWordGraph(const quint32 mcFirstWordID,
+    const int mcNumberOfWords)
+{
+    CALL_IN(QString("mcFirstWordID=%1, mcNumberOfWords=%2")
+        .arg(QString::number(mcFirstWordID),
+             QString::number(mcNumberOfWords)));
+
+    // Rebuilding is O(dictionary); only worth it for many words
+    if (m_UngraphedWords.size() + mcNumberOfWords >
+        MAXIMUM_NUMBER_OF_UNGRAPHED_WORDS)
+    {
+        UpdateWordGraph();
+        CALL_OUT("");
+        return;
+    }
+    for (int index = 0;
+         index < mcNumberOfWords;
+         index++)
+    {
+        m_UngraphedWords << mcFirstWordID + index;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word added since the graph was built starts with the given
+// letter codes
+bool AllWords::UngraphedWordHasPrefix(const quint32 mcWordID,
+    const quint8 * mcpLetters, const int mcLength,
+    const int mcWordLength) const
+{
+    CALL_IN(QString("mcWordID=%1, mcpLetters=..., mcLength=%2, "
+        "mcWordLength=%3")
+        .arg(QString::number(mcWordID),
+             QString::number(mcLength),
+             QString::number(mcWordLength)));
+
+    const int length = m_IDToLength[mcWordID];
+    const bool has_prefix =
+        (mcWordLength == -1 || length == mcWordLength) &&
+        length >= mcLength &&
+        (mcLength == 0 ||
+         memcmp(GetPackedLetters(mcWordID), mcpLetters, mcLength) == 0);
 
     CALL_OUT("");
+    return has_prefix;
 }
 
 
 
+// ==================================================================== Journal
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
-// Destructor
-AllWords::~AllWords()
+// Number of words after which the journal is synced
+const int AllWords::JOURNAL_BATCH_SIZE = 16;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Time (in milliseconds) after which pending words are synced
+const int AllWords::JOURNAL_FLUSH_DELAY = 1000;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words in the journal that triggers a compaction on startup
+const int AllWords::JOURNAL_COMPACTION_SIZE = 4096;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Journal file header
+static const quint32 JOURNAL_MAGIC = 0x47574a4c;
+static const quint32 JOURNAL_VERSION = 1;
+static const int JOURNAL_HEADER_SIZE = 8;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Move the words in the journal to the learned word list
+bool AllWords::CompactJournal()
 {
     CALL_IN("");
 
-    // Nothing to do.
+    // Everything has to be in the journal first
+    if (!FlushJournal())
+    {
+        const QString reason = tr("Could not flush journal.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Learned word list plus the words in the journal (there may be none
+    // if all records were duplicates; the journal is emptied regardless)
+    const QString filename = GetLearnedWordsFileName();
+    QByteArray text;
+    QFile learned_file(filename);
+    if (learned_file.exists())
+    {
+        if (!learned_file.open(QIODevice::ReadOnly))
+        {
+            const QString reason = tr("Could not read \"%1\".")
+                .arg(filename);
+            MessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
+        }
+        text = learned_file.readAll();
+        learned_file.close();
+        if (!text.isEmpty() &&
+            !text.endsWith('\n'))
+        {
+            text.append('\n');
+        }
+    }
+    for (const quint32 word_id : m_NewWords)
+    {
+        text.append(GetWordText(word_id).toLatin1());
+        text.append('\n');
+    }
+
+    // QSaveFile only replaces the list once complete. If we do not get to
+    // empty the journal below, its words are already known on the next
+    // replay and thus skipped.
+    QSaveFile save_file(filename);
+    if (!save_file.open(QIODevice::WriteOnly) ||
+        save_file.write(text) != text.size() ||
+        !save_file.commit())
+    {
+        const QString reason = tr("Could not write \"%1\".")
+            .arg(filename);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Journal starts over
+    if (!m_JournalFile.resize(JOURNAL_HEADER_SIZE) ||
+        !m_JournalFile.seek(JOURNAL_HEADER_SIZE) ||
+        !SyncFile(m_JournalFile))
+    {
+        const QString reason = tr("Could not truncate \"%1\".")
+            .arg(m_JournalFile.fileName());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    m_NewWords.clear();
 
     CALL_OUT("");
+    return true;
 }
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Instanciator
-AllWords * AllWords::Instance()
+// Write pending words to the journal and sync it to disk
+bool AllWords::FlushJournal()
 {
     CALL_IN("");
 
-    if (!m_Instance)
+    // Anything to do?
+    m_JournalTimer.stop();
+    if (m_PendingJournalRecords.isEmpty())
     {
-        m_Instance = new AllWords();
+        CALL_OUT("");
+        return true;
+    }
+    if (!m_JournalFile.isOpen())
+    {
+        const QString reason = tr("Journal is not open.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
     }
 
+    // Write all records in one go; if that fails, remove what made it to
+    // the file so later records don't end up behind a torn one
+    const qint64 position = m_JournalFile.pos();
+    if (m_JournalFile.write(m_PendingJournalRecords) !=
+            m_PendingJournalRecords.size() ||
+        !SyncFile(m_JournalFile))
+    {
+        m_JournalFile.resize(position);
+        m_JournalFile.seek(position);
+        const QString reason = tr("Could not write \"%1\".")
+            .arg(m_JournalFile.fileName());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    m_PendingJournalRecords.clear();
+    m_NumberOfPendingJournalWords = 0;
+
     CALL_OUT("");
-    return m_Instance;
+    return true;
 }
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Instance
-AllWords * AllWords::m_Instance = nullptr;
+// Journal file
+QString AllWords::GetJournalFileName() const
+{
+    CALL_IN("");
+
+    const QString directory =
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+
+    CALL_OUT("");
+    return directory + "/LearnedWords.journal";
+}
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Initialize available words
-void AllWords::InitWords()
+// Learned word list (same format as external word lists)
+QString AllWords::GetLearnedWordsFileName() const
 {
     CALL_IN("");
 
-    // Words we know
-    m_AllWords.clear();
+    const QString directory =
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+
+    CALL_OUT("");
+    return directory + "/LearnedWords.txt";
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Load the learned word list, then open the journal and add its words
+bool AllWords::ReplayJournal()
+{
+    CALL_IN("");
+
+    // Compacted words first (InitWords() brings everything else up to
+    // date afterwards)
+    const QString learned_filename = GetLearnedWordsFileName();
+    if (QFile::exists(learned_filename))
+    {
+        AddWordList(learned_filename);
+    }
 
-    QFile word_file(":/resources/Words.txt");
-    if (!word_file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Make sure directory exists
+    const QString filename = GetJournalFileName();
+    const QFileInfo file_info(filename);
+    QDir directory = file_info.dir();
+    if (!directory.mkpath("."))
     {
-        const QString reason = tr("Could not open \"Words.txt\".");
+        const QString reason = tr("Could not create directory \"%1\".")
+            .arg(directory.path());
         MessageLogger::Error(CALL_METHOD,
             reason);
         CALL_OUT(reason);
-        return;
+        return false;
     }
 
-    // Read all words
-    QSet < QString > known_words;
-    static const QRegularExpression valid_format("[a-zA-Z]+");
-    while (!word_file.atEnd())
+    // Open journal
+    m_JournalFile.setFileName(filename);
+    if (!m_JournalFile.open(QIODevice::ReadWrite))
     {
-        QString new_word = word_file.readLine().trimmed().toLower();
+        const QString reason = tr("Could not open \"%1\".")
+            .arg(filename);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
 
-        // Ignore empty lines
-        if (new_word.isEmpty())
+    // New journal: just the header
+    QDataStream stream(&m_JournalFile);
+    if (m_JournalFile.size() < JOURNAL_HEADER_SIZE)
+    {
+        m_JournalFile.resize(0);
+        stream << JOURNAL_MAGIC
+            << JOURNAL_VERSION;
+        if (stream.status() != QDataStream::Ok ||
+            !SyncFile(m_JournalFile))
         {
-            continue;
+            m_JournalFile.close();
+            const QString reason = tr("Could not write \"%1\".")
+                .arg(filename);
+            MessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
         }
+        CALL_OUT("");
+        return true;
+    }
+
+    // Check header; we leave journals we do not understand alone
+    quint32 magic;
+    quint32 version;
+    stream >> magic
+        >> version;
+    if (stream.status() != QDataStream::Ok ||
+        magic != JOURNAL_MAGIC ||
+        version != JOURNAL_VERSION)
+    {
+        m_JournalFile.close();
+        const QString reason = tr("\"%1\" is not a valid journal.")
+            .arg(filename);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Records are parsed in place
+    const qint64 file_size = m_JournalFile.size();
+    const quint8 * data = m_JournalFile.map(0, file_size);
+    if (!data)
+    {
+        m_JournalFile.close();
+        const QString reason = tr("Could not map \"%1\": %2")
+            .arg(filename,
+                 m_JournalFile.errorString());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
 
-        // Ignore potential comments
-        if (new_word[0] == '#')
+    // Collect words by length; a record that is incomplete or fails its
+    // check ends the journal (it was being written when we crashed)
+    QList < QByteArray > new_letters;
+    QSet < QByteArray > seen;
+    qint64 position = JOURNAL_HEADER_SIZE;
+    int num_records = 0;
+    while (position < file_size)
+    {
+        const int length = data[position];
+        if (length < 1 ||
+            length > MAXIMUM_WORD_LENGTH ||
+            position + 1 + length + 4 > file_size)
         {
-            continue;
+            break;
         }
-
-        // Make sure there are no invalid characters
-        const QRegularExpressionMatch match = valid_format.match(new_word);
-        if (!match.hasMatch())
+        const quint8 * letters = data + position + 1;
+        bool valid = WordBlob::Read(letters + length) ==
+            HashLetters(letters, length);
+        for (int index = 0;
+             valid && index < length;
+             index++)
         {
-            qDebug().noquote() << QString("Invalid word \"%1\" in database.")
-                .arg(new_word);
-            continue;
+            valid = letters[index] < 26;
         }
-
-        // Make sure there are no duplicates
-        if (known_words.contains(new_word))
+        if (!valid)
+        {
+            break;
+        }
+        position += 1 + length + 4;
+        num_records++;
+
+        // Skip words we know by now (e.g. from an interrupted compaction)
+        const QByteArray key = QByteArray::fromRawData(
+            reinterpret_cast < const char * >(letters), length);
+        if (FindPackedWord(letters, length) != INVALID_ID ||
+            seen.contains(key))
         {
-            qDebug().noquote() << QString("Duplicate word \"%1\" in database.")
-                .arg(new_word);
             continue;
         }
+        seen.insert(key);
+        if (new_letters.size() <= length)
+        {
+            new_letters.resize(length + 1);
+        }
+        new_letters[length].append(key);
+    }
+    seen.clear();
+    m_JournalFile.unmap(const_cast < uchar * >(data));
 
-        // Otherwise, keep the word
-        m_AllWords << new_word;
-        m_WordsForLength[new_word.size()] << new_word;
+    // Drop a torn record at the end
+    if (position < file_size)
+    {
+        qDebug().noquote() << tr("Dropping %1 bytes of incomplete records "
+            "at the end of \"%2\".")
+            .arg(QString::number(file_size - position),
+                 filename);
+        m_JournalFile.resize(position);
+        SyncFile(m_JournalFile);
+    }
+    m_JournalFile.seek(position);
 
-        // Check if word has duplicates
-        if (HasDuplicateLetters(new_word))
+    // Bulk insert
+    for (int length = 1;
+         length < new_letters.size();
+         length++)
+    {
+        if (new_letters[length].isEmpty())
+        {
+            continue;
+        }
+        const quint32 first_id =
+            AddPackedWords(new_letters[length], length, nullptr);
+        const int num_words = new_letters[length].size() / length;
+        for (int index = 0;
+             index < num_words;
+             index++)
         {
-            m_WordsWithDuplicateLetters << new_word;
+            m_NewWords << first_id + index;
         }
+    }
 
-        // Remember it for duplicate word protection
-        known_words << new_word;
+    // Compact once the journal got long
+    if (num_records >= JOURNAL_COMPACTION_SIZE)
+    {
+        CompactJournal();
     }
 
-    // Words we already had
-    m_UsedWords.clear();
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Queue a learned word for the journal
+void AllWords::AppendToJournal(const quint8 * mcpLetters,
+    const int mcLength)
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    // Length, letter codes, check
+    quint8 check[4];
+    WordBlob::Write(check, HashLetters(mcpLetters, mcLength));
+    m_PendingJournalRecords.append(char(mcLength));
+    m_PendingJournalRecords.append(
+        reinterpret_cast < const char * >(mcpLetters), mcLength);
+    m_PendingJournalRecords.append(
+        reinterpret_cast < const char * >(check), sizeof(check));
+    m_NumberOfPendingJournalWords++;
+
+    // Write now or a bit later
+    if (m_NumberOfPendingJournalWords >= JOURNAL_BATCH_SIZE)
+    {
+        FlushJournal();
+    } else if (!m_JournalTimer.isActive())
+    {
+        m_JournalTimer.start();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Make sure what was written to a file is on disk
+bool AllWords::SyncFile(QFile & mrFile)
+{
+    CALL_IN(QString("mrFile=\"%1\"")
+        .arg(mrFile.fileName()));
+
+    if (!mrFile.flush())
+    {
+        CALL_OUT("");
+        return false;
+    }
+#ifdef Q_OS_WIN
+    const bool synced = (_commit(mrFile.handle()) == 0);
+#else
+    const bool synced = (fsync(mrFile.handle()) == 0);
+#endif
 
     CALL_OUT("");
+    return synced;
 }
 
 
@@ -165,6 +3067,7 @@ void AllWords::SetWordSize(const int mcNewWordSize)
     {
         // Any size.
         m_WordSize = -1;
+        UpdateAvailableWords();
         CALL_OUT("");
         return;
     }
@@ -181,7 +3084,8 @@ void AllWords::SetWordSize(const int mcNewWordSize)
     }
 
     // Check if there are any words for this size
-    if (!m_WordsForLength.contains(mcNewWordSize))
+    if (mcNewWordSize >= m_SlabIDs.size() ||
+        m_SlabIDs[mcNewWordSize].isEmpty())
     {
         const QString reason = tr("No known words for word size %1.")
             .arg(QString::number(mcNewWordSize));
@@ -191,6 +3095,9 @@ void AllWords::SetWordSize(const int mcNewWordSize)
         return;
     }
 
+    m_WordSize = mcNewWordSize;
+    UpdateAvailableWords();
+
     CALL_OUT("");
 }
 
@@ -204,6 +3111,7 @@ void AllWords::SetAvoidDuplicateLetters(const bool mcNewState)
         .arg(mcNewState ? "true" : "false"));
 
     m_AvoidDuplicateLetters = mcNewState;
+    UpdateAvailableWords();
 
     CALL_OUT("");
 }
@@ -229,18 +3137,31 @@ bool AllWords::HasDuplicateLetters(const QString mcWord) const
     CALL_IN(QString("mcWord=\"%1\"")
         .arg(mcWord));
 
-    QSet < QString > letters_used;
+    // Letters a-z: keep track of what we have seen in a bit mask
+    quint32 letters_used = 0;
     for (int index = 0;
          index < mcWord.size();
          index++)
     {
-        if (letters_used.contains(mcWord[index]))
+        const char16_t letter = mcWord[index].toLower().unicode();
+        if (letter < 'a' || letter > 'z')
+        {
+            // Anything else; compare with the remaining characters directly
+            if (mcWord.indexOf(mcWord[index], index + 1) != -1)
+            {
+                CALL_OUT("");
+                return true;
+            }
+            continue;
+        }
+        const quint32 bit = quint32(1) << (letter - 'a');
+        if (letters_used & bit)
         {
             // We do have duplicate letters
             CALL_OUT("");
             return true;
         }
-        letters_used << mcWord[index];
+        letters_used |= bit;
     }
 
     // No duplicate letters
@@ -258,9 +3179,8 @@ void AllWords::AddWord(const QString mcNewWord)
         .arg(mcNewWord));
 
     // Check if word is valid
-    static const QRegularExpression format("[a-zA-Z]");
-    const QRegularExpressionMatch match = format.match(mcNewWord);
-    if (!match.hasMatch())
+    QByteArray letters;
+    if (!EncodeWord(mcNewWord, letters))
     {
         // Not a valid word
         const QString reason(tr("\"%1\" is not a valid word.")
@@ -284,8 +3204,8 @@ void AllWords::AddWord(const QString mcNewWord)
     }
 
     // Aleady in the list?
-    const QString word = mcNewWord.toLower();
-    if (m_AllWords.contains(word))
+    if (FindPackedWord(reinterpret_cast < const quint8 * >(
+            letters.constData()), letters.size()) != INVALID_ID)
     {
         const QString reason(tr("\"%1\" is already known.")
             .arg(mcNewWord));
@@ -296,13 +3216,13 @@ void AllWords::AddWord(const QString mcNewWord)
     }
 
     // Add to the lists
-    m_AllWords << word;
-    m_WordsForLength[word.size()] << word;
-    if (HasDuplicateLetters(word))
-    {
-        m_WordsWithDuplicateLetters << word;
-    }
-    m_NewWords << word;
+    const quint32 word_id = AddPackedWord(letters);
+    m_NewWords << word_id;
+    AppendToJournal(reinterpret_cast < const quint8 * >(letters.constData()),
+        letters.size());
+    UpdateAvailableWord(word_id);
+    UpdateLetterIndex();
+    AddToWordGraph(word_id, 1);
 
     CALL_OUT("");
 }
@@ -310,71 +3230,192 @@ void AllWords::AddWord(const QString mcNewWord)
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Dump new words
-void AllWords::DumpNewWords() const
+// Get a new word (which is then marked as used)
+QString AllWords::GetWord()
 {
     CALL_IN("");
 
-    qDebug().noquote() << tr("Here's a list of recently added words:");
-    for (const QString & word : m_NewWords)
+    // Pick one at random (by weight) if possible
+    const int picked = m_WordSampler.Pick(m_RandomStream);
+    if (picked == -1)
     {
-        qDebug().noquote() << word;
+        // Cannot pick a word.
+        CALL_OUT("");
+        return QString();
     }
+    const quint32 word_id = quint32(picked);
+
+    // Remember we used it
+    SetWordUsed(word_id);
 
     CALL_OUT("");
+    return GetWordText(word_id);
 }
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Get a new word
-QString AllWords::GetWord() const
+// Pick different words without marking them as used
+bool AllWords::PickWordIDs(quint32 * mpWordIDs, const int mcNumberOfWords)
 {
-    CALL_IN("");
+    CALL_IN(QString("mpWordIDs=%1, mcNumberOfWords=%2")
+        .arg(mpWordIDs ? "..." : "nullptr",
+             QString::number(mcNumberOfWords)));
 
-    // Words of the right size
-    QSet < QString > available_words;
-    if (m_WordSize == -1)
+    // Check parameters
+    if (mcNumberOfWords < 0)
     {
-        // Any words
-        available_words = m_AllWords;
-    } else if (m_WordsForLength.contains(m_WordSize))
+        const QString reason = tr("Invalid number of words %1.")
+            .arg(QString::number(mcNumberOfWords));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Words picked are out of the sampler until all are picked, so none
+    // comes up twice
+    int num_picked = 0;
+    while (num_picked < mcNumberOfWords)
+    {
+        const int picked = m_WordSampler.Pick(m_RandomStream);
+        if (picked == -1)
+        {
+            // Cannot pick a word.
+            break;
+        }
+        mpWordIDs[num_picked] = quint32(picked);
+        m_WordSampler.SetWeight(picked, 0);
+        num_picked++;
+    }
+    for (int index = 0;
+         index < num_picked;
+         index++)
     {
-        available_words = m_WordsForLength[m_WordSize];
+        const quint32 word_id = mpWordIDs[index];
+        m_WordSampler.SetWeight(int(word_id), m_IDToWeight[word_id]);
     }
 
-    // Not the ones we already had
-    available_words -= m_UsedWords;
+    CALL_OUT("");
+    return num_picked == mcNumberOfWords;
+}
 
-    // Check if we avoid duplicate letters
-    if (m_AvoidDuplicateLetters)
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Mark a word as used
+void AllWords::SetWordUsed(const quint32 mcWordID)
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Check if word ID is valid
+    if (mcWordID >= quint32(m_IDToLength.size()))
     {
-        available_words -= m_WordsWithDuplicateLetters;
+        const QString reason = tr("Invalid word ID %1.")
+            .arg(QString::number(mcWordID));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
     }
 
-    // Pick one at random if possible
-    if (available_words.isEmpty())
+    // Not available anymore
+    m_UsedWords.Set(mcWordID);
+    m_AvailableWords.Reset(mcWordID);
+    m_WordSampler.SetWeight(int(mcWordID), 0);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed for GetWord()
+void AllWords::SetSeed(const quint64 mcSeed)
+{
+    CALL_IN(QString("mcSeed=%1")
+        .arg(QString::number(mcSeed)));
+
+    m_Seed = mcSeed;
+    m_RandomStream.Seed(mcSeed, 0);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed for GetWord()
+quint64 AllWords::GetSeed() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Seed;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word for a game of a seeded sequence
+quint32 AllWords::GetWordIDForGame(const quint64 mcSeed,
+    const quint64 mcGameIndex) const
+{
+    CALL_IN(QString("mcSeed=%1, mcGameIndex=%2")
+        .arg(QString::number(mcSeed),
+             QString::number(mcGameIndex)));
+
+    const quint64 num_words = quint64(m_SelectableWords.GetCount());
+    if (num_words == 0)
     {
-        // Cannot pick a word.
-        return QString();
+        CALL_OUT("");
+        return INVALID_ID;
     }
-    int pick_index =
-        QRandomGenerator::global() -> bounded(0, available_words.size() - 1);
-    for (auto word_iterator = available_words.begin();
-         word_iterator != available_words.end();
-         word_iterator++)
+
+    // Every round through all words has a permutation of its own
+    const quint64 round = mcGameIndex / num_words;
+    const quint64 index = RandomStream::Permute(
+        RandomStream::GetKey(mcSeed, round), mcGameIndex % num_words,
+        num_words);
+
+    CALL_OUT("");
+    return quint32(m_SelectableWords.Select(int(index)));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word for a game of a seeded sequence
+QString AllWords::GetWordForGame(const quint64 mcSeed,
+    const quint64 mcGameIndex) const
+{
+    CALL_IN(QString("mcSeed=%1, mcGameIndex=%2")
+        .arg(QString::number(mcSeed),
+             QString::number(mcGameIndex)));
+
+    const quint32 word_id = GetWordIDForGame(mcSeed, mcGameIndex);
+    if (word_id == INVALID_ID)
     {
-        if (pick_index == 0)
-        {
-            CALL_OUT("");
-            return *word_iterator;
-        }
-        pick_index--;
+        CALL_OUT("");
+        return QString();
     }
 
-    // We should not get here
     CALL_OUT("");
-    return QString();
+    return GetWordText(word_id);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words that may still be picked
+int AllWords::GetNumberOfAvailableWords() const
+{
+    CALL_IN("");
+
+    // Words with weight 0 are never picked
+    CALL_OUT("");
+    return m_WordSampler.GetNumberOfActiveItems();
 }
 
 
@@ -387,7 +3428,21 @@ bool AllWords::IsValid(const QString mcWord) const
         .arg(mcWord));
 
     CALL_OUT("");
-    return m_AllWords.contains(mcWord.toLower());
+    return GetWordID(mcWord) != INVALID_ID;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a word given as characters is valid
+bool AllWords::IsValid(const char * mcpWord, const int mcLength) const
+{
+    CALL_IN(QString("mcpWord=%1, mcLength=%2")
+        .arg(mcpWord ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    CALL_OUT("");
+    return GetWordID(mcpWord, mcLength) != INVALID_ID;
 }
 
 
@@ -398,7 +3453,8 @@ void AllWords::ResetUsage()
 {
     CALL_IN("");
 
-    m_UsedWords.clear();
+    m_UsedWords.Fill(false);
+    UpdateAvailableWords();
 
     CALL_OUT("");
 }
@@ -4,10 +4,21 @@
 #ifndef ALLWORDS_H
 #define ALLWORDS_H
 
+// Project includes
+#include "AliasSampler.h"
+#include "BitVector.h"
+#include "RandomStream.h"
+#include "WordBlob.h"
+#include "WordGraph.h"
+
 // Qt includes
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
 #include <QObject>
-#include <QSet>
 #include <QString>
+#include <QTimer>
 
 
 
@@ -36,14 +47,371 @@ private:
     // Instance
     static AllWords * m_Instance;
 
-    // Initialize
+public:
+    // Initialize (again): load all words and reset usage
     void InitWords();
 
-    // Words
-    QSet < QString > m_AllWords;
-    QHash < int, QSet < QString > > m_WordsForLength;
-    QSet < QString > m_UsedWords;
-    QSet < QString > m_WordsWithDuplicateLetters;
+private:
+
+    // Partitions of all words (bit vectors over word IDs)
+    QList < BitVector > m_WordsOfLength;
+    BitVector m_UsedWords;
+    BitVector m_WordsWithDuplicateLetters;
+
+    // Words we may pick from with the current settings, regardless of
+    // usage, and those not used yet (both with rank/select index, so
+    // picking a word does not need to copy anything)
+    void UpdateAvailableWords();
+    BitVector m_SelectableWords;
+    BitVector m_AvailableWords;
+
+    // Same for a single new word, without rebuilding everything
+    void UpdateAvailableWord(const quint32 mcWordID);
+
+    // Weighted picking from the available words (unavailable words have
+    // weight 0 here)
+    AliasSampler m_WordSampler;
+
+
+
+    // =========================================================== Packed words
+public:
+    // Invalid word ID
+    static const quint32 INVALID_ID;
+
+    // Longest word we can store (games are limited to
+    // Feedback::MAXIMUM_WORD_LENGTH, which is shorter)
+    static const int MAXIMUM_WORD_LENGTH = WordBlob::MAXIMUM_WORD_LENGTH;
+
+    // Number of words known
+    int GetNumberOfWords() const;
+
+    // Word ID for a given word (INVALID_ID if unknown)
+    quint32 GetWordID(const QString mcWord) const;
+
+    // Word ID for a word given as characters (a-z in either case; no
+    // terminating zero needed) or as letter codes. Neither allocates any
+    // memory, so they are suitable for validating large batches of words.
+    quint32 GetWordID(const char * mcpWord, const int mcLength) const;
+    quint32 GetWordIDForLetters(const quint8 * mcpLetters,
+        const int mcLength) const;
+
+    // Text of a word
+    QString GetWordText(const quint32 mcWordID) const;
+
+    // Length of a word
+    int GetWordLength(const quint32 mcWordID) const;
+
+    // Letter codes (0 for "a" to 25 for "z") of a word
+    const quint8 * GetPackedLetters(const quint32 mcWordID) const;
+
+    // Convert a word to letter codes. Returns false if it contains anything
+    // but the letters a-z (in either case) or is too long.
+    static bool EncodeWord(const QString mcWord, QByteArray & mrLetters);
+
+    // Same, into a buffer of at least MAXIMUM_WORD_LENGTH letter codes
+    static bool EncodeWord(const QString mcWord, quint8 * mpLetters);
+    static bool EncodeWord(const char * mcpWord, const int mcLength,
+        quint8 * mpLetters);
+
+    // Convert letter codes back to a word (lower case)
+    static QString DecodeWord(const quint8 * mcpLetters, const int mcLength);
+
+    // Weight for picking a word (from the word list, 1 if it has none);
+    // words are picked with a probability proportional to their weight,
+    // and never if it is 0
+    void SetWordWeight(const quint32 mcWordID, const float mcWeight);
+    float GetWordWeight(const quint32 mcWordID) const;
+
+    // Add the words of an external word list (one per line, a-z in either
+    // case, optionally followed by a weight as in Words.txt; empty lines and
+    // lines starting with "#" are ignored). The file is mapped rather than
+    // read, and parsed and deduplicated in parallel.
+    // Returns the number of words added, or -1 if the file cannot be read.
+    int LoadWordList(const QString mcFileName);
+
+private:
+    // Same without updating available words, letter index and word graph
+    // (for InitWords(), which updates them once everything is loaded)
+    int AddWordList(const QString mcFileName);
+
+
+
+    // =========================================================== Letter masks
+public:
+    // Number of letters in the alphabet
+    static const int NUMBER_OF_LETTERS;
+
+    // Letters present in a word: bit n is set if letter n ("a" = 0) occurs
+    quint32 GetLetterMask(const quint32 mcWordID) const;
+
+    // Check if a word contains a given letter (0 for "a" to 25 for "z")
+    bool ContainsLetter(const quint32 mcWordID, const int mcLetter) const;
+
+    // Number of occurrences of a given letter in a word
+    int GetLetterCount(const quint32 mcWordID, const int mcLetter) const;
+
+    // Number of occurrences of each letter (NUMBER_OF_LETTERS entries)
+    void GetLetterCounts(const quint32 mcWordID, quint8 * mpCounts) const;
+
+    // Check if a word (by ID) has duplicate letters
+    bool HasDuplicateLetters(const quint32 mcWordID) const;
+
+    // Letter mask and packed letter counts for letter codes
+    static quint32 CalculateLetterMask(const quint8 * mcpLetters,
+        const int mcLength);
+    static void CalculateLetterCounts(const quint8 * mcpLetters,
+        const int mcLength, quint64 * mpPackedCounts);
+
+private:
+    // For each word length, letter mask and letter counts of the words in
+    // the slab (same order as the letter codes). Counts use 4 bits per letter
+    // (saturating at 15), letters "a" to "p" in the first 64 bit word and
+    // "q" to "z" in the second one.
+    QList < QList < quint32 > > m_SlabLetterMasks;
+    QList < QList < quint64 > > m_SlabLetterCounts;
+
+
+
+    // =========================================================== Letter index
+public:
+    // Raw access to the slab for a given word length (for filters and
+    // solvers); all arrays have one entry per word (two for letter counts)
+    int GetSlabSize(const int mcLength) const;
+    const quint8 * GetSlabLetters(const int mcLength) const;
+    const quint32 * GetSlabIDs(const int mcLength) const;
+    const quint32 * GetSlabLetterMasks(const int mcLength) const;
+    const quint64 * GetSlabLetterCounts(const int mcLength) const;
+
+    // Words of a slab with a given letter at a given position (bit vector
+    // over the indices within the slab)
+    const BitVector & GetPositionLetterBits(const int mcLength,
+        const int mcPosition, const int mcLetter) const;
+
+    // Maximum count supported by GetLetterCountBits()
+    static const int MAXIMUM_INDEXED_LETTER_COUNT;
+
+    // Words of a slab with at least a given number of occurrences of a
+    // letter (bit vector over the indices within the slab)
+    const BitVector & GetLetterCountBits(const int mcLength,
+        const int mcLetter, const int mcMinimumCount) const;
+
+private:
+    // Bring letter index up to date with the slabs
+    void UpdateLetterIndex();
+
+    // For each word length: position * NUMBER_OF_LETTERS + letter
+    QList < QList < BitVector > > m_SlabPositionLetterBits;
+
+    // For each word length: (count - 1) * NUMBER_OF_LETTERS + letter
+    QList < QList < BitVector > > m_SlabLetterCountBits;
+
+private:
+    // Add a new word to the packed store; returns its ID
+    quint32 AddPackedWord(const QByteArray & mcrLetters);
+
+    // Add new words of the same length (letter codes back to back) to the
+    // packed store, with their weights (one per word; nullptr for the
+    // default weight); returns the ID of the first one
+    quint32 AddPackedWords(const QByteArray & mcrLetters,
+        const int mcLength, const float * mcpWeights);
+
+    // Find the ID of a word given as letter codes (INVALID_ID if unknown)
+    quint32 FindPackedWord(const quint8 * mcpLetters,
+        const int mcLength) const;
+
+    // Hash for letter codes
+    static quint32 HashLetters(const quint8 * mcpLetters, const int mcLength);
+
+    // Rebuild the lookup table
+    void RebuildLookupTable(const int mcCapacity);
+
+    // Load the dictionary blob compiled at build time (see WordBlob.h); the
+    // letters are used in place, nothing is parsed
+    bool LoadWordBlob();
+
+    // Slabs: for each word length, the letter codes of all words of that
+    // length, stored back to back (i.e. with a stride of the word length).
+    // Together they form the arena; every word is stored exactly once.
+    QList < QByteArray > m_SlabLetters;
+
+    // For each word length, the IDs of the words in that slab (in order)
+    QList < QList < quint32 > > m_SlabIDs;
+
+    // For each word ID, its length, its index within the slab and its
+    // weight
+    QList < quint8 > m_IDToLength;
+    QList < quint32 > m_IDToSlabIndex;
+    QList < float > m_IDToWeight;
+
+    // Words from the blob (IDs 0 to m_NumberOfBlobWords - 1) are found
+    // through the blob's perfect hash
+    int m_NumberOfBlobWords;
+    quint32 m_BlobHashSeed;
+    quint32 m_BlobNumberOfBuckets;
+    const quint8 * m_BlobDisplacements;
+    const quint8 * m_BlobSlots;
+    const quint8 * m_BlobFingerprints;
+
+    // Copy of the blob, only needed if the resource was compressed
+    QByteArray m_BlobCopy;
+
+    // Overflow table: open addressing hash table of the IDs of words added
+    // later (INVALID_ID marks a free slot) until they make it into the word
+    // list and thus the blob; capacity is always a power of two and at least
+    // twice the number of these words
+    QList < quint32 > m_LookupTable;
+
+
+
+    // ========================================================= Pattern matrix
+public:
+    // Longest words whose feedback code fits in a byte (3^5 = 243 codes)
+    static const int MAXIMUM_PATTERN_MATRIX_WORD_LENGTH;
+
+    // Largest slab we build a matrix for (the matrix has one byte for every
+    // pair of words)
+    static const int MAXIMUM_PATTERN_MATRIX_WORDS;
+
+    // Size of all cache files together; the least recently used ones are
+    // removed beyond that
+    static const qint64 MAXIMUM_PATTERN_MATRIX_CACHE_SIZE;
+
+    // Make the feedback matrix for a word length available: map it from the
+    // cache file if it matches the current words, otherwise build it (in
+    // parallel) and write it to the cache. Returns false if there is no
+    // matrix for this length.
+    bool PreparePatternMatrix(const int mcLength);
+
+    // Feedback code for every guess (row) and answer (column), both given as
+    // index within the slab; nullptr if not prepared, or if words of this
+    // length were added since
+    const quint8 * GetPatternMatrix(const int mcLength) const;
+
+private:
+    // Hash of all words in a slab (identifies the matrix contents)
+    quint64 CalculateSlabHash(const int mcLength) const;
+
+    // Cache file for a matrix
+    QString GetPatternMatrixFileName(const int mcLength,
+        const quint64 mcSlabHash) const;
+
+    // Cache file handling
+    bool MapPatternMatrix(const int mcLength, const QString mcFileName,
+        const quint64 mcSlabHash);
+    bool SavePatternMatrix(const int mcLength, const QString mcFileName,
+        const quint64 mcSlabHash, const QByteArray & mcrMatrix);
+
+    // Remove least recently used cache files until there is room for a
+    // new one (files in use are kept)
+    void TrimPatternMatrixCache(const QString mcDirectory,
+        const qint64 mcNewFileSize);
+
+    // Forget matrix (e.g. because words were added)
+    void DropPatternMatrix(const int mcLength);
+
+    // Matrices by word length; either mapped from a file or in memory.
+    // Words are only appended to slabs, so a matrix of fewer words than its
+    // slab has is out of date.
+    QHash < int, const quint8 * > m_PatternMatrices;
+    QHash < int, int > m_PatternMatrixSizes;
+    QHash < int, QFile * > m_PatternMatrixFiles;
+    QHash < int, QByteArray > m_PatternMatrixData;
+
+
+
+    // ============================================================= Word graph
+public:
+    // Check if any word starts with the given letters (and has mcWordLength
+    // letters, unless that is -1)
+    bool IsValidPrefix(const QString mcPrefix, const int mcWordLength) const;
+
+    // Same for letter codes (without allocating any memory)
+    bool IsValidPrefixForLetters(const quint8 * mcpLetters,
+        const int mcLength, const int mcWordLength) const;
+
+    // Words starting with the given letters (with mcWordLength letters
+    // unless that is -1), in alphabetical order; at most mcMaximumNumber of
+    // them unless that is -1
+    QList < QString > GetWordsWithPrefix(const QString mcPrefix,
+        const int mcWordLength, const int mcMaximumNumber) const;
+
+    // Graph of all words (except the ones added since it was last built;
+    // see below)
+    const WordGraph & GetWordGraph() const;
+
+    // Most words added (learned or loaded) before the graph is rebuilt
+    static const int MAXIMUM_NUMBER_OF_UNGRAPHED_WORDS;
+
+private:
+    // Rebuild the graph from the slabs
+    void UpdateWordGraph();
+    WordGraph m_WordGraph;
+
+    // Words were added: prefix queries check them on the side until there
+    // are too many, then the graph is rebuilt (so learning a word does not
+    // rebuild it every time)
+    void AddToWordGraph(const quint32 mcFirstWordID,
+        const int mcNumberOfWords);
+
+    // Check if a word added since the graph was built starts with the
+    // given letter codes (and has mcWordLength letters, unless that is -1)
+    bool UngraphedWordHasPrefix(const quint32 mcWordID,
+        const quint8 * mcpLetters, const int mcLength,
+        const int mcWordLength) const;
+
+    // Words added since the graph was built
+    QList < quint32 > m_UngraphedWords;
+
+
+
+    // ================================================================ Journal
+public:
+    // Words learned through AddWord() are appended to a journal in the
+    // application data directory, so they survive a crash. Writes are
+    // batched: the journal is synced to disk after JOURNAL_BATCH_SIZE words
+    // or JOURNAL_FLUSH_DELAY milliseconds, whichever comes first. On startup
+    // the learned word list and then the journal are loaded; once the
+    // journal holds JOURNAL_COMPACTION_SIZE words, they are moved to the
+    // learned word list and the journal starts over.
+    static const int JOURNAL_BATCH_SIZE;
+    static const int JOURNAL_FLUSH_DELAY;
+    static const int JOURNAL_COMPACTION_SIZE;
+
+    // Move the words in the journal to the learned word list
+    bool CompactJournal();
+
+public slots:
+    // Write pending words to the journal and sync it to disk
+    bool FlushJournal();
+
+private:
+    // Files
+    QString GetJournalFileName() const;
+    QString GetLearnedWordsFileName() const;
+
+    // Load the learned word list, then open the journal (creating it if
+    // needed) and add its words in bulk
+    bool ReplayJournal();
+
+    // Queue a learned word for the journal
+    void AppendToJournal(const quint8 * mcpLetters, const int mcLength);
+
+    // Make sure what was written to a file is on disk
+    static bool SyncFile(QFile & mrFile);
+
+    // Journal: header, then one record per word (length, letter codes and
+    // HashLetters() of the letter codes as a check for torn writes)
+    QFile m_JournalFile;
+
+    // Records not written yet, and when to write them
+    QByteArray m_PendingJournalRecords;
+    int m_NumberOfPendingJournalWords;
+    QTimer m_JournalTimer;
+
+    // Words in the journal (i.e. learned since the last compaction)
+    QList < quint32 > m_NewWords;
+
 
 
     // ================================================================= Access
@@ -63,20 +431,47 @@ public:
     // Check if a word has duplicate letters
     bool HasDuplicateLetters(const QString mcWord) const;
 
-    // Add word
+    // Add word (it is kept in the journal, see below)
     void AddWord(const QString mcNewWord);
 
-    // Dump new words
-    void DumpNewWords() const;
+public:
+    // Get a new word (which is then marked as used); words are weighted
+    // (see SetWordWeight()), picking takes O(1)
+    QString GetWord();
+
+    // Pick different words the same way without marking them as used (e.g.
+    // until a game with them has started). Returns false if there are not
+    // enough words.
+    bool PickWordIDs(quint32 * mpWordIDs, const int mcNumberOfWords);
+
+    // Mark a word as used
+    void SetWordUsed(const quint32 mcWordID);
+
+    // Seed for GetWord() (a random one unless set; the same seed and the
+    // same settings give the same sequence of words)
+    void SetSeed(const quint64 mcSeed);
+    quint64 GetSeed() const;
 private:
-    QList < QString > m_NewWords;
+    quint64 m_Seed;
+    RandomStream m_RandomStream;
 
 public:
-    // Get a new word
-    QString GetWord() const;
+    // Word for a game of a seeded sequence (e.g. a daily puzzle, with the
+    // day as the game index), from the words that may be picked with the
+    // current settings, used or not. Every word comes up once before any
+    // comes up again, so weights do not apply. O(1) for any game index;
+    // nothing is marked as used.
+    quint32 GetWordIDForGame(const quint64 mcSeed,
+        const quint64 mcGameIndex) const;
+    QString GetWordForGame(const quint64 mcSeed,
+        const quint64 mcGameIndex) const;
+
+    // Number of words that may still be picked
+    int GetNumberOfAvailableWords() const;
 
     // Check if a word is valid (according to the database)
     bool IsValid(const QString mcWord) const;
+    bool IsValid(const char * mcpWord, const int mcLength) const;
 
     // Reset usage
     void ResetUsage();
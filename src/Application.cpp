@@ -3,8 +3,8 @@
 
 // Project includes
 #include "Application.h"
-#include "CallTracer.h"
 #include "MessageLogger.h"
+#include "Tracing.h"
 
 // Qt includes
 #include <QDebug>
@@ -47,13 +47,16 @@ Application::~Application()
 // Instanciator
 Application * Application::Instance(int & argc, char ** argv)
 {
-    QStringList arg_values;
-    for (int index = 0; index < argc; index++)
-    {
-        arg_values << argv[index];
-    }
     CALL_IN(QString("argc=%1, argv={\"%2\"}")
-        .arg(argc).arg(arg_values.join("\", \"")));
+        .arg(argc).arg([&]()
+            {
+                QStringList arg_values;
+                for (int index = 0; index < argc; index++)
+                {
+                    arg_values << argv[index];
+                }
+                return arg_values.join("\", \"");
+            }()));
 
     if (!m_Instance)
     {
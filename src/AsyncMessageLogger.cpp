@@ -0,0 +1,571 @@
+// AsyncMessageLogger.cpp
+// Class definition
+
+// Project includes
+#include "AsyncMessageLogger.h"
+#include "MessageLogger.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QSemaphore>
+#include <QThread>
+
+// System includes
+#include <cstdio>
+#include <utility>
+
+
+
+// A message as queued
+struct AsyncMessageLoggerRecord
+{
+    qint64 m_Time;
+    quintptr m_Thread;
+    QString m_Method;
+    QString m_Reason;
+    int m_NumberSuppressed;
+};
+
+// Queue slot. The sequence number says whether the slot is free for the
+// producer at a position (sequence == position) or holds a message for the
+// consumer (sequence == position + 1).
+struct AsyncMessageLoggerSlot
+{
+    std::atomic < quint64 > m_Sequence;
+    AsyncMessageLoggerRecord m_Record;
+};
+
+// Bounded queue; any thread may push, and pop (the writer pops, and
+// producers do when dropping the oldest message)
+struct AsyncMessageLoggerQueue
+{
+    AsyncMessageLoggerQueue()
+    {
+        for (int index = 0;
+             index < AsyncMessageLogger::QUEUE_SIZE;
+             index++)
+        {
+            m_Slots[index].m_Sequence.store(quint64(index),
+                std::memory_order_relaxed);
+        }
+    }
+    AsyncMessageLoggerSlot m_Slots[AsyncMessageLogger::QUEUE_SIZE];
+    alignas(64) std::atomic < quint64 > m_PushPosition { 0 };
+    alignas(64) std::atomic < quint64 > m_PopPosition { 0 };
+};
+static AsyncMessageLoggerQueue s_Queue;
+
+// Rate limit: recent messages by hash (a collision just starts a new
+// interval; counts may be slightly off when threads race, which is fine
+// for a rate limit)
+struct AsyncMessageLoggerRate
+{
+    std::atomic < quint64 > m_Key { 0 };
+    std::atomic < qint64 > m_IntervalStart { 0 };
+    std::atomic < int > m_NumberInInterval { 0 };
+    std::atomic < int > m_NumberSuppressed { 0 };
+};
+static const int NUMBER_OF_RATES = 256;
+static AsyncMessageLoggerRate s_Rates[NUMBER_OF_RATES];
+
+// Configuration
+static std::atomic < int > s_OverflowPolicy {
+    AsyncMessageLogger::Overflow_DropNewest };
+static std::atomic < int > s_RateLimit {
+    AsyncMessageLogger::DEFAULT_RATE_LIMIT };
+static std::atomic < int > s_RateInterval {
+    AsyncMessageLogger::DEFAULT_RATE_INTERVAL };
+static QString s_FileName;
+
+// Statistics; every message pushed is eventually done (written, or dropped
+// as the oldest one)
+static std::atomic < quint64 > s_NumberPushed { 0 };
+static std::atomic < quint64 > s_NumberDone { 0 };
+static std::atomic < quint64 > s_NumberDropped { 0 };
+static std::atomic < quint64 > s_NumberSuppressed { 0 };
+
+// Producers currently in Error() (so Stop() can wait for them)
+static std::atomic < int > s_NumberOfProducers { 0 };
+
+// Background writer. It sleeps when the queue is empty; producers wake it
+// up (and it checks every now and then anyway, in case a wake-up crossed
+// its going to sleep).
+static QThread * s_Writer = nullptr;
+static QFile s_LogFile;
+static QSemaphore s_WakeUp;
+static std::atomic < bool > s_WriterSleeping { false };
+static std::atomic < bool > s_StopWriter { false };
+static const int WRITER_TIMEOUT = 100;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add a message to the queue (false if it is full)
+static bool Push(AsyncMessageLoggerRecord & mrRecord)
+{
+    quint64 position = s_Queue.m_PushPosition.load(std::memory_order_relaxed);
+    AsyncMessageLoggerSlot * slot;
+    while (true)
+    {
+        slot = &s_Queue.m_Slots[position % AsyncMessageLogger::QUEUE_SIZE];
+        const qint64 difference =
+            qint64(slot -> m_Sequence.load(std::memory_order_acquire)) -
+            qint64(position);
+        if (difference == 0)
+        {
+            if (s_Queue.m_PushPosition.compare_exchange_weak(position,
+                position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        } else if (difference < 0)
+        {
+            // Full
+            return false;
+        } else
+        {
+            position =
+                s_Queue.m_PushPosition.load(std::memory_order_relaxed);
+        }
+    }
+    slot -> m_Record = std::move(mrRecord);
+    slot -> m_Sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Take the oldest message from the queue (false if it is empty)
+static bool Pop(AsyncMessageLoggerRecord & mrRecord)
+{
+    quint64 position = s_Queue.m_PopPosition.load(std::memory_order_relaxed);
+    AsyncMessageLoggerSlot * slot;
+    while (true)
+    {
+        slot = &s_Queue.m_Slots[position % AsyncMessageLogger::QUEUE_SIZE];
+        const qint64 difference =
+            qint64(slot -> m_Sequence.load(std::memory_order_acquire)) -
+            qint64(position + 1);
+        if (difference == 0)
+        {
+            if (s_Queue.m_PopPosition.compare_exchange_weak(position,
+                position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        } else if (difference < 0)
+        {
+            // Empty
+            return false;
+        } else
+        {
+            position = s_Queue.m_PopPosition.load(std::memory_order_relaxed);
+        }
+    }
+    mrRecord = std::move(slot -> m_Record);
+    slot -> m_Sequence.store(position + AsyncMessageLogger::QUEUE_SIZE,
+        std::memory_order_release);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Wake up the writer if it sleeps
+static inline void WakeUpWriter()
+{
+    if (s_WriterSleeping.load(std::memory_order_relaxed) &&
+        s_WriterSleeping.exchange(false))
+    {
+        s_WakeUp.release();
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a line to stderr and the log file
+static void WriteLine(const QString mcLine)
+{
+    const QByteArray line = mcLine.toLocal8Bit() + '\n';
+    std::fputs(line.constData(), stderr);
+    if (s_LogFile.isOpen())
+    {
+        s_LogFile.write(line);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Format and write a message
+static void Write(const AsyncMessageLoggerRecord & mcrRecord)
+{
+    QString line = QString("%1 [%2] %3: %4")
+        .arg(QDateTime::fromMSecsSinceEpoch(mcrRecord.m_Time)
+                .toString("yyyy-MM-dd hh:mm:ss.zzz"),
+             QString::number(mcrRecord.m_Thread, 16),
+             mcrRecord.m_Method,
+             mcrRecord.m_Reason);
+    if (mcrRecord.m_NumberSuppressed > 0)
+    {
+        line += QObject::tr(" (%1 identical messages suppressed before)")
+            .arg(mcrRecord.m_NumberSuppressed);
+    }
+    WriteLine(line);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Background writer
+static void RunWriter()
+{
+    AsyncMessageLoggerRecord record;
+    while (true)
+    {
+        if (Pop(record))
+        {
+            Write(record);
+            s_NumberDone.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+
+        // Queue is empty
+        std::fflush(stderr);
+        if (s_LogFile.isOpen())
+        {
+            s_LogFile.flush();
+        }
+        if (s_StopWriter.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        s_WriterSleeping.store(true);
+        if (Pop(record))
+        {
+            s_WriterSleeping.store(false);
+            Write(record);
+            s_NumberDone.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+        s_WakeUp.tryAcquire(1, WRITER_TIMEOUT);
+        s_WriterSleeping.store(false);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Whether the calling thread is the GUI thread
+static inline bool IsGuiThread()
+{
+    const QCoreApplication * application = QCoreApplication::instance();
+    return application &&
+        QThread::currentThread() == application -> thread();
+}
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+AsyncMessageLogger::AsyncMessageLogger()
+{
+    // Nothing to do.
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+std::atomic < bool > AsyncMessageLogger::m_Running { false };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start the background writer
+bool AsyncMessageLogger::Start()
+{
+    if (IsRunning())
+    {
+        return true;
+    }
+
+    // Log file
+    if (!s_FileName.isEmpty())
+    {
+        s_LogFile.setFileName(s_FileName);
+        if (!s_LogFile.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            const QString reason =
+                QObject::tr("Could not open log file \"%1\": %2")
+                    .arg(s_FileName,
+                         s_LogFile.errorString());
+            MessageLogger::Error(CALL_METHOD,
+                reason);
+            return false;
+        }
+    }
+
+    s_StopWriter.store(false);
+    s_Writer = QThread::create(RunWriter);
+    s_Writer -> setObjectName("AsyncMessageLogger");
+    s_Writer -> start(QThread::LowPriority);
+    m_Running.store(true, std::memory_order_release);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write everything queued and stop the background writer
+void AsyncMessageLogger::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+
+    // No new messages; wait for producers still pushing
+    m_Running.store(false);
+    while (s_NumberOfProducers.load() > 0)
+    {
+        QThread::yieldCurrentThread();
+    }
+
+    // Writer empties the queue before it ends
+    s_StopWriter.store(true, std::memory_order_release);
+    s_WakeUp.release();
+    s_Writer -> wait();
+    delete s_Writer;
+    s_Writer = nullptr;
+
+    // Totals
+    const quint64 num_dropped = GetNumberOfDroppedMessages();
+    const quint64 num_suppressed = GetNumberOfSuppressedMessages();
+    if (num_dropped > 0 ||
+        num_suppressed > 0)
+    {
+        WriteLine(QObject::tr("%1 messages dropped because the log queue "
+            "was full, %2 identical messages suppressed.")
+                .arg(QString::number(num_dropped),
+                     QString::number(num_suppressed)));
+    }
+    std::fflush(stderr);
+    if (s_LogFile.isOpen())
+    {
+        s_LogFile.close();
+    }
+}
+
+
+
+// ============================================================== Configuration
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Overflow policy
+void AsyncMessageLogger::SetOverflowPolicy(const OverflowPolicy mcPolicy)
+{
+    s_OverflowPolicy.store(mcPolicy, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Overflow policy
+AsyncMessageLogger::OverflowPolicy AsyncMessageLogger::GetOverflowPolicy()
+{
+    return OverflowPolicy(s_OverflowPolicy.load(std::memory_order_relaxed));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rate limit for identical messages
+void AsyncMessageLogger::SetRateLimit(const int mcMaxMessages,
+    const int mcInterval)
+{
+    if (mcMaxMessages < 0 ||
+        mcInterval < 1)
+    {
+        const QString reason =
+            QObject::tr("Invalid rate limit %1 messages per %2 ms.")
+                .arg(QString::number(mcMaxMessages),
+                     QString::number(mcInterval));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        return;
+    }
+    s_RateLimit.store(mcMaxMessages, std::memory_order_relaxed);
+    s_RateInterval.store(mcInterval, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Log file
+void AsyncMessageLogger::SetFileName(const QString mcFileName)
+{
+    if (IsRunning())
+    {
+        const QString reason =
+            QObject::tr("Log file cannot change while the writer runs.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        return;
+    }
+    s_FileName = mcFileName;
+}
+
+
+
+// ==================================================================== Logging
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Log an error
+void AsyncMessageLogger::Error(const QString mcMethod, const QString mcReason)
+{
+    s_NumberOfProducers.fetch_add(1);
+    if (!IsRunning())
+    {
+        s_NumberOfProducers.fetch_sub(1);
+        MessageLogger::Error(mcMethod, mcReason);
+        return;
+    }
+
+    // Rate limit
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int num_suppressed = 0;
+    const int rate_limit = s_RateLimit.load(std::memory_order_relaxed);
+    if (rate_limit > 0)
+    {
+        quint64 key = (quint64(quint32(qHash(mcMethod))) << 32) |
+            quint32(qHash(mcReason));
+        if (key == 0)
+        {
+            key = 1;
+        }
+        AsyncMessageLoggerRate & rate = s_Rates[key % NUMBER_OF_RATES];
+        const bool same_message =
+            rate.m_Key.load(std::memory_order_relaxed) == key;
+        if (!same_message ||
+            now - rate.m_IntervalStart.load(std::memory_order_relaxed) >=
+                s_RateInterval.load(std::memory_order_relaxed))
+        {
+            // New interval
+            rate.m_Key.store(key, std::memory_order_relaxed);
+            rate.m_IntervalStart.store(now, std::memory_order_relaxed);
+            rate.m_NumberInInterval.store(1, std::memory_order_relaxed);
+            num_suppressed = rate.m_NumberSuppressed.exchange(0);
+            if (!same_message)
+            {
+                // Those were another message's
+                num_suppressed = 0;
+            }
+        } else if (rate.m_NumberInInterval.fetch_add(1,
+            std::memory_order_relaxed) >= rate_limit)
+        {
+            rate.m_NumberSuppressed.fetch_add(1, std::memory_order_relaxed);
+            s_NumberSuppressed.fetch_add(1, std::memory_order_relaxed);
+            s_NumberOfProducers.fetch_sub(1);
+            return;
+        }
+    }
+
+    // Queue it
+    AsyncMessageLoggerRecord record { now,
+        quintptr(QThread::currentThreadId()), mcMethod, mcReason,
+        num_suppressed };
+    OverflowPolicy policy = GetOverflowPolicy();
+    if (policy == Overflow_Block &&
+        IsGuiThread())
+    {
+        policy = Overflow_DropNewest;
+    }
+    bool pushed = Push(record);
+    if (!pushed &&
+        policy == Overflow_DropOldest)
+    {
+        // A few tries (other producers may take the room first)
+        for (int attempt = 0;
+             attempt < 4 && !pushed;
+             attempt++)
+        {
+            AsyncMessageLoggerRecord oldest;
+            if (Pop(oldest))
+            {
+                s_NumberDropped.fetch_add(1, std::memory_order_relaxed);
+                s_NumberDone.fetch_add(1, std::memory_order_release);
+            }
+            pushed = Push(record);
+        }
+    } else if (!pushed &&
+        policy == Overflow_Block)
+    {
+        while (!pushed)
+        {
+            WakeUpWriter();
+            QThread::yieldCurrentThread();
+            pushed = Push(record);
+        }
+    }
+    if (pushed)
+    {
+        s_NumberPushed.fetch_add(1, std::memory_order_release);
+        WakeUpWriter();
+    } else
+    {
+        s_NumberDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_NumberOfProducers.fetch_sub(1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Wait until everything queued so far has been written
+void AsyncMessageLogger::Flush()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+    const quint64 target = s_NumberPushed.load(std::memory_order_acquire);
+    while (s_NumberDone.load(std::memory_order_acquire) < target)
+    {
+        WakeUpWriter();
+        QThread::msleep(1);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Messages dropped because the queue was full
+quint64 AsyncMessageLogger::GetNumberOfDroppedMessages()
+{
+    return s_NumberDropped.load(std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Messages suppressed by the rate limit
+quint64 AsyncMessageLogger::GetNumberOfSuppressedMessages()
+{
+    return s_NumberSuppressed.load(std::memory_order_relaxed);
+}
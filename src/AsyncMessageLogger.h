@@ -0,0 +1,108 @@
+// AsyncMessageLogger.h
+// Class definition
+
+#ifndef ASYNCMESSAGELOGGER_H
+#define ASYNCMESSAGELOGGER_H
+
+// Qt includes
+#include <QString>
+#include <QtGlobal>
+
+// System includes
+#include <atomic>
+
+
+
+// Class definition
+class AsyncMessageLogger
+{
+    // Drop-in for MessageLogger::Error() on hot paths (BitVector and
+    // GameSession, and requests a server connection refuses). Once
+    // started, Error() only pushes the message into a bounded queue; a
+    // background thread formats it and writes it to stderr (and a log file,
+    // if set). Before Start() and after Stop(), messages go straight to
+    // MessageLogger::Error().
+    //
+    // Pushing takes no locks. When the queue is full, the overflow policy
+    // decides what happens; the GUI thread never waits, though (it drops
+    // the new message instead). Identical messages (same method and reason)
+    // beyond a number per interval are suppressed; the writer reports how
+    // many were when the message comes up again, and the totals on Stop().
+    //
+    // This class is not traced itself.
+
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    AsyncMessageLogger();
+
+public:
+    // Start the background writer
+    static bool Start();
+
+    // Write everything queued and stop the background writer
+    static void Stop();
+
+    // Whether the background writer is running
+    static inline bool IsRunning()
+    {
+        return m_Running.load(std::memory_order_acquire);
+    }
+
+
+
+    // ========================================================== Configuration
+public:
+    // What happens when the queue is full
+    enum OverflowPolicy {
+        // The new message is dropped
+        Overflow_DropNewest = 0,
+
+        // The oldest queued message is dropped to make room
+        Overflow_DropOldest,
+
+        // Wait until there is room (except on the GUI thread)
+        Overflow_Block
+    };
+
+    // Number of messages the queue holds (a power of two)
+    static const int QUEUE_SIZE = 1024;
+
+    // Default rate limit: identical messages per interval
+    static const int DEFAULT_RATE_LIMIT = 10;
+    static const int DEFAULT_RATE_INTERVAL = 1000;
+
+    // Overflow policy (default: drop newest)
+    static void SetOverflowPolicy(const OverflowPolicy mcPolicy);
+    static OverflowPolicy GetOverflowPolicy();
+
+    // At most mcMaxMessages identical messages every mcInterval ms
+    // (0 messages: no limit)
+    static void SetRateLimit(const int mcMaxMessages, const int mcInterval);
+
+    // Also append messages to this file (set before Start(); empty: stderr
+    // only)
+    static void SetFileName(const QString mcFileName);
+
+private:
+    // Runtime switch
+    static std::atomic < bool > m_Running;
+
+
+
+    // ================================================================ Logging
+public:
+    // Log an error (same as MessageLogger::Error())
+    static void Error(const QString mcMethod, const QString mcReason);
+
+    // Wait until everything queued so far has been written
+    static void Flush();
+
+    // Messages dropped because the queue was full
+    static quint64 GetNumberOfDroppedMessages();
+
+    // Messages suppressed by the rate limit
+    static quint64 GetNumberOfSuppressedMessages();
+};
+
+#endif
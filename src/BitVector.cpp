@@ -0,0 +1,583 @@
+// BitVector.cpp
+// Class definition
+
+// Project includes
+#include "AsyncMessageLogger.h"
+#include "BitVector.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QObject>
+#include <QtAlgorithms>
+
+// System includes
+#include <algorithm>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+BitVector::BitVector()
+{
+    CALL_IN("");
+
+    m_Size = 0;
+    m_TreeStep = 0;
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+BitVector::~BitVector()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ===================================================================== Access
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size (in bits)
+void BitVector::Resize(const int mcNewSize)
+{
+    CALL_IN(QString("mcNewSize=%1")
+        .arg(QString::number(mcNewSize)));
+
+    // Check if size is valid
+    if (mcNewSize < 0)
+    {
+        const QString reason = QObject::tr("Invalid size %1.")
+            .arg(QString::number(mcNewSize));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // New words are zero; clear bits beyond the new size in the last word
+    m_Words.resize((mcNewSize + 63) / 64, 0);
+    if (mcNewSize % 64 != 0)
+    {
+        m_Words.last() &= (quint64(1) << (mcNewSize % 64)) - 1;
+    }
+    m_Size = mcNewSize;
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size (in bits)
+int BitVector::GetSize() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Size;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Set all bits to the same value
+void BitVector::Fill(const bool mcValue)
+{
+    CALL_IN(QString("mcValue=%1")
+        .arg(mcValue ? "true" : "false"));
+
+    m_Words.fill(mcValue ? ~quint64(0) : quint64(0));
+    if (mcValue &&
+        m_Size % 64 != 0)
+    {
+        m_Words.last() = (quint64(1) << (m_Size % 64)) - 1;
+    }
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Set individual bit
+void BitVector::Set(const int mcIndex)
+{
+    CALL_IN(QString("mcIndex=%1")
+        .arg(QString::number(mcIndex)));
+
+    // Check if index is valid
+    if (mcIndex < 0 ||
+        mcIndex >= m_Size)
+    {
+        const QString reason = QObject::tr("Invalid index %1.")
+            .arg(QString::number(mcIndex));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Check if there is anything to do
+    const quint64 bit = quint64(1) << (mcIndex % 64);
+    quint64 & word = m_Words[mcIndex / 64];
+    if (word & bit)
+    {
+        CALL_OUT("");
+        return;
+    }
+    word |= bit;
+
+    // Keep index up to date
+    if (m_IndexValid)
+    {
+        for (int node = mcIndex / 64 + 1;
+             node < m_Tree.size();
+             node += node & -node)
+        {
+            m_Tree[node]++;
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Reset individual bit
+void BitVector::Reset(const int mcIndex)
+{
+    CALL_IN(QString("mcIndex=%1")
+        .arg(QString::number(mcIndex)));
+
+    // Check if index is valid
+    if (mcIndex < 0 ||
+        mcIndex >= m_Size)
+    {
+        const QString reason = QObject::tr("Invalid index %1.")
+            .arg(QString::number(mcIndex));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Check if there is anything to do
+    const quint64 bit = quint64(1) << (mcIndex % 64);
+    quint64 & word = m_Words[mcIndex / 64];
+    if (!(word & bit))
+    {
+        CALL_OUT("");
+        return;
+    }
+    word &= ~bit;
+
+    // Keep index up to date
+    if (m_IndexValid)
+    {
+        for (int node = mcIndex / 64 + 1;
+             node < m_Tree.size();
+             node += node & -node)
+        {
+            m_Tree[node]--;
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Test individual bit
+bool BitVector::Test(const int mcIndex) const
+{
+    CALL_IN(QString("mcIndex=%1")
+        .arg(QString::number(mcIndex)));
+
+    // Check if index is valid
+    if (mcIndex < 0 ||
+        mcIndex >= m_Size)
+    {
+        const QString reason = QObject::tr("Invalid index %1.")
+            .arg(QString::number(mcIndex));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    CALL_OUT("");
+    return (m_Words[mcIndex / 64] >> (mcIndex % 64)) & 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk operation: copy other bit vector
+void BitVector::Assign(const BitVector & mcrOther)
+{
+    CALL_IN("mcrOther=...");
+
+    // Copy bits but keep our allocation if possible
+    m_Words.resize(mcrOther.m_Words.size());
+    std::copy(mcrOther.m_Words.constBegin(), mcrOther.m_Words.constEnd(),
+        m_Words.begin());
+    m_Size = mcrOther.m_Size;
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk operation: and
+void BitVector::And(const BitVector & mcrOther)
+{
+    CALL_IN("mcrOther=...");
+
+    // Check if sizes match
+    if (m_Size != mcrOther.m_Size)
+    {
+        const QString reason = QObject::tr("Size mismatch (%1 vs %2).")
+            .arg(QString::number(m_Size),
+                 QString::number(mcrOther.m_Size));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Simple loop over words; compilers vectorize this
+    quint64 * words = m_Words.data();
+    const quint64 * other_words = mcrOther.m_Words.constData();
+    for (int index = 0;
+         index < m_Words.size();
+         index++)
+    {
+        words[index] &= other_words[index];
+    }
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk operation: and not
+void BitVector::AndNot(const BitVector & mcrOther)
+{
+    CALL_IN("mcrOther=...");
+
+    // Check if sizes match
+    if (m_Size != mcrOther.m_Size)
+    {
+        const QString reason = QObject::tr("Size mismatch (%1 vs %2).")
+            .arg(QString::number(m_Size),
+                 QString::number(mcrOther.m_Size));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Simple loop over words; compilers vectorize this
+    quint64 * words = m_Words.data();
+    const quint64 * other_words = mcrOther.m_Words.constData();
+    for (int index = 0;
+         index < m_Words.size();
+         index++)
+    {
+        words[index] &= ~other_words[index];
+    }
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk operation: or
+void BitVector::Or(const BitVector & mcrOther)
+{
+    CALL_IN("mcrOther=...");
+
+    // Check if sizes match
+    if (m_Size != mcrOther.m_Size)
+    {
+        const QString reason = QObject::tr("Size mismatch (%1 vs %2).")
+            .arg(QString::number(m_Size),
+                 QString::number(mcrOther.m_Size));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Simple loop over words; compilers vectorize this
+    quint64 * words = m_Words.data();
+    const quint64 * other_words = mcrOther.m_Words.constData();
+    for (int index = 0;
+         index < m_Words.size();
+         index++)
+    {
+        words[index] |= other_words[index];
+    }
+    m_IndexValid = false;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Raw 64 bit words
+const quint64 * BitVector::GetWords() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Words.constData();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Raw 64 bit words
+quint64 * BitVector::GetWords()
+{
+    CALL_IN("");
+
+    // Caller may change anything
+    m_IndexValid = false;
+
+    CALL_OUT("");
+    return m_Words.data();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of raw 64 bit words
+int BitVector::GetNumberOfWords() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Words.size();
+}
+
+
+
+// ====================================================================== Index
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// (Re)build rank/select index
+void BitVector::UpdateIndex()
+{
+    CALL_IN("");
+
+    // Node i (1-based) covers words (i - lowbit(i), i]
+    const int num_words = m_Words.size();
+    m_Tree.resize(num_words + 1);
+    m_Tree[0] = 0;
+    for (int node = 1;
+         node <= num_words;
+         node++)
+    {
+        m_Tree[node] = qPopulationCount(m_Words[node - 1]);
+    }
+    for (int node = 1;
+         node <= num_words;
+         node++)
+    {
+        const int parent = node + (node & -node);
+        if (parent <= num_words)
+        {
+            m_Tree[parent] += m_Tree[node];
+        }
+    }
+
+    // Largest power of two not exceeding the number of words (for descent)
+    m_TreeStep = 1;
+    while (2 * m_TreeStep <= num_words)
+    {
+        m_TreeStep *= 2;
+    }
+    m_IndexValid = true;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Is index valid?
+bool BitVector::IsIndexValid() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_IndexValid;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of bits set
+int BitVector::GetCount() const
+{
+    CALL_IN("");
+
+    // Fast if we have an index
+    if (m_IndexValid)
+    {
+        const int count = Rank(m_Size);
+        CALL_OUT("");
+        return count;
+    }
+
+    // Count the hard way
+    int count = 0;
+    for (const quint64 word : m_Words)
+    {
+        count += qPopulationCount(word);
+    }
+
+    CALL_OUT("");
+    return count;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of bits set before a given index
+int BitVector::Rank(const int mcIndex) const
+{
+    CALL_IN(QString("mcIndex=%1")
+        .arg(QString::number(mcIndex)));
+
+    // Need index
+    if (!m_IndexValid)
+    {
+        const QString reason = QObject::tr("Index is not up to date.");
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    // Check if index is valid
+    if (mcIndex < 0 ||
+        mcIndex > m_Size)
+    {
+        const QString reason = QObject::tr("Invalid index %1.")
+            .arg(QString::number(mcIndex));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return 0;
+    }
+
+    // Full words before the index
+    int rank = 0;
+    for (int node = mcIndex / 64;
+         node > 0;
+         node -= node & -node)
+    {
+        rank += m_Tree[node];
+    }
+
+    // Partial word
+    if (mcIndex % 64 != 0)
+    {
+        rank += qPopulationCount(m_Words[mcIndex / 64]
+            & ((quint64(1) << (mcIndex % 64)) - 1));
+    }
+
+    CALL_OUT("");
+    return rank;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Index of the set bit with the given rank
+int BitVector::Select(const int mcRank) const
+{
+    CALL_IN(QString("mcRank=%1")
+        .arg(QString::number(mcRank)));
+
+    // Need index
+    if (!m_IndexValid)
+    {
+        const QString reason = QObject::tr("Index is not up to date.");
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return -1;
+    }
+
+    // Check rank
+    if (mcRank < 0)
+    {
+        CALL_OUT("");
+        return -1;
+    }
+
+    // Descend the Fenwick tree to find the word containing the bit
+    const int num_words = m_Words.size();
+    int word_index = 0;
+    int remaining = mcRank;
+    for (int step = m_TreeStep;
+         step > 0;
+         step /= 2)
+    {
+        if (word_index + step <= num_words &&
+            m_Tree[word_index + step] <= remaining)
+        {
+            word_index += step;
+            remaining -= m_Tree[word_index];
+        }
+    }
+    if (word_index >= num_words)
+    {
+        // Not that many bits set
+        CALL_OUT("");
+        return -1;
+    }
+
+    // Find bit within word
+    quint64 word = m_Words[word_index];
+    for (int skip = 0;
+         skip < remaining;
+         skip++)
+    {
+        word &= word - 1;
+    }
+
+    CALL_OUT("");
+    return 64 * word_index + qCountTrailingZeroBits(word);
+}
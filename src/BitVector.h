@@ -0,0 +1,80 @@
+// BitVector.h
+// Class definition
+
+#ifndef BITVECTOR_H
+#define BITVECTOR_H
+
+// Qt includes
+#include <QList>
+
+
+
+// Class definition
+class BitVector
+{
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    BitVector();
+
+    // Destructor
+    ~BitVector();
+
+
+
+    // ================================================================= Access
+public:
+    // Size (in bits)
+    void Resize(const int mcNewSize);
+    int GetSize() const;
+
+    // Set all bits to the same value
+    void Fill(const bool mcValue);
+
+    // Individual bits
+    void Set(const int mcIndex);
+    void Reset(const int mcIndex);
+    bool Test(const int mcIndex) const;
+
+    // Bulk operations; both bit vectors must have the same size
+    void Assign(const BitVector & mcrOther);
+    void And(const BitVector & mcrOther);
+    void AndNot(const BitVector & mcrOther);
+    void Or(const BitVector & mcrOther);
+
+    // Raw 64 bit words (bit i is bit i % 64 of word i / 64). Bits beyond the
+    // size are always zero. Modifying the words invalidates the index.
+    const quint64 * GetWords() const;
+    quint64 * GetWords();
+    int GetNumberOfWords() const;
+private:
+    QList < quint64 > m_Words;
+    int m_Size;
+
+
+
+    // ================================================================== Index
+public:
+    // (Re)build rank/select index. Bulk operations and resizing invalidate
+    // the index; setting or resetting individual bits keeps it up to date.
+    void UpdateIndex();
+    bool IsIndexValid() const;
+
+    // Number of bits set
+    int GetCount() const;
+
+    // Number of bits set before a given index (needs index)
+    int Rank(const int mcIndex) const;
+
+    // Index of the set bit with the given rank, i.e. Select(0) is the first
+    // set bit (needs index); -1 if there is no such bit
+    int Select(const int mcRank) const;
+private:
+    // Fenwick tree over the bit counts of the 64 bit words. This gives us
+    // rank, select and single bit updates in O(log n) without allocating.
+    QList < int > m_Tree;
+    int m_TreeStep;
+    bool m_IndexValid;
+};
+
+#endif
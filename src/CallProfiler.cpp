@@ -0,0 +1,370 @@
+// CallProfiler.cpp
+// Class definition
+
+// Project includes
+#include "CallProfiler.h"
+#include "RingTracer.h"
+
+// Qt includes
+#include <QDebug>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QStringList>
+
+// System includes
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+
+
+// Numbers for one function on one thread. Only the owning thread writes
+// them (with plain loads and stores, no read-modify-write), the report may
+// read them at any time.
+struct CallProfilerStats
+{
+    std::atomic < quint64 > m_Calls { 0 };
+    std::atomic < quint64 > m_InclusiveTime { 0 };
+    std::atomic < quint64 > m_ExclusiveTime { 0 };
+    std::atomic < quint64 > m_MaximumTime { 0 };
+    std::atomic < quint64 > m_Histogram[CallProfiler::NUMBER_OF_BUCKETS] {};
+};
+
+// Function IDs are split into pages of stats, allocated when first used
+static const int PAGE_SIZE = 256;
+static const int NUMBER_OF_PAGES = 65536 / PAGE_SIZE;
+
+// Call in progress
+struct CallProfilerFrame
+{
+    quint16 m_FunctionID;
+    quint64 m_Start;
+    quint64 m_ChildTime;
+};
+
+// Everything a thread measures
+struct CallProfilerThread
+{
+    std::atomic < CallProfilerStats * > m_Pages[NUMBER_OF_PAGES] {};
+    QList < CallProfilerFrame > m_Stack;
+};
+
+// State of the calling thread (created on its first call)
+static thread_local CallProfilerThread * s_Thread = nullptr;
+
+// All threads (they live until the application ends, so the report
+// includes threads that are gone); only touched with the lock held
+static QMutex s_Mutex;
+static QList < CallProfilerThread * > s_Threads;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Current time (in nanoseconds)
+static inline quint64 GetTime()
+{
+    return quint64(std::chrono::duration_cast < std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add to a number only this thread writes
+static inline void Add(std::atomic < quint64 > & mrValue,
+    const quint64 mcIncrement)
+{
+    mrValue.store(mrValue.load(std::memory_order_relaxed) + mcIncrement,
+        std::memory_order_relaxed);
+}
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+CallProfiler::CallProfiler()
+{
+    // Nothing to do.
+}
+
+
+
+// ================================================================== Measuring
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+std::atomic < bool > CallProfiler::m_Enabled { false };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+void CallProfiler::SetEnabled(const bool mcEnabled)
+{
+    m_Enabled.store(mcEnabled, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A call starts
+void CallProfiler::Enter(const quint16 mcFunctionID)
+{
+    // First call on this thread
+    CallProfilerThread * thread = s_Thread;
+    if (!thread)
+    {
+        thread = new CallProfilerThread();
+        thread -> m_Stack.reserve(64);
+        QMutexLocker locker(&s_Mutex);
+        s_Threads << thread;
+        s_Thread = thread;
+    }
+
+    thread -> m_Stack << CallProfilerFrame { mcFunctionID, GetTime(), 0 };
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A call ends
+void CallProfiler::Exit(const quint16 mcFunctionID)
+{
+    const quint64 now = GetTime();
+    CallProfilerThread * thread = s_Thread;
+    if (!thread ||
+        thread -> m_Stack.isEmpty() ||
+        thread -> m_Stack.last().m_FunctionID != mcFunctionID)
+    {
+        // Cannot happen with scopes; ignore rather than corrupt the stack
+        return;
+    }
+
+    // Time of this call, and what it adds to its caller
+    const CallProfilerFrame frame = thread -> m_Stack.takeLast();
+    const quint64 inclusive = now - frame.m_Start;
+    const quint64 exclusive = inclusive > frame.m_ChildTime ?
+        inclusive - frame.m_ChildTime : 0;
+    if (!thread -> m_Stack.isEmpty())
+    {
+        thread -> m_Stack.last().m_ChildTime += inclusive;
+    }
+
+    // Stats for this function
+    std::atomic < CallProfilerStats * > & page =
+        thread -> m_Pages[mcFunctionID / PAGE_SIZE];
+    CallProfilerStats * stats = page.load(std::memory_order_relaxed);
+    if (!stats)
+    {
+        stats = new CallProfilerStats[PAGE_SIZE];
+        page.store(stats, std::memory_order_release);
+    }
+    CallProfilerStats & function = stats[mcFunctionID % PAGE_SIZE];
+    Add(function.m_Calls, 1);
+    Add(function.m_InclusiveTime, inclusive);
+    Add(function.m_ExclusiveTime, exclusive);
+    if (inclusive > function.m_MaximumTime.load(std::memory_order_relaxed))
+    {
+        function.m_MaximumTime.store(inclusive, std::memory_order_relaxed);
+    }
+    const int bucket = inclusive == 0 ? 0 :
+        qMin(63 - qCountLeadingZeroBits(inclusive), NUMBER_OF_BUCKETS - 1);
+    Add(function.m_Histogram[bucket], 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of histogram buckets
+const int CallProfiler::NUMBER_OF_BUCKETS;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Forget everything measured so far
+void CallProfiler::Reset()
+{
+    QMutexLocker locker(&s_Mutex);
+    for (CallProfilerThread * thread : s_Threads)
+    {
+        for (int page_index = 0;
+             page_index < NUMBER_OF_PAGES;
+             page_index++)
+        {
+            CallProfilerStats * stats =
+                thread -> m_Pages[page_index].load(std::memory_order_acquire);
+            if (!stats)
+            {
+                continue;
+            }
+            for (int index = 0;
+                 index < PAGE_SIZE;
+                 index++)
+            {
+                CallProfilerStats & function = stats[index];
+                function.m_Calls.store(0, std::memory_order_relaxed);
+                function.m_InclusiveTime.store(0, std::memory_order_relaxed);
+                function.m_ExclusiveTime.store(0, std::memory_order_relaxed);
+                function.m_MaximumTime.store(0, std::memory_order_relaxed);
+                for (std::atomic < quint64 > & count : function.m_Histogram)
+                {
+                    count.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+
+
+// ===================================================================== Report
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Functions sorted by exclusive time
+QString CallProfiler::GetReport()
+{
+    // Add up all threads
+    struct Total
+    {
+        int m_FunctionID;
+        quint64 m_Calls;
+        quint64 m_InclusiveTime;
+        quint64 m_ExclusiveTime;
+        quint64 m_MaximumTime;
+        quint64 m_Histogram[NUMBER_OF_BUCKETS];
+    };
+    QList < Total > totals;
+    {
+        QMutexLocker locker(&s_Mutex);
+        QList < int > function_to_total(65536, -1);
+        for (CallProfilerThread * thread : s_Threads)
+        {
+            for (int page_index = 0;
+                 page_index < NUMBER_OF_PAGES;
+                 page_index++)
+            {
+                const CallProfilerStats * stats = thread ->
+                    m_Pages[page_index].load(std::memory_order_acquire);
+                if (!stats)
+                {
+                    continue;
+                }
+                for (int index = 0;
+                     index < PAGE_SIZE;
+                     index++)
+                {
+                    const CallProfilerStats & function = stats[index];
+                    const quint64 calls =
+                        function.m_Calls.load(std::memory_order_relaxed);
+                    if (calls == 0)
+                    {
+                        continue;
+                    }
+                    const int function_id = page_index * PAGE_SIZE + index;
+                    if (function_to_total[function_id] == -1)
+                    {
+                        function_to_total[function_id] = totals.size();
+                        totals << Total { function_id, 0, 0, 0, 0, {} };
+                    }
+                    Total & total = totals[function_to_total[function_id]];
+                    total.m_Calls += calls;
+                    total.m_InclusiveTime += function.m_InclusiveTime.load(
+                        std::memory_order_relaxed);
+                    total.m_ExclusiveTime += function.m_ExclusiveTime.load(
+                        std::memory_order_relaxed);
+                    total.m_MaximumTime = qMax(total.m_MaximumTime,
+                        function.m_MaximumTime.load(
+                            std::memory_order_relaxed));
+                    for (int bucket = 0;
+                         bucket < NUMBER_OF_BUCKETS;
+                         bucket++)
+                    {
+                        total.m_Histogram[bucket] +=
+                            function.m_Histogram[bucket].load(
+                                std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+    }
+    if (totals.isEmpty())
+    {
+        return QObject::tr("No calls profiled.");
+    }
+    std::sort(totals.begin(), totals.end(),
+        [](const Total & mcrFirst, const Total & mcrSecond)
+        {
+            return mcrFirst.m_ExclusiveTime > mcrSecond.m_ExclusiveTime;
+        });
+
+    // Upper limit of the bucket holding a given fraction of the calls
+    auto percentile = [](const Total & mcrTotal, const double mcFraction)
+    {
+        const quint64 target = quint64(mcFraction * mcrTotal.m_Calls);
+        quint64 count = 0;
+        for (int bucket = 0;
+             bucket < NUMBER_OF_BUCKETS;
+             bucket++)
+        {
+            count += mcrTotal.m_Histogram[bucket];
+            if (count > target)
+            {
+                return qMin(quint64(1) << (bucket + 1),
+                    mcrTotal.m_MaximumTime);
+            }
+        }
+        return mcrTotal.m_MaximumTime;
+    };
+    auto microseconds = [](const double mcNanoseconds)
+    {
+        return QString::number(mcNanoseconds / 1000.0, 'f', 1)
+            .rightJustified(12, ' ');
+    };
+
+    // One line per function
+    QStringList lines;
+    lines << QString("%1%2%3%4%5%6%7%8  %9")
+        .arg(QString("calls").rightJustified(10, ' '),
+             QString("incl [us]").rightJustified(12, ' '),
+             QString("excl [us]").rightJustified(12, ' '),
+             QString("mean [us]").rightJustified(12, ' '),
+             QString("p50 [us]").rightJustified(12, ' '),
+             QString("p90 [us]").rightJustified(12, ' '),
+             QString("p99 [us]").rightJustified(12, ' '),
+             QString("max [us]").rightJustified(12, ' '),
+             QString("function"));
+    for (const Total & total : std::as_const(totals))
+    {
+        lines << QString("%1%2%3%4%5%6%7%8  %9")
+            .arg(QString::number(total.m_Calls).rightJustified(10, ' '),
+                 microseconds(total.m_InclusiveTime),
+                 microseconds(total.m_ExclusiveTime),
+                 microseconds(double(total.m_InclusiveTime) / total.m_Calls),
+                 microseconds(percentile(total, 0.5)),
+                 microseconds(percentile(total, 0.9)),
+                 microseconds(percentile(total, 0.99)),
+                 microseconds(total.m_MaximumTime),
+                 QString::fromUtf8(
+                    RingTracer::GetFunctionName(quint16(total.m_FunctionID))));
+    }
+    return lines.join("\n");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Print the report
+void CallProfiler::PrintReport()
+{
+    qDebug().noquote() << GetReport();
+}
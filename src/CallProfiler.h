@@ -0,0 +1,72 @@
+// CallProfiler.h
+// Class definition
+
+#ifndef CALLPROFILER_H
+#define CALLPROFILER_H
+
+// Qt includes
+#include <QString>
+#include <QtGlobal>
+
+// System includes
+#include <atomic>
+
+
+
+// Class definition
+class CallProfiler
+{
+    // The profiler measures every traced call (see Tracing.h, level 1) while
+    // it is enabled: number of calls, inclusive time (including the traced
+    // functions it calls), exclusive time (without them) and a histogram of
+    // call durations. Nothing is sampled. Every thread keeps its own
+    // numbers, so measuring takes no locks; they are only added up for the
+    // report. Time spent in recursive calls counts once per level.
+    //
+    // Function IDs are the ones interned by RingTracer. This class is not
+    // traced itself.
+
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    CallProfiler();
+
+
+
+    // ============================================================== Measuring
+public:
+    // Runtime switch
+    static void SetEnabled(const bool mcEnabled);
+    static inline bool IsEnabled()
+    {
+        return m_Enabled.load(std::memory_order_relaxed);
+    }
+
+    // A call starts/ends on the calling thread (always in pairs)
+    static void Enter(const quint16 mcFunctionID);
+    static void Exit(const quint16 mcFunctionID);
+
+    // Histogram buckets: bucket n holds calls that took 2^n to 2^(n+1)
+    // nanoseconds (the last one everything longer)
+    static const int NUMBER_OF_BUCKETS = 40;
+
+    // Forget everything measured so far
+    static void Reset();
+
+private:
+    // Runtime switch
+    static std::atomic < bool > m_Enabled;
+
+
+
+    // ================================================================= Report
+public:
+    // Functions sorted by exclusive time, with calls, inclusive and exclusive
+    // time, mean and percentiles (from the histogram)
+    static QString GetReport();
+
+    // Print the report
+    static void PrintReport();
+};
+
+#endif
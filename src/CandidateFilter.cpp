@@ -0,0 +1,537 @@
+// CandidateFilter.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "CandidateFilter.h"
+#include "Feedback.h"
+#include "MessageLogger.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QObject>
+#include <QtAlgorithms>
+
+// System includes
+#include <algorithm>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+CandidateFilter::CandidateFilter()
+{
+    CALL_IN("");
+
+    Reset(5);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+CandidateFilter::~CandidateFilter()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Guesses
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start over with a given word length
+void CandidateFilter::Reset(const int mcWordLength)
+{
+    CALL_IN(QString("mcWordLength=%1")
+        .arg(QString::number(mcWordLength)));
+
+    // Check if word length is valid
+    if (mcWordLength < 1 ||
+        mcWordLength > Feedback::MAXIMUM_WORD_LENGTH)
+    {
+        const QString reason = QObject::tr("Invalid word length %1.")
+            .arg(QString::number(mcWordLength));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_WordLength = mcWordLength;
+    m_Guesses.clear();
+    m_FeedbackCodes.clear();
+    m_MinimumLetterCount.fill(0, AllWords::NUMBER_OF_LETTERS);
+    m_MaximumLetterCount.fill(0xf, AllWords::NUMBER_OF_LETTERS);
+
+    // Everything goes (Refresh() will pick up the actual words)
+    m_SlabSize = -1;
+    Refresh();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word length
+int CandidateFilter::GetWordLength() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_WordLength;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add a guess and the feedback it got
+bool CandidateFilter::AddGuess(const QString mcGuess,
+    const quint32 mcFeedbackCode)
+{
+    CALL_IN(QString("mcGuess=\"%1\", mcFeedbackCode=%2")
+        .arg(mcGuess,
+             QString::number(mcFeedbackCode)));
+
+    // Check guess
+    QByteArray letters;
+    if (!AllWords::EncodeWord(mcGuess, letters) ||
+        letters.size() != m_WordLength)
+    {
+        const QString reason =
+            QObject::tr("\"%1\" is not a valid guess for length %2.")
+                .arg(mcGuess,
+                     QString::number(m_WordLength));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    const bool success = AddGuess(
+        reinterpret_cast < const quint8 * >(letters.constData()),
+        mcFeedbackCode);
+
+    CALL_OUT("");
+    return success;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add a guess (letter codes of the filter's word length) and its feedback
+bool CandidateFilter::AddGuess(const quint8 * mcpGuess,
+    const quint32 mcFeedbackCode)
+{
+    CALL_IN(QString("mcpGuess=%1, mcFeedbackCode=%2")
+        .arg(mcpGuess ? "..." : "nullptr",
+             QString::number(mcFeedbackCode)));
+
+    // Check feedback
+    if (mcFeedbackCode >= Feedback::GetNumberOfCodes(m_WordLength))
+    {
+        const QString reason = QObject::tr("Invalid feedback code %1.")
+            .arg(QString::number(mcFeedbackCode));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Make sure we are up to date before narrowing down further
+    Refresh();
+
+    // Remember guess and apply it
+    m_Guesses.append(reinterpret_cast < const char * >(mcpGuess),
+        m_WordLength);
+    m_FeedbackCodes << mcFeedbackCode;
+    ApplyGuess(m_FeedbackCodes.size() - 1);
+    ApplyLetterCountLimits();
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of guesses so far
+int CandidateFilter::GetNumberOfGuesses() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_FeedbackCodes.size();
+}
+
+
+
+// ================================================================= Candidates
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words still consistent with all feedback
+int CandidateFilter::GetNumberOfCandidates()
+{
+    CALL_IN("");
+
+    Refresh();
+
+    CALL_OUT("");
+    return m_Candidates.GetCount();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// IDs of words still consistent with all feedback
+QList < quint32 > CandidateFilter::GetCandidates()
+{
+    CALL_IN("");
+
+    Refresh();
+
+    // Collect IDs of all set bits
+    QList < quint32 > candidates;
+    candidates.reserve(m_Candidates.GetCount());
+    const quint32 * word_ids =
+        AllWords::Instance() -> GetSlabIDs(m_WordLength);
+    const quint64 * words = m_Candidates.GetWords();
+    for (int word_index = 0;
+         word_index < m_Candidates.GetNumberOfWords();
+         word_index++)
+    {
+        quint64 word = words[word_index];
+        while (word)
+        {
+            const int slab_index =
+                64 * word_index + qCountTrailingZeroBits(word);
+            candidates << word_ids[slab_index];
+            word &= word - 1;
+        }
+    }
+
+    CALL_OUT("");
+    return candidates;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words still consistent with all feedback
+const BitVector & CandidateFilter::GetCandidateBits()
+{
+    CALL_IN("");
+
+    Refresh();
+
+    CALL_OUT("");
+    return m_Candidates;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if a given word is still consistent with all feedback
+bool CandidateFilter::IsCandidate(const quint32 mcWordID)
+{
+    CALL_IN(QString("mcWordID=%1")
+        .arg(QString::number(mcWordID)));
+
+    // Must have the right length
+    AllWords * aw = AllWords::Instance();
+    if (aw -> GetWordLength(mcWordID) != m_WordLength)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    Refresh();
+
+    // Find index in slab
+    const int slab_size = aw -> GetSlabSize(m_WordLength);
+    const quint32 * word_ids = aw -> GetSlabIDs(m_WordLength);
+    const quint32 * end = word_ids + slab_size;
+    const quint32 * found = std::lower_bound(word_ids, end, mcWordID);
+
+    CALL_OUT("");
+    return found != end &&
+        *found == mcWordID &&
+        m_Candidates.Test(found - word_ids);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Re-evaluate all guesses if the dictionary has changed
+void CandidateFilter::Refresh()
+{
+    CALL_IN("");
+
+    // Check if anything changed
+    const int slab_size = AllWords::Instance() -> GetSlabSize(m_WordLength);
+    if (slab_size == m_SlabSize)
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Start with all words of the right length and narrow down again
+    m_SlabSize = slab_size;
+    m_Candidates.Resize(slab_size);
+    m_Candidates.Fill(true);
+    for (int guess_index = 0;
+         guess_index < m_FeedbackCodes.size();
+         guess_index++)
+    {
+        ApplyGuess(guess_index);
+    }
+    ApplyLetterCountLimits();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Narrow down candidates using one guess
+void CandidateFilter::ApplyGuess(const int mcGuessIndex)
+{
+    CALL_IN(QString("mcGuessIndex=%1")
+        .arg(QString::number(mcGuessIndex)));
+
+    // Nothing to narrow down without words
+    if (m_SlabSize == 0)
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Guess and feedback
+    const quint8 * guess = reinterpret_cast < const quint8 * >(
+        m_Guesses.constData()) + mcGuessIndex * m_WordLength;
+    quint8 status[Feedback::MAXIMUM_WORD_LENGTH];
+    Feedback::Decode(m_FeedbackCodes[mcGuessIndex], m_WordLength, status);
+
+    // Feedback tells us, for every letter in the guess:
+    // - at positions marked correct the answer has that letter, at all other
+    //   positions of the guess it does not
+    // - the answer has at least as many of a letter as there are positions
+    //   with that letter marked correct or wrong position; if any position
+    //   with the letter was marked "not in word", it has exactly that many.
+    // Together, this is exactly the set of answers that would have produced
+    // the same feedback, including repeated letters in guess and answer.
+    QList < int > confirmed(AllWords::NUMBER_OF_LETTERS, 0);
+    QList < bool > rejected(AllWords::NUMBER_OF_LETTERS, false);
+    for (int position = 0;
+         position < m_WordLength;
+         position++)
+    {
+        if (status[position] == Feedback::Status_NotInWord)
+        {
+            rejected[guess[position]] = true;
+        } else
+        {
+            confirmed[guess[position]]++;
+        }
+    }
+    for (int position = 0;
+         position < m_WordLength;
+         position++)
+    {
+        const int letter = guess[position];
+        m_MinimumLetterCount[letter] =
+            qMax(m_MinimumLetterCount[letter], confirmed[letter]);
+        if (rejected[letter])
+        {
+            m_MaximumLetterCount[letter] =
+                qMin(m_MaximumLetterCount[letter], confirmed[letter]);
+        }
+    }
+
+    // Collect all bit vectors to combine, together with a mask to flip them
+    // (for "and not")
+    AllWords * aw = AllWords::Instance();
+    QList < const quint64 * > operands;
+    QList < quint64 > flip;
+    for (int position = 0;
+         position < m_WordLength;
+         position++)
+    {
+        operands << aw -> GetPositionLetterBits(m_WordLength, position,
+            guess[position]).GetWords();
+        flip << (status[position] == Feedback::Status_CorrectPosition ?
+            quint64(0) : ~quint64(0));
+    }
+    for (int position = 0;
+         position < m_WordLength;
+         position++)
+    {
+        // Each letter only once
+        const int letter = guess[position];
+        bool seen_before = false;
+        for (int previous = 0;
+             previous < position;
+             previous++)
+        {
+            seen_before = seen_before || (guess[previous] == letter);
+        }
+        if (seen_before)
+        {
+            continue;
+        }
+
+        // Minimum and maximum counts the index can handle directly
+        for (int count = 1;
+             count <= AllWords::MAXIMUM_INDEXED_LETTER_COUNT;
+             count++)
+        {
+            if (m_MinimumLetterCount[letter] >= count)
+            {
+                operands << aw -> GetLetterCountBits(m_WordLength, letter,
+                    count).GetWords();
+                flip << quint64(0);
+            }
+            if (m_MaximumLetterCount[letter] == count - 1)
+            {
+                operands << aw -> GetLetterCountBits(m_WordLength, letter,
+                    count).GetWords();
+                flip << ~quint64(0);
+            }
+        }
+    }
+
+    // Combine everything in a single pass over the candidates. Working on
+    // blocks of eight 64 bit words keeps the accumulator in registers and
+    // lets the compiler use vector instructions for the inner loop.
+    const int block_size = 8;
+    const int num_words = m_Candidates.GetNumberOfWords();
+    const int num_operands = operands.size();
+    quint64 * candidates = m_Candidates.GetWords();
+    int word_index = 0;
+    for (;
+         word_index + block_size <= num_words;
+         word_index += block_size)
+    {
+        quint64 block[block_size];
+        for (int offset = 0;
+             offset < block_size;
+             offset++)
+        {
+            block[offset] = candidates[word_index + offset];
+        }
+        for (int operand = 0;
+             operand < num_operands;
+             operand++)
+        {
+            const quint64 * bits = operands[operand] + word_index;
+            const quint64 mask = flip[operand];
+            for (int offset = 0;
+                 offset < block_size;
+                 offset++)
+            {
+                block[offset] &= bits[offset] ^ mask;
+            }
+        }
+        for (int offset = 0;
+             offset < block_size;
+             offset++)
+        {
+            candidates[word_index + offset] = block[offset];
+        }
+    }
+    for (;
+         word_index < num_words;
+         word_index++)
+    {
+        // Remaining words (flipping may set bits beyond the size, but the
+        // candidates never have those set in the first place)
+        quint64 word = candidates[word_index];
+        for (int operand = 0;
+             operand < num_operands;
+             operand++)
+        {
+            word &= operands[operand][word_index] ^ flip[operand];
+        }
+        candidates[word_index] = word;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check letter counts that are not covered by the letter index
+void CandidateFilter::ApplyLetterCountLimits()
+{
+    CALL_IN("");
+
+    // Letters with limits the index cannot express
+    QList < int > letters;
+    for (int letter = 0;
+         letter < AllWords::NUMBER_OF_LETTERS;
+         letter++)
+    {
+        if (m_MinimumLetterCount[letter] >
+                AllWords::MAXIMUM_INDEXED_LETTER_COUNT ||
+            (m_MaximumLetterCount[letter] >=
+                AllWords::MAXIMUM_INDEXED_LETTER_COUNT &&
+             m_MaximumLetterCount[letter] < 0xf))
+        {
+            letters << letter;
+        }
+    }
+
+    // Check remaining candidates one by one (rare: needs a letter three or
+    // more times in a guess)
+    if (!letters.isEmpty())
+    {
+        const quint64 * packed_counts =
+            AllWords::Instance() -> GetSlabLetterCounts(m_WordLength);
+        quint64 * words = m_Candidates.GetWords();
+        for (int word_index = 0;
+             word_index < m_Candidates.GetNumberOfWords();
+             word_index++)
+        {
+            quint64 remaining = words[word_index];
+            while (remaining)
+            {
+                const int bit = qCountTrailingZeroBits(remaining);
+                const int slab_index = 64 * word_index + bit;
+                remaining &= remaining - 1;
+                for (const int letter : letters)
+                {
+                    const int count =
+                        (packed_counts[2 * slab_index + letter / 16]
+                            >> (4 * (letter % 16))) & 0xf;
+                    if (count < m_MinimumLetterCount[letter] ||
+                        count > m_MaximumLetterCount[letter])
+                    {
+                        words[word_index] &= ~(quint64(1) << bit);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Index for counting and picking
+    m_Candidates.UpdateIndex();
+
+    CALL_OUT("");
+}
@@ -0,0 +1,88 @@
+// CandidateFilter.h
+// Class definition
+
+#ifndef CANDIDATEFILTER_H
+#define CANDIDATEFILTER_H
+
+// Project includes
+#include "BitVector.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+
+
+// Class definition
+class CandidateFilter
+{
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    CandidateFilter();
+
+    // Destructor
+    ~CandidateFilter();
+
+
+
+    // ================================================================ Guesses
+public:
+    // Start over with a given word length
+    void Reset(const int mcWordLength);
+    int GetWordLength() const;
+
+    // Add a guess and the feedback it got (see Feedback for the code).
+    // Returns false if the guess is not a word of the right length.
+    bool AddGuess(const QString mcGuess, const quint32 mcFeedbackCode);
+    bool AddGuess(const quint8 * mcpGuess, const quint32 mcFeedbackCode);
+
+    // Number of guesses so far
+    int GetNumberOfGuesses() const;
+
+private:
+    // Word length
+    int m_WordLength;
+
+    // Letter codes of all guesses (back to back) and their feedback
+    QByteArray m_Guesses;
+    QList < quint32 > m_FeedbackCodes;
+
+    // Letter count limits implied by all guesses so far
+    QList < int > m_MinimumLetterCount;
+    QList < int > m_MaximumLetterCount;
+
+
+
+    // ============================================================= Candidates
+public:
+    // Number of words still consistent with all feedback
+    int GetNumberOfCandidates();
+
+    // IDs of words still consistent with all feedback
+    QList < quint32 > GetCandidates();
+
+    // Words still consistent with all feedback (bit vector over the indices
+    // in the slab for the word length, with rank/select index)
+    const BitVector & GetCandidateBits();
+
+    // Check if a given word is still consistent with all feedback
+    bool IsCandidate(const quint32 mcWordID);
+
+private:
+    // Re-evaluate all guesses if the dictionary has changed
+    void Refresh();
+
+    // Narrow down candidates using one guess
+    void ApplyGuess(const int mcGuessIndex);
+
+    // Check letter counts that are not covered by the letter index
+    void ApplyLetterCountLimits();
+
+    // Candidates and the slab size they were determined for
+    BitVector m_Candidates;
+    int m_SlabSize;
+};
+
+#endif
@@ -0,0 +1,375 @@
+// Feedback.cpp
+// Class definition
+
+// Project includes
+#include "Feedback.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+
+// System includes (SSE2 is part of every x86-64 CPU)
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FEEDBACK_SSE2
+#include <emmintrin.h>
+#endif
+
+// Fixed length loops in the SIMD code are meant to be unrolled (which GCC
+// and Clang only do on their own at higher optimization levels)
+#if defined(__GNUC__)
+#define FEEDBACK_UNROLL _Pragma("GCC unroll 20")
+#else
+#define FEEDBACK_UNROLL
+#endif
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+Feedback::Feedback()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ===================================================================== Access
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest word a feedback code can describe
+const int Feedback::MAXIMUM_WORD_LENGTH;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Pack status of all letters into a code
+quint32 Feedback::Encode(const quint8 * mcpStatus, const int mcLength)
+{
+    CALL_IN(QString("mcpStatus=%1, mcLength=%2")
+        .arg(mcpStatus ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    // Horner scheme, starting with the most significant digit (last letter)
+    quint32 code = 0;
+    for (int index = mcLength - 1;
+         index >= 0;
+         index--)
+    {
+        code = 3 * code + mcpStatus[index];
+    }
+
+    CALL_OUT("");
+    return code;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Unpack status of all letters from a code
+void Feedback::Decode(const quint32 mcCode, const int mcLength,
+    quint8 * mpStatus)
+{
+    CALL_IN(QString("mcCode=%1, mcLength=%2, mpStatus=%3")
+        .arg(QString::number(mcCode),
+             QString::number(mcLength),
+             mpStatus ? "..." : "nullptr"));
+
+    quint32 code = mcCode;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        mpStatus[index] = code % 3;
+        code /= 3;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Code for a correct guess
+quint32 Feedback::GetSolvedCode(const int mcLength)
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    // All digits are 2, i.e. 3^length - 1
+    CALL_OUT("");
+    return GetNumberOfCodes(mcLength) - 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of different codes for a given word length
+quint32 Feedback::GetNumberOfCodes(const int mcLength)
+{
+    CALL_IN(QString("mcLength=%1")
+        .arg(QString::number(mcLength)));
+
+    quint32 number = 1;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        number *= 3;
+    }
+
+    CALL_OUT("");
+    return number;
+}
+
+
+
+// ============================================================== Batch scoring
+
+
+
+#ifdef FEEDBACK_SSE2
+///////////////////////////////////////////////////////////////////////////////
+// Feedback codes for blocks of 16 answers with SSE2 (word length Length, or
+// mcLength if Length is 0); returns the number of answers done
+template < int Length >
+static int ScoreBatchSse2(const quint8 * mcpGuess, const quint8 * mcpAnswers,
+    const int mcNumberOfAnswers, const int mcLength, quint32 * mpCodes)
+{
+    // One lane per answer. A letter of the guess that is not in the correct
+    // position is in the wrong position if the answer has more unmatched
+    // copies of it than there are unmatched copies of it further left in
+    // the guess (which use them up first). Same result as Score(), without
+    // going through the letters one by one.
+    const int length = (Length > 0 ? Length : mcLength);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i twos = _mm_set1_epi8(2);
+    // (Arrays are initialized only to keep compilers from warning about the
+    // entries beyond the length)
+    __m128i guess[Feedback::MAXIMUM_WORD_LENGTH] = {};
+    FEEDBACK_UNROLL
+    for (int position = 0;
+         position < length;
+         position++)
+    {
+        guess[position] = _mm_set1_epi8(char(mcpGuess[position]));
+    }
+    alignas(16) quint8 columns[Feedback::MAXIMUM_WORD_LENGTH][16];
+    __m128i letters[Feedback::MAXIMUM_WORD_LENGTH] = {};
+    __m128i correct[Feedback::MAXIMUM_WORD_LENGTH] = {};
+    __m128i status[Feedback::MAXIMUM_WORD_LENGTH] = {};
+    int answer = 0;
+    for (;
+         answer + 16 <= mcNumberOfAnswers;
+         answer += 16)
+    {
+        // Transpose: one vector per position
+        const quint8 * answers = mcpAnswers + qsizetype(answer) * length;
+        for (int lane = 0;
+             lane < 16;
+             lane++)
+        {
+            FEEDBACK_UNROLL
+            for (int position = 0;
+                 position < length;
+                 position++)
+            {
+                columns[position][lane] = answers[lane * length + position];
+            }
+        }
+        FEEDBACK_UNROLL
+        for (int position = 0;
+             position < length;
+             position++)
+        {
+            letters[position] = _mm_load_si128(
+                reinterpret_cast < const __m128i * >(columns[position]));
+            correct[position] =
+                _mm_cmpeq_epi8(letters[position], guess[position]);
+        }
+
+        // Status of every letter (comparisons give -1 for true, so counts
+        // are subtracted)
+        FEEDBACK_UNROLL
+        for (int position = 0;
+             position < length;
+             position++)
+        {
+            __m128i available = zero;
+            FEEDBACK_UNROLL
+            for (int other = 0;
+                 other < length;
+                 other++)
+            {
+                available = _mm_sub_epi8(available, _mm_andnot_si128(
+                    correct[other],
+                    _mm_cmpeq_epi8(letters[other], guess[position])));
+            }
+            __m128i used = zero;
+            FEEDBACK_UNROLL
+            for (int other = 0;
+                 other < position;
+                 other++)
+            {
+                if (mcpGuess[other] == mcpGuess[position])
+                {
+                    used = _mm_add_epi8(used,
+                        _mm_andnot_si128(correct[other], ones));
+                }
+            }
+            const __m128i present = _mm_andnot_si128(correct[position],
+                _mm_cmpgt_epi8(available, used));
+            status[position] = _mm_or_si128(
+                _mm_and_si128(correct[position], twos),
+                _mm_and_si128(present, ones));
+        }
+
+        // Codes: Horner scheme in 32 bit lanes (times 3 is a shift and an
+        // add, as SSE2 cannot multiply 32 bit numbers)
+        __m128i codes[4] = { zero, zero, zero, zero };
+        FEEDBACK_UNROLL
+        for (int position = length - 1;
+             position >= 0;
+             position--)
+        {
+            const __m128i low = _mm_unpacklo_epi8(status[position], zero);
+            const __m128i high = _mm_unpackhi_epi8(status[position], zero);
+            const __m128i digits[4] = {
+                _mm_unpacklo_epi16(low, zero),
+                _mm_unpackhi_epi16(low, zero),
+                _mm_unpacklo_epi16(high, zero),
+                _mm_unpackhi_epi16(high, zero) };
+            for (int part = 0;
+                 part < 4;
+                 part++)
+            {
+                codes[part] = _mm_add_epi32(_mm_add_epi32(
+                    _mm_slli_epi32(codes[part], 1), codes[part]),
+                    digits[part]);
+            }
+        }
+        for (int part = 0;
+             part < 4;
+             part++)
+        {
+            _mm_storeu_si128(
+                reinterpret_cast < __m128i * >(mpCodes + answer + 4 * part),
+                codes[part]);
+        }
+    }
+    return answer;
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Feedback codes for one guess against many answers
+void Feedback::ScoreBatch(const quint8 * mcpGuess, const quint8 * mcpAnswers,
+    const int mcNumberOfAnswers, const int mcLength, quint32 * mpCodes)
+{
+#ifdef FEEDBACK_SSE2
+    ScoreBatchSimd(mcpGuess, mcpAnswers, mcNumberOfAnswers, mcLength,
+        mpCodes);
+#else
+    ScoreBatchScalar(mcpGuess, mcpAnswers, mcNumberOfAnswers, mcLength,
+        mpCodes);
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Feedback codes for one guess against many answers, one at a time
+void Feedback::ScoreBatchScalar(const quint8 * mcpGuess,
+    const quint8 * mcpAnswers, const int mcNumberOfAnswers,
+    const int mcLength, quint32 * mpCodes)
+{
+    for (int answer = 0;
+         answer < mcNumberOfAnswers;
+         answer++)
+    {
+        mpCodes[answer] = Score(mcpGuess,
+            mcpAnswers + qsizetype(answer) * mcLength, mcLength);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Feedback codes for one guess against many answers, 16 at a time
+void Feedback::ScoreBatchSimd(const quint8 * mcpGuess,
+    const quint8 * mcpAnswers, const int mcNumberOfAnswers,
+    const int mcLength, quint32 * mpCodes)
+{
+    // Common word lengths get loops the compiler can unroll
+    int num_done = 0;
+#ifdef FEEDBACK_SSE2
+    switch (mcLength)
+    {
+    case 4:
+        num_done = ScoreBatchSse2 < 4 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+
+    case 5:
+        num_done = ScoreBatchSse2 < 5 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+
+    case 6:
+        num_done = ScoreBatchSse2 < 6 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+
+    case 7:
+        num_done = ScoreBatchSse2 < 7 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+
+    case 8:
+        num_done = ScoreBatchSse2 < 8 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+
+    default:
+        num_done = ScoreBatchSse2 < 0 >(mcpGuess, mcpAnswers,
+            mcNumberOfAnswers, mcLength, mpCodes);
+        break;
+    }
+#endif
+
+    // The rest (or all of them without SIMD)
+    ScoreBatchScalar(mcpGuess, mcpAnswers + qsizetype(num_done) * mcLength,
+        mcNumberOfAnswers - num_done, mcLength, mpCodes + num_done);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if ScoreBatchSimd() uses SIMD instructions in this build
+bool Feedback::HasSimd()
+{
+    CALL_IN("");
+
+#ifdef FEEDBACK_SSE2
+    const bool has_simd = true;
+#else
+    const bool has_simd = false;
+#endif
+
+    CALL_OUT("");
+    return has_simd;
+}
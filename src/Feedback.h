@@ -0,0 +1,107 @@
+// Feedback.h
+// Class definition
+
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+// Qt includes
+#include <QtGlobal>
+
+
+
+// Class definition
+class Feedback
+{
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    Feedback();
+
+
+
+    // ================================================================= Access
+public:
+    // Status of a single letter in a guess
+    enum Status {
+        Status_NotInWord = 0,
+        Status_WrongPosition = 1,
+        Status_CorrectPosition = 2
+    };
+
+    // Longest word a feedback code can describe (3^20 still fits in 32 bits)
+    static const int MAXIMUM_WORD_LENGTH = 20;
+
+    // Feedback for a whole guess is packed into a single base-3 number: the
+    // status of the first letter is the least significant digit.
+    static quint32 Encode(const quint8 * mcpStatus, const int mcLength);
+    static void Decode(const quint32 mcCode, const int mcLength,
+        quint8 * mpStatus);
+
+    // Code for a correct guess (all letters in the correct position)
+    static quint32 GetSolvedCode(const int mcLength);
+
+    // Number of different codes for a given word length (3^length)
+    static quint32 GetNumberOfCodes(const int mcLength);
+
+    // Feedback code for a guess given the answer (letter codes 0 to 25).
+    // Letters in the correct position are matched first; remaining letters
+    // of the guess are marked as being in the wrong position from left to
+    // right as long as the answer has unmatched copies of that letter left.
+    // This is the innermost loop of solvers and simulations, so it is
+    // inline, not traced and has no data dependent branches.
+    static inline quint32 Score(const quint8 * mcpGuess,
+        const quint8 * mcpAnswer, const int mcLength)
+    {
+        // Unmatched letters of the answer
+        quint8 unmatched[26] = { 0 };
+        quint8 status[MAXIMUM_WORD_LENGTH];
+        for (int index = 0;
+             index < mcLength;
+             index++)
+        {
+            const quint8 correct = (mcpGuess[index] == mcpAnswer[index]);
+            status[index] = 2 * correct;
+            unmatched[mcpAnswer[index]] += 1 - correct;
+        }
+
+        // Wrong position, and build the code
+        quint32 code = 0;
+        quint32 digit = 1;
+        for (int index = 0;
+             index < mcLength;
+             index++)
+        {
+            const quint8 letter = mcpGuess[index];
+            const quint8 present =
+                (status[index] == 0) & (unmatched[letter] > 0);
+            unmatched[letter] -= present;
+            code += digit * (status[index] + present);
+            digit *= 3;
+        }
+        return code;
+    }
+
+
+
+    // ========================================================== Batch scoring
+public:
+    // Feedback codes for one guess against many answers, given as letter
+    // codes back to back (i.e. with a stride of mcLength, like the slabs of
+    // AllWords): mpCodes[n] is Score() for answer n. The SIMD variant scores
+    // 16 answers at a time where the CPU has SSE2 and is the scalar variant
+    // elsewhere; ScoreBatch() uses the faster one. Not traced either.
+    static void ScoreBatch(const quint8 * mcpGuess,
+        const quint8 * mcpAnswers, const int mcNumberOfAnswers,
+        const int mcLength, quint32 * mpCodes);
+    static void ScoreBatchScalar(const quint8 * mcpGuess,
+        const quint8 * mcpAnswers, const int mcNumberOfAnswers,
+        const int mcLength, quint32 * mpCodes);
+    static void ScoreBatchSimd(const quint8 * mcpGuess,
+        const quint8 * mcpAnswers, const int mcNumberOfAnswers,
+        const int mcLength, quint32 * mpCodes);
+
+    // Check if ScoreBatchSimd() uses SIMD instructions in this build
+    static bool HasSimd();
+};
+
+#endif
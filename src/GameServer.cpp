@@ -0,0 +1,298 @@
+// GameServer.cpp
+// Class definition
+
+// Project includes
+#include "GameServer.h"
+#include "MessageLogger.h"
+#include "ServerConnection.h"
+#include "ServerProtocol.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QDebug>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QTcpSocket>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+GameServer::GameServer()
+{
+    CALL_IN("");
+
+    // Connections
+    m_NextConnectionID = 1;
+    connect(&m_TcpServer, SIGNAL(newConnection()),
+        this, SLOT(NewTcpConnection()));
+    connect(&m_LocalServer, SIGNAL(newConnection()),
+        this, SLOT(NewLocalConnection()));
+
+    // Nothing happened yet
+    m_NumberOfConnections = 0;
+    m_NumberOfOpenConnections = 0;
+    m_NumberOfGames = 0;
+    m_NumberOfGuesses = 0;
+    m_Clock.start();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+GameServer::~GameServer()
+{
+    CALL_IN("");
+
+    // Connections (children of this object) release their sessions, so
+    // they go before the session pool
+    m_TcpServer.close();
+    m_LocalServer.close();
+    const QList < ServerConnection * > connections =
+        findChildren < ServerConnection * >();
+    qDeleteAll(connections);
+
+    CALL_OUT("");
+}
+
+
+
+// ================================================================== Listening
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Listen on a TCP port
+bool GameServer::ListenTcp(const QString & mcrAddress, const quint16 mcPort)
+{
+    CALL_IN(QString("mcrAddress=\"%1\", mcPort=%2")
+        .arg(mcrAddress,
+             QString::number(mcPort)));
+
+    // Address
+    QHostAddress address;
+    if (!address.setAddress(mcrAddress))
+    {
+        const QString reason = tr("Invalid address \"%1\".")
+            .arg(mcrAddress);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Listen
+    if (!m_TcpServer.listen(address, mcPort))
+    {
+        const QString reason = tr("Cannot listen on %1 port %2: %3")
+            .arg(mcrAddress,
+                 QString::number(mcPort),
+                 m_TcpServer.errorString());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TCP port listened on
+quint16 GameServer::GetTcpPort() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_TcpServer.serverPort();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Listen on a local socket
+bool GameServer::ListenLocal(const QString & mcrName)
+{
+    CALL_IN(QString("mcrName=\"%1\"")
+        .arg(mcrName));
+
+    // A socket file left by a server that crashed would block the name
+    QLocalServer::removeServer(mcrName);
+    if (!m_LocalServer.listen(mcrName))
+    {
+        const QString reason = tr("Cannot listen on local socket \"%1\": %2")
+            .arg(mcrName,
+                 m_LocalServer.errorString());
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// New TCP connections
+void GameServer::NewTcpConnection()
+{
+    CALL_IN("");
+
+    while (m_TcpServer.hasPendingConnections())
+    {
+        QTcpSocket * socket = m_TcpServer.nextPendingConnection();
+        ServerProtocol::SetUpSocket(socket);
+        AddConnection(socket);
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// New local connections
+void GameServer::NewLocalConnection()
+{
+    CALL_IN("");
+
+    while (m_LocalServer.hasPendingConnections())
+    {
+        AddConnection(m_LocalServer.nextPendingConnection());
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Handle a new connection
+void GameServer::AddConnection(QIODevice * mpSocket)
+{
+    CALL_IN("mpSocket=...");
+
+    // The connection deletes itself (and the socket) when it closes
+    new ServerConnection(this, mpSocket, m_NextConnectionID);
+    m_NextConnectionID++;
+    if (m_NextConnectionID == 0)
+    {
+        m_NextConnectionID = 1;
+    }
+    m_NumberOfConnections++;
+    m_NumberOfOpenConnections++;
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Sessions
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sessions of all connections
+SessionPool & GameServer::GetSessionPool()
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_SessionPool;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most sessions at the same time
+void GameServer::SetMaximumNumberOfSessions(
+    const int mcMaximumNumberOfSessions)
+{
+    CALL_IN(QString("mcMaximumNumberOfSessions=%1")
+        .arg(QString::number(mcMaximumNumberOfSessions)));
+
+    // Check value
+    if (mcMaximumNumberOfSessions < 1 ||
+        mcMaximumNumberOfSessions > SessionPool::MAXIMUM_NUMBER_OF_SESSIONS)
+    {
+        const QString reason = tr("Invalid number of sessions %1.")
+            .arg(QString::number(mcMaximumNumberOfSessions));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_SessionPool.SetMaximumNumberOfSessions(mcMaximumNumberOfSessions);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most sessions at the same time
+int GameServer::GetMaximumNumberOfSessions() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_SessionPool.GetMaximumNumberOfSessions();
+}
+
+
+
+// ================================================================= Statistics
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Connections, games and guesses so far
+QString GameServer::GetReport() const
+{
+    CALL_IN("");
+
+    const double seconds = m_Clock.elapsed() / 1000.0;
+    const QString report =
+        tr("%1 s: %2 connections (%3 open), %4 games (%5/s), %6 guesses "
+            "(%7/s); %8 sessions in use, %9 allocated")
+        .arg(QString::number(seconds, 'f', 1),
+             QString::number(m_NumberOfConnections),
+             QString::number(m_NumberOfOpenConnections),
+             QString::number(m_NumberOfGames),
+             QString::number(m_NumberOfGames / qMax(seconds, 0.001), 'f', 1),
+             QString::number(m_NumberOfGuesses),
+             QString::number(m_NumberOfGuesses / qMax(seconds, 0.001),
+                'f', 1),
+             QString::number(m_SessionPool.GetNumberOfSessions()),
+             QString::number(m_SessionPool.GetNumberOfSlots()));
+
+    CALL_OUT("");
+    return report;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Print the report
+void GameServer::PrintReport() const
+{
+    CALL_IN("");
+
+    qDebug().noquote() << GetReport();
+
+    CALL_OUT("");
+}
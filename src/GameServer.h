@@ -0,0 +1,137 @@
+// GameServer.h
+// Class definition
+
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+// Project includes
+#include "SessionPool.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+
+
+
+// Class definition
+class GameServer
+    : public QObject
+{
+    // Headless server hosting many games for clients (e.g. kiosks) on TCP
+    // and/or a local socket (a Unix domain socket or named pipe), so they
+    // can leave validating and scoring guesses to one box. Clients talk
+    // ServerProtocol; every connection is handled by a ServerConnection.
+    //
+    // Everything runs in the thread's event loop (one thread, no locks):
+    // sockets are read when they have data, and all complete messages
+    // received are answered with one write. The dictionary (AllWords) is
+    // shared by all games and only read; sessions come from a SessionPool.
+
+    Q_OBJECT
+
+
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    GameServer();
+
+    // Destructor
+    virtual ~GameServer();
+
+
+
+    // ============================================================== Listening
+public:
+    // Listen on a TCP port (0 for any free one) of an address
+    bool ListenTcp(const QString & mcrAddress, const quint16 mcPort);
+    quint16 GetTcpPort() const;
+
+    // Listen on a local socket
+    bool ListenLocal(const QString & mcrName);
+
+private slots:
+    // New connections
+    void NewTcpConnection();
+    void NewLocalConnection();
+
+private:
+    // Handle a new connection
+    void AddConnection(QIODevice * mpSocket);
+
+    // Servers
+    QTcpServer m_TcpServer;
+    QLocalServer m_LocalServer;
+
+    // ID of the next connection (owner of its sessions; never 0)
+    quint32 m_NextConnectionID;
+
+
+
+    // =============================================================== Sessions
+public:
+    // Sessions of all connections
+    SessionPool & GetSessionPool();
+
+    // Most sessions at the same time (clients get an error beyond that)
+    void SetMaximumNumberOfSessions(const int mcMaximumNumberOfSessions);
+    int GetMaximumNumberOfSessions() const;
+
+private:
+    // Sessions
+    SessionPool m_SessionPool;
+
+
+
+    // ============================================================= Statistics
+public:
+    // Count events (called by connections)
+    inline void ConnectionClosed()
+    {
+        CALL_IN("");
+
+        m_NumberOfOpenConnections--;
+
+        CALL_OUT("");
+    }
+    inline void GameStarted()
+    {
+        CALL_IN("");
+
+        m_NumberOfGames++;
+
+        CALL_OUT("");
+    }
+    inline void GuessHandled()
+    {
+        CALL_IN("");
+
+        m_NumberOfGuesses++;
+
+        CALL_OUT("");
+    }
+
+    // Connections, games and guesses so far
+    QString GetReport() const;
+
+public slots:
+    // Print the report
+    void PrintReport() const;
+
+private:
+    // Counts
+    quint64 m_NumberOfConnections;
+    int m_NumberOfOpenConnections;
+    quint64 m_NumberOfGames;
+    quint64 m_NumberOfGuesses;
+
+    // Time since construction
+    QElapsedTimer m_Clock;
+};
+
+#endif
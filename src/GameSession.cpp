@@ -0,0 +1,838 @@
+// GameSession.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "AsyncMessageLogger.h"
+#include "GameSession.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QObject>
+#include <QString>
+
+// System includes
+#include <cstring>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+GameSession::GameSession()
+{
+    CALL_IN("");
+
+    m_AvoidDuplicateLetters = false;
+    m_MaximumNumberOfTries = MAXIMUM_NUMBER_OF_TRIES;
+    Clear();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+GameSession::~GameSession()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ======================================================================= Game
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest word, most tries and most boards a game can have
+const int GameSession::MAXIMUM_WORD_LENGTH;
+const int GameSession::MAXIMUM_NUMBER_OF_TRIES;
+const int GameSession::MAXIMUM_NUMBER_OF_BOARDS;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a game with one board and an answer given as letter codes
+bool GameSession::Start(const quint8 * mcpAnswer, const int mcLength)
+{
+    CALL_IN(QString("mcpAnswer=%1, mcLength=%2")
+        .arg(mcpAnswer ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    CALL_OUT("");
+    return Start(mcpAnswer, mcLength, 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a game with one board and an answer given as a word ID
+bool GameSession::Start(const quint32 mcAnswerID)
+{
+    CALL_IN(QString("mcAnswerID=%1")
+        .arg(QString::number(mcAnswerID)));
+
+    CALL_OUT("");
+    return Start(&mcAnswerID, 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a game with answers given as letter codes
+bool GameSession::Start(const quint8 * mcpAnswers, const int mcLength,
+    const int mcNumberOfBoards)
+{
+    CALL_IN(QString("mcpAnswers=%1, mcLength=%2, mcNumberOfBoards=%3")
+        .arg(mcpAnswers ? "..." : "nullptr",
+             QString::number(mcLength),
+             QString::number(mcNumberOfBoards)));
+
+    // No game unless the answers are fine
+    Clear();
+
+    // Check parameters
+    if (!mcpAnswers)
+    {
+        const QString reason = QObject::tr("No answers given.");
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    if (mcLength < 1 ||
+        mcLength > MAXIMUM_WORD_LENGTH)
+    {
+        const QString reason = QObject::tr("Invalid word length %1.")
+            .arg(QString::number(mcLength));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    if (mcNumberOfBoards < 1 ||
+        mcNumberOfBoards > MAXIMUM_NUMBER_OF_BOARDS)
+    {
+        const QString reason = QObject::tr("Invalid number of boards %1.")
+            .arg(QString::number(mcNumberOfBoards));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    for (int index = 0;
+         index < mcLength * mcNumberOfBoards;
+         index++)
+    {
+        if (mcpAnswers[index] >= 26)
+        {
+            const QString reason = QObject::tr("Invalid letter code %1.")
+                .arg(QString::number(mcpAnswers[index]));
+            AsyncMessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
+        }
+    }
+
+    memcpy(m_Answers, mcpAnswers, mcLength * mcNumberOfBoards);
+    m_WordLength = mcLength;
+    m_NumberOfBoards = mcNumberOfBoards;
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a game with answers given as word IDs
+bool GameSession::Start(const quint32 * mcpAnswerIDs,
+    const int mcNumberOfBoards)
+{
+    CALL_IN(QString("mcpAnswerIDs=%1, mcNumberOfBoards=%2")
+        .arg(mcpAnswerIDs ? "..." : "nullptr",
+             QString::number(mcNumberOfBoards)));
+
+    // Check parameters
+    if (!mcpAnswerIDs ||
+        mcNumberOfBoards < 1 ||
+        mcNumberOfBoards > MAXIMUM_NUMBER_OF_BOARDS)
+    {
+        Clear();
+        const QString reason =
+            QObject::tr("Invalid answers (%1 boards).")
+                .arg(QString::number(mcNumberOfBoards));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Letters of all answers (all of the same length)
+    AllWords * aw = AllWords::Instance();
+    quint8 answers[MAXIMUM_NUMBER_OF_BOARDS * MAXIMUM_WORD_LENGTH];
+    int length = 0;
+    for (int board = 0;
+         board < mcNumberOfBoards;
+         board++)
+    {
+        const quint32 answer_id = mcpAnswerIDs[board];
+        if (answer_id == AllWords::INVALID_ID ||
+            int(answer_id) >= aw -> GetNumberOfWords())
+        {
+            Clear();
+            const QString reason = QObject::tr("Invalid word ID %1.")
+                .arg(QString::number(answer_id));
+            AsyncMessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
+        }
+        const int answer_length = aw -> GetWordLength(answer_id);
+        if (board > 0 &&
+            answer_length != length)
+        {
+            Clear();
+            const QString reason =
+                QObject::tr("Answers of different lengths (%1 and %2).")
+                    .arg(QString::number(length),
+                         QString::number(answer_length));
+            AsyncMessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
+        }
+        if (answer_length > MAXIMUM_WORD_LENGTH)
+        {
+            Clear();
+            const QString reason = QObject::tr("Answer is too long (%1).")
+                .arg(QString::number(answer_length));
+            AsyncMessageLogger::Error(CALL_METHOD,
+                reason);
+            CALL_OUT(reason);
+            return false;
+        }
+        length = answer_length;
+        memcpy(answers + board * length, aw -> GetPackedLetters(answer_id),
+            length);
+    }
+
+    CALL_OUT("");
+    return Start(answers, length, mcNumberOfBoards);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Forget the game
+void GameSession::Clear()
+{
+    CALL_IN("");
+
+    // No answers, no tries, nothing known
+    m_WordLength = 0;
+    m_NumberOfBoards = 0;
+    m_NumberOfSolvedBoards = 0;
+    m_CurrentLength = 0;
+    m_CurrentTryIsDeadEnd = false;
+    m_NumberOfTries = 0;
+    memset(m_SolvedTry, -1, sizeof(m_SolvedTry));
+    memset(m_BoardLetterStatus, Status_NotTried, sizeof(m_BoardLetterStatus));
+    memset(m_LetterStatus, Status_NotTried, sizeof(m_LetterStatus));
+    m_ChangedLetters = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of tries before the game is lost
+void GameSession::SetMaximumNumberOfTries(const int mcMaximumNumberOfTries)
+{
+    CALL_IN(QString("mcMaximumNumberOfTries=%1")
+        .arg(QString::number(mcMaximumNumberOfTries)));
+
+    // Check value
+    if (mcMaximumNumberOfTries < 1 ||
+        mcMaximumNumberOfTries > MAXIMUM_NUMBER_OF_TRIES)
+    {
+        const QString reason = QObject::tr("Invalid number of tries %1.")
+            .arg(QString::number(mcMaximumNumberOfTries));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_MaximumNumberOfTries = mcMaximumNumberOfTries;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of tries before the game is lost
+int GameSession::GetMaximumNumberOfTries() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_MaximumNumberOfTries;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Tries with a letter more than once are refused
+void GameSession::SetAvoidDuplicateLetters(const bool mcNewState)
+{
+    CALL_IN(QString("mcNewState=%1")
+        .arg(mcNewState ? "true" : "false"));
+
+    m_AvoidDuplicateLetters = mcNewState;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Tries with a letter more than once are refused
+bool GameSession::GetAvoidDuplicateLetters() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_AvoidDuplicateLetters;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word length
+int GameSession::GetWordLength() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_WordLength;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Boards
+int GameSession::GetNumberOfBoards() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfBoards;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Answer of a board
+const quint8 * GameSession::GetAnswer(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    if (mcBoard < 0 ||
+        mcBoard >= m_NumberOfBoards)
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_Answers + mcBoard * m_WordLength;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Game is over
+bool GameSession::IsFinished() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_WordLength == 0 ||
+        IsSolved() ||
+        m_NumberOfTries >= m_MaximumNumberOfTries;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Game was won
+bool GameSession::IsSolved() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfBoards > 0 &&
+        m_NumberOfSolvedBoards == m_NumberOfBoards;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Board was solved
+bool GameSession::IsBoardSolved(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    if (mcBoard < 0 ||
+        mcBoard >= m_NumberOfBoards)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    CALL_OUT("");
+    return m_SolvedTry[mcBoard] >= 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of boards solved so far
+int GameSession::GetNumberOfSolvedBoards() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfSolvedBoards;
+}
+
+
+
+// ===================================================================== Typing
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Type a letter into the current try
+bool GameSession::AddLetter(const int mcLetter)
+{
+    CALL_IN(QString("mcLetter=%1")
+        .arg(QString::number(mcLetter)));
+
+    if (IsFinished() ||
+        mcLetter < 0 ||
+        mcLetter >= 26 ||
+        m_CurrentLength == m_WordLength)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    m_TryLetters[m_NumberOfTries][m_CurrentLength++] = quint8(mcLetter);
+    UpdateDeadEnd();
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Remove the last letter of the current try
+bool GameSession::RemoveLetter()
+{
+    CALL_IN("");
+
+    if (IsFinished() ||
+        m_CurrentLength == 0)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    m_CurrentLength--;
+    UpdateDeadEnd();
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Submit the current try
+GameSession::SubmitResult GameSession::Submit()
+{
+    CALL_IN("");
+
+    // Need a complete try
+    if (IsFinished())
+    {
+        CALL_OUT("");
+        return Submit_Finished;
+    }
+    if (m_CurrentLength < m_WordLength)
+    {
+        CALL_OUT("");
+        return Submit_Incomplete;
+    }
+
+    // Rules
+    const quint8 * letters = m_TryLetters[m_NumberOfTries];
+    if (m_AvoidDuplicateLetters)
+    {
+        const quint32 mask =
+            AllWords::CalculateLetterMask(letters, m_WordLength);
+        if (qPopulationCount(mask) < m_WordLength)
+        {
+            CALL_OUT("");
+            return Submit_DuplicateLetters;
+        }
+    }
+    AllWords * aw = AllWords::Instance();
+    if (aw -> GetWordIDForLetters(letters, m_WordLength) ==
+        AllWords::INVALID_ID)
+    {
+        CALL_OUT("");
+        return Submit_UnknownWord;
+    }
+
+    // Feedback on all boards at once (solved ones, too; that is cheaper
+    // than leaving them out)
+    quint32 * codes = m_TryCodes[m_NumberOfTries];
+    Feedback::ScoreBatch(letters, m_Answers, m_NumberOfBoards, m_WordLength,
+        codes);
+
+    // Status on the boards still in play
+    const quint32 solved_code = Feedback::GetSolvedCode(m_WordLength);
+    const quint32 guess_letters =
+        AllWords::CalculateLetterMask(letters, m_WordLength);
+    bool board_solved = false;
+    quint8 status[MAXIMUM_WORD_LENGTH];
+    for (int board = 0;
+         board < m_NumberOfBoards;
+         board++)
+    {
+        if (m_SolvedTry[board] >= 0)
+        {
+            continue;
+        }
+        Feedback::Decode(codes[board], m_WordLength, status);
+        quint8 * board_status = m_BoardLetterStatus[board];
+        for (int index = 0;
+             index < m_WordLength;
+             index++)
+        {
+            const quint8 letter_status = Status_NotInWord + status[index];
+            quint8 & known_status = board_status[letters[index]];
+            if (letter_status > known_status)
+            {
+                known_status = letter_status;
+            }
+        }
+        if (codes[board] == solved_code)
+        {
+            m_SolvedTry[board] = m_NumberOfTries;
+            m_NumberOfSolvedBoards++;
+            board_solved = true;
+        }
+    }
+
+    // Status on all boards: only the letters of the guess changed, unless
+    // a board is out of play now
+    UpdateLetterStatus(board_solved ? 0x3ffffff : guess_letters);
+
+    // Next try
+    m_NumberOfTries++;
+    m_CurrentLength = 0;
+    m_CurrentTryIsDeadEnd = false;
+    if (IsSolved())
+    {
+        CALL_OUT("");
+        return Submit_Solved;
+    }
+    if (m_NumberOfTries >= m_MaximumNumberOfTries)
+    {
+        CALL_OUT("");
+        return Submit_OutOfTries;
+    }
+
+    CALL_OUT("");
+    return Submit_Accepted;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Submit a whole word
+GameSession::SubmitResult GameSession::Submit(const quint8 * mcpLetters)
+{
+    CALL_IN(QString("mcpLetters=%1")
+        .arg(mcpLetters ? "..." : "nullptr"));
+
+    if (IsFinished())
+    {
+        CALL_OUT("");
+        return Submit_Finished;
+    }
+
+    // Not checked for a dead end; that is only shown while typing
+    for (int index = 0;
+         index < m_WordLength;
+         index++)
+    {
+        if (mcpLetters[index] >= 26)
+        {
+            CALL_OUT("");
+            return Submit_UnknownWord;
+        }
+    }
+    memcpy(m_TryLetters[m_NumberOfTries], mcpLetters, m_WordLength);
+    m_CurrentLength = m_WordLength;
+    m_CurrentTryIsDeadEnd = false;
+
+    CALL_OUT("");
+    return Submit();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Current try
+const quint8 * GameSession::GetCurrentLetters() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_TryLetters[qMin(m_NumberOfTries, MAXIMUM_NUMBER_OF_TRIES - 1)];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of letters in the current try
+int GameSession::GetCurrentLength() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return IsFinished() ? 0 : m_CurrentLength;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// No word starts like the current try
+bool GameSession::IsCurrentTryDeadEnd() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_CurrentTryIsDeadEnd;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if the current try can still become a word
+void GameSession::UpdateDeadEnd()
+{
+    CALL_IN("");
+
+    AllWords * aw = AllWords::Instance();
+    m_CurrentTryIsDeadEnd = !aw -> IsValidPrefixForLetters(
+        m_TryLetters[m_NumberOfTries], m_CurrentLength, m_WordLength);
+
+    CALL_OUT("");
+}
+
+
+
+// ====================================================================== Tries
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of finished tries
+int GameSession::GetNumberOfTries() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfTries;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of finished tries of a board
+int GameSession::GetNumberOfTries(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    if (mcBoard < 0 ||
+        mcBoard >= m_NumberOfBoards)
+    {
+        CALL_OUT("");
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_SolvedTry[mcBoard] >= 0 ?
+        m_SolvedTry[mcBoard] + 1 : m_NumberOfTries;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letters of a finished try
+const quint8 * GameSession::GetTryLetters(const int mcTry) const
+{
+    CALL_IN(QString("mcTry=%1")
+        .arg(QString::number(mcTry)));
+
+    if (mcTry < 0 ||
+        mcTry >= m_NumberOfTries)
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return m_TryLetters[mcTry];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Feedback code of a finished try on a board
+quint32 GameSession::GetTryCode(const int mcBoard, const int mcTry) const
+{
+    CALL_IN(QString("mcBoard=%1, mcTry=%2")
+        .arg(QString::number(mcBoard),
+             QString::number(mcTry)));
+
+    if (mcTry < 0 ||
+        mcTry >= GetNumberOfTries(mcBoard))
+    {
+        CALL_OUT("");
+        return 0;
+    }
+
+    CALL_OUT("");
+    return m_TryCodes[mcTry][mcBoard];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Best status of a letter so far on a board
+GameSession::Status GameSession::GetLetterStatus(const int mcBoard,
+    const int mcLetter) const
+{
+    CALL_IN(QString("mcBoard=%1, mcLetter=%2")
+        .arg(QString::number(mcBoard),
+             QString::number(mcLetter)));
+
+    if (mcBoard < 0 ||
+        mcBoard >= m_NumberOfBoards ||
+        mcLetter < 0 ||
+        mcLetter >= 26)
+    {
+        CALL_OUT("");
+        return Status_NotTried;
+    }
+
+    CALL_OUT("");
+    return Status(m_BoardLetterStatus[mcBoard][mcLetter]);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Best status of a letter so far on all boards
+GameSession::Status GameSession::GetLetterStatus(const int mcLetter) const
+{
+    CALL_IN(QString("mcLetter=%1")
+        .arg(QString::number(mcLetter)));
+
+    if (mcLetter < 0 ||
+        mcLetter >= 26)
+    {
+        CALL_OUT("");
+        return Status_NotTried;
+    }
+
+    CALL_OUT("");
+    return Status(m_LetterStatus[mcLetter]);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letters whose status on all boards changed with the last try
+quint32 GameSession::GetChangedLetters() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_ChangedLetters;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Status on all boards of some letters
+void GameSession::UpdateLetterStatus(const quint32 mcLetters)
+{
+    CALL_IN(QString("mcLetters=%1")
+        .arg(QString::number(mcLetters)));
+
+    // Boards still in play count (all of them once none is)
+    const bool all_boards = (m_NumberOfSolvedBoards == m_NumberOfBoards);
+    m_ChangedLetters = 0;
+    for (int letter = 0;
+         letter < 26;
+         letter++)
+    {
+        if (!(mcLetters & (1u << letter)))
+        {
+            continue;
+        }
+        quint8 best_status = Status_NotTried;
+        for (int board = 0;
+             board < m_NumberOfBoards;
+             board++)
+        {
+            if (all_boards ||
+                m_SolvedTry[board] < 0)
+            {
+                best_status =
+                    qMax(best_status, m_BoardLetterStatus[board][letter]);
+            }
+        }
+        if (best_status != m_LetterStatus[letter])
+        {
+            m_LetterStatus[letter] = best_status;
+            m_ChangedLetters |= (1u << letter);
+        }
+    }
+
+    CALL_OUT("");
+}
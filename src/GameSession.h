@@ -0,0 +1,195 @@
+// GameSession.h
+// Class definition
+
+#ifndef GAMESESSION_H
+#define GAMESESSION_H
+
+// Project includes
+#include "Feedback.h"
+
+// Qt includes
+#include <QtGlobal>
+
+
+
+// Class definition
+class GameSession
+{
+    // One game: the answers, the finished tries with their feedback codes,
+    // the try being typed and the best status known for every letter. A
+    // game has one board or several (each with its own answer; every try
+    // goes to all boards not solved yet, and the game is won once all of
+    // them are). All state is in fixed-size arrays, so a session is a
+    // single block of memory, and starting a game, typing and submitting
+    // tries never allocate any. Feedback for all boards is computed with
+    // one Feedback::ScoreBatch() call. It does not depend on a GUI; the
+    // window, simulations and servers all drive games through this class.
+    // The dictionary (AllWords) is only read; adding unknown words is up to
+    // the caller.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor (no game yet)
+    GameSession();
+
+    // Destructor
+    ~GameSession();
+
+
+
+    // =================================================================== Game
+public:
+    // Longest word, most tries and most boards a game can have
+    static const int MAXIMUM_WORD_LENGTH = Feedback::MAXIMUM_WORD_LENGTH;
+    static const int MAXIMUM_NUMBER_OF_TRIES = 64;
+    static const int MAXIMUM_NUMBER_OF_BOARDS = 16;
+
+    // Start a game with one board and an answer given as letter codes (0
+    // for "a" to 25 for "z") or as a word ID. Returns false (and leaves no
+    // game; the reason is logged) if the answer is invalid.
+    bool Start(const quint8 * mcpAnswer, const int mcLength);
+    bool Start(const quint32 mcAnswerID);
+
+    // Same with several boards; answers are given as letter codes back to
+    // back, or as word IDs (all of the same length)
+    bool Start(const quint8 * mcpAnswers, const int mcLength,
+        const int mcNumberOfBoards);
+    bool Start(const quint32 * mcpAnswerIDs, const int mcNumberOfBoards);
+
+    // Forget the game (no game afterwards)
+    void Clear();
+
+    // Number of tries before the game is lost (for the next game; 1 to
+    // MAXIMUM_NUMBER_OF_TRIES)
+    void SetMaximumNumberOfTries(const int mcMaximumNumberOfTries);
+    int GetMaximumNumberOfTries() const;
+
+    // Tries with a letter more than once are refused
+    void SetAvoidDuplicateLetters(const bool mcNewState);
+    bool GetAvoidDuplicateLetters() const;
+
+    // Word length (0 if there is no game)
+    int GetWordLength() const;
+
+    // Boards
+    int GetNumberOfBoards() const;
+
+    // Answer of a board
+    const quint8 * GetAnswer(const int mcBoard) const;
+
+    // Game is over: all boards solved, out of tries, or no game at all
+    bool IsFinished() const;
+    bool IsSolved() const;
+
+    // Boards solved so far
+    bool IsBoardSolved(const int mcBoard) const;
+    int GetNumberOfSolvedBoards() const;
+
+private:
+    // Answers, back to back
+    quint8 m_Answers[MAXIMUM_NUMBER_OF_BOARDS * MAXIMUM_WORD_LENGTH];
+    int m_WordLength;
+    int m_NumberOfBoards;
+
+    // Try that solved a board (-1 while it is not solved)
+    int m_SolvedTry[MAXIMUM_NUMBER_OF_BOARDS];
+    int m_NumberOfSolvedBoards;
+
+    // Rules
+    bool m_AvoidDuplicateLetters;
+    int m_MaximumNumberOfTries;
+
+
+
+    // ================================================================= Typing
+public:
+    // Type a letter (0 for "a" to 25 for "z") into the current try / remove
+    // its last letter. Return false if nothing changed.
+    bool AddLetter(const int mcLetter);
+    bool RemoveLetter();
+
+    // Result of submitting a try
+    enum SubmitResult {
+        Submit_Accepted = 0,
+        Submit_Solved,
+        Submit_OutOfTries,
+        Submit_Incomplete,
+        Submit_DuplicateLetters,
+        Submit_UnknownWord,
+        Submit_Finished
+    };
+
+    // Submit the current try. Only the first three results finish the try;
+    // for the others, nothing changes.
+    SubmitResult Submit();
+
+    // Replace the current try with a whole word and submit it (for players
+    // that are not typing)
+    SubmitResult Submit(const quint8 * mcpLetters);
+
+    // Current try (GetCurrentLength() letters)
+    const quint8 * GetCurrentLetters() const;
+    int GetCurrentLength() const;
+
+    // No word starts like the current try
+    bool IsCurrentTryDeadEnd() const;
+
+private:
+    // Check if the current try can still become a word
+    void UpdateDeadEnd();
+
+    // Current try; its letters go where the next finished try goes
+    int m_CurrentLength;
+    bool m_CurrentTryIsDeadEnd;
+
+
+
+    // ================================================================== Tries
+public:
+    // Status of a letter; the ones after Status_NotTried are in the same
+    // order as Feedback::Status, and the order is also how much we know
+    enum Status {
+        Status_NotTried = 0,
+        Status_NotInWord,
+        Status_WrongPosition,
+        Status_CorrectPosition
+    };
+
+    // Number of finished tries, of the whole game and of a board (up to
+    // and including the one that solved it)
+    int GetNumberOfTries() const;
+    int GetNumberOfTries(const int mcBoard) const;
+
+    // Letters of a finished try, and its feedback code (see Feedback) on a
+    // board
+    const quint8 * GetTryLetters(const int mcTry) const;
+    quint32 GetTryCode(const int mcBoard, const int mcTry) const;
+
+    // Best status of a letter (0 for "a" to 25 for "z") so far on a board,
+    // and on all boards not solved yet (on all boards once the game is won)
+    Status GetLetterStatus(const int mcBoard, const int mcLetter) const;
+    Status GetLetterStatus(const int mcLetter) const;
+
+    // Letters whose status on all boards changed with the last try (bit n
+    // for letter n)
+    quint32 GetChangedLetters() const;
+
+private:
+    // Status on all boards of some letters
+    void UpdateLetterStatus(const quint32 mcLetters);
+
+    // Finished tries, then the current one
+    quint8 m_TryLetters[MAXIMUM_NUMBER_OF_TRIES][MAXIMUM_WORD_LENGTH];
+    int m_NumberOfTries;
+
+    // Feedback codes of every try on every board
+    quint32 m_TryCodes[MAXIMUM_NUMBER_OF_TRIES][MAXIMUM_NUMBER_OF_BOARDS];
+
+    // Best status of every letter (a Status) on every board, and on all
+    // boards
+    quint8 m_BoardLetterStatus[MAXIMUM_NUMBER_OF_BOARDS][26];
+    quint8 m_LetterStatus[26];
+    quint32 m_ChangedLetters;
+};
+
+#endif
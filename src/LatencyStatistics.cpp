@@ -0,0 +1,109 @@
+// LatencyStatistics.cpp
+// Class definition
+
+// Project includes
+#include "LatencyStatistics.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QtMath>
+
+// System includes
+#include <algorithm>
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Width of the name and of the other columns
+static const int NAME_WIDTH = 16;
+static const int COLUMN_WIDTH = 12;
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+LatencyStatistics::LatencyStatistics()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Reports
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Column titles
+QString LatencyStatistics::GetHeader()
+{
+    CALL_IN("");
+
+    const QString header = QString("%1%2%3%4%5%6")
+        .arg(QString("").leftJustified(NAME_WIDTH, ' '),
+             QString("mean [us]").rightJustified(COLUMN_WIDTH, ' '),
+             QString("p50 [us]").rightJustified(COLUMN_WIDTH, ' '),
+             QString("p90 [us]").rightJustified(COLUMN_WIDTH, ' '),
+             QString("p99 [us]").rightJustified(COLUMN_WIDTH, ' '),
+             QString("max [us]").rightJustified(COLUMN_WIDTH, ' '));
+
+    CALL_OUT("");
+    return header;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Statistics of some samples
+QString LatencyStatistics::GetLine(const QString & mcrName,
+    const QList < qint64 > & mcrSamples)
+{
+    CALL_IN(QString("mcrName=\"%1\", mcrSamples=...")
+        .arg(mcrName));
+
+    // Nothing to report
+    if (mcrSamples.isEmpty())
+    {
+        CALL_OUT("");
+        return QString("%1%2")
+            .arg(mcrName.leftJustified(NAME_WIDTH, ' '),
+                 QString("-").rightJustified(COLUMN_WIDTH, ' '));
+    }
+
+    // Percentiles by rank
+    QList < qint64 > sorted = mcrSamples;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (const qint64 sample : std::as_const(sorted))
+    {
+        total += sample;
+    }
+    auto percentile = [&sorted](const double mcFraction)
+    {
+        const int rank = qCeil(mcFraction * sorted.size());
+        return sorted[qBound(0, rank - 1, int(sorted.size()) - 1)];
+    };
+    auto microseconds = [](const double mcNanoseconds)
+    {
+        return QString::number(mcNanoseconds / 1000.0, 'f', 1)
+            .rightJustified(COLUMN_WIDTH, ' ');
+    };
+    const QString line = QString("%1%2%3%4%5%6")
+        .arg(mcrName.leftJustified(NAME_WIDTH, ' '),
+             microseconds(total / sorted.size()),
+             microseconds(percentile(0.5)),
+             microseconds(percentile(0.9)),
+             microseconds(percentile(0.99)),
+             microseconds(sorted.last()));
+
+    CALL_OUT("");
+    return line;
+}
@@ -0,0 +1,38 @@
+// LatencyStatistics.h
+// Class definition
+
+#ifndef LATENCYSTATISTICS_H
+#define LATENCYSTATISTICS_H
+
+// Qt includes
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+
+
+// Class definition
+class LatencyStatistics
+{
+    // Report lines for samples in nanoseconds (e.g. latencies or frame
+    // times): mean, 50th, 90th and 99th percentile and maximum, in
+    // microseconds, one column each after a name.
+
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    LatencyStatistics();
+
+
+
+    // ================================================================ Reports
+public:
+    // Column titles
+    static QString GetHeader();
+
+    // Statistics of some samples ("-" if there are none)
+    static QString GetLine(const QString & mcrName,
+        const QList < qint64 > & mcrSamples);
+};
+
+#endif
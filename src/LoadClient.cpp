@@ -0,0 +1,399 @@
+// LoadClient.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "GameSession.h"
+#include "LoadClient.h"
+#include "LoadGenerator.h"
+#include "ServerProtocol.h"
+#include "SessionPool.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QLocalSocket>
+#include <QString>
+#include <QTcpSocket>
+
+// System includes
+#include <cstring>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+LoadClient::LoadClient(LoadGenerator * mpGenerator,
+    const int mcNumberOfBoards, const quint64 mcSeed, const quint64 mcStream)
+    : QObject(mpGenerator)
+{
+    CALL_IN(QString("mpGenerator=%1, mcNumberOfBoards=%2, mcSeed=%3, "
+        "mcStream=%4")
+        .arg(mpGenerator ? "..." : "nullptr",
+             QString::number(mcNumberOfBoards),
+             QString::number(mcSeed),
+             QString::number(mcStream)));
+
+    m_Generator = mpGenerator;
+    m_Socket = nullptr;
+    m_NumberOfBoards = mcNumberOfBoards;
+    m_Seed = mcSeed;
+    m_Random.Seed(mcSeed, mcStream);
+    m_Stopping = false;
+    m_Finished = false;
+
+    // Buffers are allocated once
+    m_Input.resize(ServerProtocol::MAXIMUM_FRAME_SIZE * 4);
+    m_InputSize = 0;
+    m_Output.reserve(ServerProtocol::MAXIMUM_FRAME_SIZE);
+    m_SendTime = 0;
+
+    // No game yet
+    m_SessionID = SessionPool::INVALID_ID;
+    m_WordLength = 0;
+    m_GuessLetters = nullptr;
+    m_NumberOfGuessWords = 0;
+    m_NumberOfGuesses = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+LoadClient::~LoadClient()
+{
+    CALL_IN("");
+
+    // Nothing to do (the socket is a child).
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Connect to a server on TCP
+void LoadClient::ConnectTcp(const QString & mcrAddress, const quint16 mcPort)
+{
+    CALL_IN(QString("mcrAddress=\"%1\", mcPort=%2")
+        .arg(mcrAddress,
+             QString::number(mcPort)));
+
+    QTcpSocket * socket = new QTcpSocket(this);
+    m_Socket = socket;
+    connect(socket, SIGNAL(connected()),
+        this, SLOT(Connected()));
+    connect(socket, SIGNAL(disconnected()),
+        this, SLOT(Disconnected()));
+    connect(socket, SIGNAL(errorOccurred(QAbstractSocket::SocketError)),
+        this, SLOT(Disconnected()));
+    connect(socket, SIGNAL(readyRead()),
+        this, SLOT(ReadMessages()));
+    socket -> connectToHost(mcrAddress, mcPort);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Connect to a server on a local socket
+void LoadClient::ConnectLocal(const QString & mcrName)
+{
+    CALL_IN(QString("mcrName=\"%1\"")
+        .arg(mcrName));
+
+    QLocalSocket * socket = new QLocalSocket(this);
+    m_Socket = socket;
+    connect(socket, SIGNAL(connected()),
+        this, SLOT(Connected()));
+    connect(socket, SIGNAL(disconnected()),
+        this, SLOT(Disconnected()));
+    connect(socket, SIGNAL(errorOccurred(QLocalSocket::LocalSocketError)),
+        this, SLOT(Disconnected()));
+    connect(socket, SIGNAL(readyRead()),
+        this, SLOT(ReadMessages()));
+    socket -> connectToServer(mcrName);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Stop after the current game
+void LoadClient::Stop()
+{
+    CALL_IN("");
+
+    m_Stopping = true;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Connected
+void LoadClient::Connected()
+{
+    CALL_IN("");
+
+    if (m_Stopping)
+    {
+        Finish();
+        CALL_OUT("");
+        return;
+    }
+
+    ServerProtocol::SetUpSocket(m_Socket);
+    SendNewGame();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Disconnected, or the connection failed
+void LoadClient::Disconnected()
+{
+    CALL_IN("");
+
+    // Not after Finish(); then it was us
+    if (m_Finished)
+    {
+        CALL_OUT("");
+        return;
+    }
+    m_Generator -> ErrorReceived();
+    Finish();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Done
+void LoadClient::Finish()
+{
+    CALL_IN("");
+
+    if (m_Finished)
+    {
+        CALL_OUT("");
+        return;
+    }
+    m_Finished = true;
+    m_Socket -> close();
+    m_Generator -> ClientFinished();
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Messages
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Read answers
+void LoadClient::ReadMessages()
+{
+    CALL_IN("");
+
+    while (!m_Finished)
+    {
+        const qint64 num_read = m_Socket -> read(m_Input.data() + m_InputSize,
+            m_Input.size() - m_InputSize);
+        if (num_read <= 0)
+        {
+            CALL_OUT("");
+            return;
+        }
+        m_InputSize += int(num_read);
+
+        // Complete messages
+        int offset = 0;
+        while (true)
+        {
+            const int frame_size = ServerProtocol::GetFrameSize(
+                m_Input.constData() + offset, m_InputSize - offset);
+            if (frame_size == 0)
+            {
+                break;
+            }
+            if (frame_size < 0 ||
+                !HandleMessage(m_Input.constData() + offset, frame_size))
+            {
+                Finish();
+                CALL_OUT("");
+                return;
+            }
+            offset += frame_size;
+        }
+
+        // Keep the start of an incomplete message
+        if (offset > 0)
+        {
+            m_InputSize -= offset;
+            memmove(m_Input.data(), m_Input.constData() + offset,
+                size_t(m_InputSize));
+        }
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Handle an answer
+bool LoadClient::HandleMessage(const char * mcpFrame, const int mcSize)
+{
+    CALL_IN(QString("mcpFrame=%1, mcSize=%2")
+        .arg(mcpFrame ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    // Every message is answered before the next one is sent
+    m_Generator -> AddLatency(m_Generator -> GetTime() - m_SendTime);
+
+    const char * payload = mcpFrame + ServerProtocol::HEADER_SIZE;
+    const int payload_size = mcSize - ServerProtocol::HEADER_SIZE;
+    switch (ServerProtocol::ReadUInt8(mcpFrame + 2))
+    {
+    case ServerProtocol::Message_GameStarted:
+    {
+        if (payload_size != 7)
+        {
+            break;
+        }
+
+        // Guesses are random words of the answers' length
+        m_SessionID = ServerProtocol::ReadUInt32(payload);
+        m_WordLength = ServerProtocol::ReadUInt8(payload + 4);
+        const AllWords * aw = AllWords::Instance();
+        m_GuessLetters = aw -> GetSlabLetters(m_WordLength);
+        m_NumberOfGuessWords = aw -> GetSlabSize(m_WordLength);
+        m_NumberOfGuesses = 0;
+        if (m_NumberOfGuessWords == 0)
+        {
+            break;
+        }
+        SendGuess();
+        CALL_OUT("");
+        return true;
+    }
+
+    case ServerProtocol::Message_Feedback:
+    {
+        if (payload_size < 7)
+        {
+            break;
+        }
+
+        // Next guess until the game is over (or refused too often)
+        const int result = ServerProtocol::ReadUInt8(payload + 4);
+        m_NumberOfGuesses++;
+        if (result == GameSession::Submit_Solved ||
+            result == GameSession::Submit_OutOfTries ||
+            result == GameSession::Submit_Finished ||
+            m_NumberOfGuesses >= GameSession::MAXIMUM_NUMBER_OF_TRIES)
+        {
+            SendEndGame();
+        } else
+        {
+            SendGuess();
+        }
+        CALL_OUT("");
+        return true;
+    }
+
+    case ServerProtocol::Message_GameEnded:
+        m_Generator -> GameFinished();
+        m_SessionID = SessionPool::INVALID_ID;
+        if (m_Stopping)
+        {
+            CALL_OUT("");
+            return false;
+        }
+        SendNewGame();
+        CALL_OUT("");
+        return true;
+
+    default:
+        // Errors, and anything we did not ask for
+        break;
+    }
+
+    m_Generator -> ErrorReceived();
+
+    CALL_OUT("");
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a game (answers of a random game index)
+void LoadClient::SendNewGame()
+{
+    CALL_IN("");
+
+    ServerProtocol::WriteNewGame(m_Output, m_NumberOfBoards, 0, m_Seed,
+        m_Random.Next());
+    Send();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Guess a random word
+void LoadClient::SendGuess()
+{
+    CALL_IN("");
+
+    const quint32 index = m_Random.Bounded(quint32(m_NumberOfGuessWords));
+    ServerProtocol::WriteGuess(m_Output, m_SessionID,
+        m_GuessLetters + qsizetype(index) * m_WordLength, m_WordLength);
+    Send();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// End the game
+void LoadClient::SendEndGame()
+{
+    CALL_IN("");
+
+    ServerProtocol::WriteEndGame(m_Output, m_SessionID);
+    Send();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Send what was written into the output buffer
+void LoadClient::Send()
+{
+    CALL_IN("");
+
+    m_SendTime = m_Generator -> GetTime();
+    ServerProtocol::Send(m_Socket, m_Output);
+
+    CALL_OUT("");
+}
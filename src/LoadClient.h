@@ -0,0 +1,110 @@
+// LoadClient.h
+// Class definition
+
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+// Project includes
+#include "RandomStream.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QIODevice>
+#include <QObject>
+#include <QString>
+
+// Forward declarations
+class LoadGenerator;
+
+
+
+// Class definition
+class LoadClient
+    : public QObject
+{
+    // One client of a LoadGenerator: a connection to the server that plays
+    // one game after the other (NewGame, random guesses until the game is
+    // over, EndGame), always waiting for the answer before sending the
+    // next message, and reports every answer's latency to the generator.
+    // It stops after an error from the server or when the generator asks.
+
+    Q_OBJECT
+
+
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor (the generator is the parent)
+    LoadClient(LoadGenerator * mpGenerator, const int mcNumberOfBoards,
+        const quint64 mcSeed, const quint64 mcStream);
+
+    // Destructor
+    virtual ~LoadClient();
+
+    // Connect to a server on TCP, or on a local socket; playing starts
+    // once connected
+    void ConnectTcp(const QString & mcrAddress, const quint16 mcPort);
+    void ConnectLocal(const QString & mcrName);
+
+    // Stop after the current game
+    void Stop();
+
+private slots:
+    // Socket events
+    void Connected();
+    void Disconnected();
+
+private:
+    // Done (tells the generator once)
+    void Finish();
+
+    // Generator and socket
+    LoadGenerator * m_Generator;
+    QIODevice * m_Socket;
+
+    // Games (answers) and guesses
+    int m_NumberOfBoards;
+    quint64 m_Seed;
+    RandomStream m_Random;
+
+    // State
+    bool m_Stopping;
+    bool m_Finished;
+
+
+
+    // =============================================================== Messages
+private slots:
+    // Read answers
+    void ReadMessages();
+
+private:
+    // Handle an answer (a complete frame); returns false to stop
+    bool HandleMessage(const char * mcpFrame, const int mcSize);
+
+    // Send messages
+    void SendNewGame();
+    void SendGuess();
+    void SendEndGame();
+
+    // Send what was written into the output buffer
+    void Send();
+
+    // Received data not handled yet (the first m_InputSize bytes), and the
+    // message to send
+    QByteArray m_Input;
+    int m_InputSize;
+    QByteArray m_Output;
+
+    // Time the last message was sent (in nanoseconds; see LoadGenerator)
+    qint64 m_SendTime;
+
+    // Current game
+    quint32 m_SessionID;
+    int m_WordLength;
+    const quint8 * m_GuessLetters;
+    int m_NumberOfGuessWords;
+    int m_NumberOfGuesses;
+};
+
+#endif
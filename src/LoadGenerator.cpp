@@ -0,0 +1,379 @@
+// LoadGenerator.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "GameSession.h"
+#include "LatencyStatistics.h"
+#include "LoadClient.h"
+#include "LoadGenerator.h"
+#include "MessageLogger.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QStringList>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+LoadGenerator::LoadGenerator()
+{
+    CALL_IN("");
+
+    // Defaults
+    m_Address = "127.0.0.1";
+    m_Port = 0;
+    m_NumberOfConnections = 64;
+    m_Duration = 10;
+    m_NumberOfBoards = 1;
+    m_Seed = 1;
+
+    // Not running
+    m_NumberOfRunningClients = 0;
+    m_RunTime = 0;
+    m_StopTimer.setSingleShot(true);
+    connect(&m_StopTimer, SIGNAL(timeout()),
+        this, SLOT(Stop()));
+    m_NumberOfGames = 0;
+    m_NumberOfErrors = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+LoadGenerator::~LoadGenerator()
+{
+    CALL_IN("");
+
+    // Nothing to do (clients are children).
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Settings
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Server on TCP
+void LoadGenerator::SetTcpServer(const QString & mcrAddress,
+    const quint16 mcPort)
+{
+    CALL_IN(QString("mcrAddress=\"%1\", mcPort=%2")
+        .arg(mcrAddress,
+             QString::number(mcPort)));
+
+    m_Address = mcrAddress;
+    m_Port = mcPort;
+    m_LocalName.clear();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Server on a local socket
+void LoadGenerator::SetLocalServer(const QString & mcrName)
+{
+    CALL_IN(QString("mcrName=\"%1\"")
+        .arg(mcrName));
+
+    m_LocalName = mcrName;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of clients
+void LoadGenerator::SetNumberOfConnections(const int mcNumberOfConnections)
+{
+    CALL_IN(QString("mcNumberOfConnections=%1")
+        .arg(QString::number(mcNumberOfConnections)));
+
+    // Check value
+    if (mcNumberOfConnections < 1)
+    {
+        const QString reason = tr("Invalid number of connections %1.")
+            .arg(QString::number(mcNumberOfConnections));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfConnections = mcNumberOfConnections;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of clients
+int LoadGenerator::GetNumberOfConnections() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfConnections;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// How long to run
+void LoadGenerator::SetDuration(const int mcDuration)
+{
+    CALL_IN(QString("mcDuration=%1")
+        .arg(QString::number(mcDuration)));
+
+    // Check value
+    if (mcDuration < 1)
+    {
+        const QString reason = tr("Invalid duration %1.")
+            .arg(QString::number(mcDuration));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_Duration = mcDuration;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// How long to run
+int LoadGenerator::GetDuration() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Duration;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Boards per game
+void LoadGenerator::SetNumberOfBoards(const int mcNumberOfBoards)
+{
+    CALL_IN(QString("mcNumberOfBoards=%1")
+        .arg(QString::number(mcNumberOfBoards)));
+
+    // Check value
+    if (mcNumberOfBoards < 1 ||
+        mcNumberOfBoards > GameSession::MAXIMUM_NUMBER_OF_BOARDS)
+    {
+        const QString reason = tr("Invalid number of boards %1.")
+            .arg(QString::number(mcNumberOfBoards));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfBoards = mcNumberOfBoards;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Boards per game
+int LoadGenerator::GetNumberOfBoards() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfBoards;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed
+void LoadGenerator::SetSeed(const quint64 mcSeed)
+{
+    CALL_IN(QString("mcSeed=%1")
+        .arg(QString::number(mcSeed)));
+
+    m_Seed = mcSeed;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed
+quint64 LoadGenerator::GetSeed() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Seed;
+}
+
+
+
+// ======================================================================== Run
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Connect all clients and start playing
+bool LoadGenerator::Start()
+{
+    CALL_IN("");
+
+    // Need a server
+    if (m_LocalName.isEmpty() &&
+        m_Port == 0)
+    {
+        const QString reason = tr("No server to connect to.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Only once
+    if (!m_Clients.isEmpty())
+    {
+        const QString reason = tr("Already started.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+
+    // Guesses come from the dictionary; load it before timing anything
+    AllWords::Instance();
+
+    // Room for the latencies of a long run, so recording them does not
+    // allocate while measuring
+    m_Latencies.clear();
+    m_Latencies.reserve(1 << 22);
+    m_NumberOfGames = 0;
+    m_NumberOfErrors = 0;
+
+    // Clients (one random stream each)
+    m_Clock.start();
+    for (int index = 0;
+         index < m_NumberOfConnections;
+         index++)
+    {
+        LoadClient * client = new LoadClient(this, m_NumberOfBoards, m_Seed,
+            quint64(index));
+        m_Clients << client;
+        if (m_LocalName.isEmpty())
+        {
+            client -> ConnectTcp(m_Address, m_Port);
+        } else
+        {
+            client -> ConnectLocal(m_LocalName);
+        }
+    }
+    m_NumberOfRunningClients = m_NumberOfConnections;
+    m_StopTimer.start(m_Duration * 1000);
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A client is done
+void LoadGenerator::ClientFinished()
+{
+    CALL_IN("");
+
+    m_NumberOfRunningClients--;
+    if (m_NumberOfRunningClients == 0)
+    {
+        m_RunTime = GetTime();
+        m_StopTimer.stop();
+        emit Finished();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Time is up
+void LoadGenerator::Stop()
+{
+    CALL_IN("");
+
+    for (LoadClient * client : std::as_const(m_Clients))
+    {
+        client -> Stop();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Results
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Games per second and latency percentiles
+QString LoadGenerator::GetReport() const
+{
+    CALL_IN("");
+
+    // Run time (so far, if still running)
+    const qint64 run_time = m_NumberOfRunningClients > 0 ?
+        GetTime() : m_RunTime;
+    const double seconds = qMax(run_time / 1e9, 0.001);
+
+    // Counts
+    QStringList lines;
+    lines << tr("%1 connections, %2 boards per game, %3 s")
+        .arg(QString::number(m_NumberOfConnections),
+             QString::number(m_NumberOfBoards),
+             QString::number(seconds, 'f', 2));
+    lines << tr("%1 sessions (%2 sessions/s), %3 messages (%4 messages/s), "
+        "%5 errors")
+        .arg(QString::number(m_NumberOfGames),
+             QString::number(m_NumberOfGames / seconds, 'f', 1),
+             QString::number(m_Latencies.size()),
+             QString::number(m_Latencies.size() / seconds, 'f', 1),
+             QString::number(m_NumberOfErrors));
+
+    // Latency percentiles
+    if (m_Latencies.isEmpty())
+    {
+        CALL_OUT("");
+        return lines.join("\n");
+    }
+    lines << LatencyStatistics::GetHeader();
+    lines << LatencyStatistics::GetLine(tr("latency"), m_Latencies);
+
+    CALL_OUT("");
+    return lines.join("\n");
+}
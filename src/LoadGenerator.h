@@ -0,0 +1,163 @@
+// LoadGenerator.h
+// Class definition
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+// Project includes
+#include "Tracing.h"
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Forward declarations
+class LoadClient;
+
+
+
+// Class definition
+class LoadGenerator
+    : public QObject
+{
+    // Load for a GameServer: a number of clients (LoadClient, one
+    // connection each) play games as fast as the server answers, each with
+    // one message in flight, for a given time. Guesses are random words of
+    // the answers' length, so most games run out of tries. Reports the
+    // time from sending a message until its answer is complete (latency
+    // percentiles) and how many games (sessions) were played per second.
+    //
+    // Everything runs in the thread's event loop, like the server. Run
+    // several generators if one thread cannot keep the server busy.
+
+    Q_OBJECT
+
+
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    LoadGenerator();
+
+    // Destructor
+    virtual ~LoadGenerator();
+
+
+
+    // =============================================================== Settings
+public:
+    // Server on TCP, or on a local socket
+    void SetTcpServer(const QString & mcrAddress, const quint16 mcPort);
+    void SetLocalServer(const QString & mcrName);
+
+    // Number of clients (connections)
+    void SetNumberOfConnections(const int mcNumberOfConnections);
+    int GetNumberOfConnections() const;
+
+    // How long to run (in seconds); clients finish the game they are in
+    void SetDuration(const int mcDuration);
+    int GetDuration() const;
+
+    // Boards per game
+    void SetNumberOfBoards(const int mcNumberOfBoards);
+    int GetNumberOfBoards() const;
+
+    // Seed (of the games' answers, and of the guesses)
+    void SetSeed(const quint64 mcSeed);
+    quint64 GetSeed() const;
+
+private:
+    // Server
+    QString m_Address;
+    quint16 m_Port;
+    QString m_LocalName;
+
+    // Load
+    int m_NumberOfConnections;
+    int m_Duration;
+    int m_NumberOfBoards;
+    quint64 m_Seed;
+
+
+
+    // ==================================================================== Run
+public:
+    // Connect all clients and start playing; Finished() is emitted when
+    // all clients are done
+    bool Start();
+
+    // Time since Start() (in nanoseconds)
+    inline qint64 GetTime() const
+    {
+        CALL_IN("");
+
+        CALL_OUT("");
+        return m_Clock.nsecsElapsed();
+    }
+
+    // Record events (called by clients)
+    inline void AddLatency(const qint64 mcLatency)
+    {
+        CALL_IN(QString("mcLatency=%1")
+            .arg(QString::number(mcLatency)));
+
+        m_Latencies << mcLatency;
+
+        CALL_OUT("");
+    }
+    inline void GameFinished()
+    {
+        CALL_IN("");
+
+        m_NumberOfGames++;
+
+        CALL_OUT("");
+    }
+    inline void ErrorReceived()
+    {
+        CALL_IN("");
+
+        m_NumberOfErrors++;
+
+        CALL_OUT("");
+    }
+
+    // A client is done
+    void ClientFinished();
+
+signals:
+    // All clients are done
+    void Finished();
+
+private slots:
+    // Time is up
+    void Stop();
+
+private:
+    // Clients
+    QList < LoadClient * > m_Clients;
+    int m_NumberOfRunningClients;
+
+    // Timing
+    QElapsedTimer m_Clock;
+    QTimer m_StopTimer;
+    qint64 m_RunTime;
+
+
+
+    // ================================================================ Results
+public:
+    // Games per second and latency percentiles
+    QString GetReport() const;
+
+private:
+    // Latencies (in nanoseconds), games and errors
+    QList < qint64 > m_Latencies;
+    quint64 m_NumberOfGames;
+    quint64 m_NumberOfErrors;
+};
+
+#endif
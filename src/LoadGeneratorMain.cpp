@@ -0,0 +1,82 @@
+// LoadGeneratorMain.cpp
+// Plays games on a GuessWord server with many connections at once (see
+// LoadGenerator) and prints sessions per second and latency percentiles.
+//
+// Usage: GuessWordLoadGenerator [--address A] [--port N] [--local NAME]
+//     [--connections N] [--seconds N] [--boards N] [--seed N]
+
+// Project includes
+#include "LoadGenerator.h"
+
+// Qt includes
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStringList>
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    // Same name as the GUI, so the dictionary is the same as the server's
+    QCoreApplication app(mNumParameters, mpParameter);
+    QCoreApplication::setApplicationName("GuessWord");
+
+    // Command line
+    LoadGenerator generator;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Plays GuessWord games on a server and measures it.");
+    parser.addHelpOption();
+    const QCommandLineOption address_option("address",
+        "Server address for TCP.", "A", "127.0.0.1");
+    const QCommandLineOption port_option("port",
+        "Server TCP port.", "N", "0");
+    const QCommandLineOption local_option("local",
+        "Server local socket name (instead of TCP).", "name");
+    const QCommandLineOption connections_option("connections",
+        "Number of connections.", "N",
+        QString::number(generator.GetNumberOfConnections()));
+    const QCommandLineOption seconds_option("seconds",
+        "How long to run.", "N",
+        QString::number(generator.GetDuration()));
+    const QCommandLineOption boards_option("boards",
+        "Boards per game.", "N",
+        QString::number(generator.GetNumberOfBoards()));
+    const QCommandLineOption seed_option("seed",
+        "Seed for answers and guesses.", "N",
+        QString::number(generator.GetSeed()));
+    parser.addOptions({ address_option, port_option, local_option,
+        connections_option, seconds_option, boards_option, seed_option });
+    parser.process(app);
+
+    // Settings
+    if (parser.isSet(local_option))
+    {
+        generator.SetLocalServer(parser.value(local_option));
+    } else
+    {
+        generator.SetTcpServer(parser.value(address_option),
+            quint16(parser.value(port_option).toUInt()));
+    }
+    generator.SetNumberOfConnections(
+        parser.value(connections_option).toInt());
+    generator.SetDuration(parser.value(seconds_option).toInt());
+    generator.SetNumberOfBoards(parser.value(boards_option).toInt());
+    generator.SetSeed(parser.value(seed_option).toULongLong());
+
+    // Run until all clients are done
+    QObject::connect(&generator, SIGNAL(Finished()),
+        &app, SLOT(quit()));
+    if (!generator.Start())
+    {
+        return 1;
+    }
+    app.exec();
+    qDebug().noquote() << generator.GetReport();
+
+    // Done here
+    return 0;
+}
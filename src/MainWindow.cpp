@@ -4,11 +4,15 @@
 // Project includes
 #include "AllWords.h"
 #include "Application.h"
-#include "CallTracer.h"
+#include "CallProfiler.h"
+#include "Feedback.h"
 #include "MainWindow.h"
+#include "MessageLogger.h"
+#include "Tracing.h"
 
 // Qt includes
 #include <QAction>
+#include <QActionGroup>
 #include <QGridLayout>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -28,12 +32,18 @@ MainWindow::MainWindow()
     CALL_IN("");
 
     // Initialize
+    m_NumberOfBoards = 1;
     InitActions();
+    m_RenderScheduler.SetWidget(this);
 
-    m_StatusToColor[Status_NotTried] = QColor(255,255,255);
-    m_StatusToColor[Status_CorrectPosition] = QColor(180,255,180);
-    m_StatusToColor[Status_NotInWord] = QColor(255,180,180);
-    m_StatusToColor[Status_WrongPosition] = QColor(255,255,180);
+    // Tile colors by status; letters of a try that cannot become a word
+    // anymore are red
+    m_TileCache.SetColors(QList < QColor > {
+            QColor(255,255,255),
+            QColor(255,180,180),
+            QColor(255,255,180),
+            QColor(180,255,180) },
+        QColor(0,0,0), QColor(200,0,0));
 
     // Set width
     setMinimumSize(600, 400);
@@ -116,6 +126,47 @@ void MainWindow::InitActions()
         this, SLOT(NewGame()));
     file_menu -> addAction(action);
 
+    // Hint
+    action = new QAction(tr("Hint"), this);
+    action -> setShortcut(tr("Ctrl+H"));
+    connect(action, SIGNAL(triggered()),
+        this, SLOT(Hint()));
+    file_menu -> addAction(action);
+
+    // Boards: one word at a time, or several
+    QMenu * boards_menu = file_menu -> addMenu(tr("Boards"));
+    QActionGroup * boards_group = new QActionGroup(this);
+    for (const int num_boards : { 1, 4, 8, 16 })
+    {
+        action = new QAction(num_boards == 1 ? tr("1 Board") :
+            tr("%1 Boards").arg(QString::number(num_boards)), this);
+        action -> setCheckable(true);
+        action -> setChecked(num_boards == m_NumberOfBoards);
+        action -> setData(num_boards);
+        boards_group -> addAction(action);
+        boards_menu -> addAction(action);
+    }
+    connect(boards_group, SIGNAL(triggered(QAction *)),
+        this, SLOT(SelectNumberOfBoards(QAction *)));
+
+    // Profile (only profiling builds measure calls, see Tracing.h)
+#if GUESSWORD_TRACE_LEVEL == 1
+    action = new QAction(tr("Profile"), this);
+    action -> setShortcut(tr("Ctrl+Shift+P"));
+    action -> setCheckable(true);
+    action -> setChecked(CallProfiler::IsEnabled());
+    connect(action, SIGNAL(toggled(bool)),
+        this, SLOT(Profile(bool)));
+    file_menu -> addAction(action);
+#endif
+
+    // Frame statistics
+    action = new QAction(tr("Frame Statistics"), this);
+    action -> setShortcut(tr("Ctrl+Shift+F"));
+    connect(action, SIGNAL(triggered()),
+        this, SLOT(FrameStatistics()));
+    file_menu -> addAction(action);
+
     // Quit
     action = new QAction(tr("Quit Home"), this);
     action -> setShortcut(tr("Ctrl+Q"));
@@ -148,28 +199,90 @@ void MainWindow::NewGame()
 {
     CALL_IN("");
 
-    // Reset it all
-    m_Tries.clear();
-    m_Tries << QString();
-
-    m_LetterStatus.clear();
-    for (char letter = 'a';
-         letter <= 'z';
-         letter++)
+    // Reset it all (no game if there are not enough words). Words are only
+    // used up once the game has started.
+    AllWords * aw = AllWords::Instance();
+    quint32 word_ids[GameSession::MAXIMUM_NUMBER_OF_BOARDS];
+    const bool out_of_words = !aw -> PickWordIDs(word_ids, m_NumberOfBoards);
+    m_GameSession.SetAvoidDuplicateLetters(aw -> GetAvoidDuplicateLetters());
+    m_GameSession.SetMaximumNumberOfTries(m_NumberOfBoards == 1 ?
+        GameSession::MAXIMUM_NUMBER_OF_TRIES : m_NumberOfBoards + 5);
+    if (out_of_words)
+    {
+        m_GameSession.Clear();
+        QMessageBox::information(this, tr("Out of words"),
+            tr("I ran out of words!"));
+    } else if (!m_GameSession.Start(word_ids, m_NumberOfBoards))
     {
-        m_LetterStatus[QString(letter)] = Status_NotTried;
+        // Reason was logged
+        QMessageBox::warning(this, tr("New game"),
+            tr("Could not start a game."));
+    } else
+    {
+        for (int board = 0;
+             board < m_NumberOfBoards;
+             board++)
+        {
+            aw -> SetWordUsed(word_ids[board]);
+        }
     }
 
-    m_Word = AllWords::Instance() -> GetWord();
-    if (m_Word.isEmpty())
+    m_RenderScheduler.InvalidateAll();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Action handler: Hint
+void MainWindow::Hint()
+{
+    CALL_IN("");
+
+    // Need a game
+    if (m_GameSession.IsFinished())
     {
-        QMessageBox::information(this, tr("Out of words"),
-            tr("I ran out of words!"));
+        CALL_OUT("");
+        return;
     }
 
-    m_LastTryFinished = false;
+    // Words still possible on the first board not solved yet
+    int board = 0;
+    while (m_GameSession.IsBoardSolved(board))
+    {
+        board++;
+    }
+    m_CandidateFilter.Reset(m_GameSession.GetWordLength());
+    for (int this_try = 0;
+         this_try < m_GameSession.GetNumberOfTries(board);
+         this_try++)
+    {
+        m_CandidateFilter.AddGuess(m_GameSession.GetTryLetters(this_try),
+            m_GameSession.GetTryCode(board, this_try));
+    }
 
-    update();
+    // Best guesses given what we know
+    AllWords * aw = AllWords::Instance();
+    const QList < QPair < quint32, double > > best_guesses =
+        m_Solver.RankGuesses(m_CandidateFilter, 5);
+    QStringList lines;
+    for (const QPair < quint32, double > & guess : best_guesses)
+    {
+        lines << tr("%1 (%2 bits)")
+            .arg(aw -> GetWordText(guess.first).toUpper(),
+                 QString::number(guess.second, 'f', 2));
+    }
+    QString text = tr("%1 possible words left. Best guesses:\n%2")
+        .arg(QString::number(m_CandidateFilter.GetNumberOfCandidates()),
+             lines.join("\n"));
+    if (m_GameSession.GetNumberOfBoards() > 1)
+    {
+        text = tr("Board %1: %2")
+            .arg(QString::number(board + 1),
+                 text);
+    }
+    QMessageBox::information(this, tr("Hint"), text);
 
     CALL_OUT("");
 }
@@ -190,6 +303,69 @@ void MainWindow::Quit()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Start profiling, or stop and print the report
+void MainWindow::Profile(const bool mcEnabled)
+{
+    CALL_IN(QString("mcEnabled=%1")
+        .arg(mcEnabled ? "true" : "false"));
+
+    if (mcEnabled)
+    {
+        CallProfiler::Reset();
+        CallProfiler::SetEnabled(true);
+    } else
+    {
+        CallProfiler::SetEnabled(false);
+        CallProfiler::PrintReport();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Action handler: Frame Statistics (print them and start over)
+void MainWindow::FrameStatistics()
+{
+    CALL_IN("");
+
+    m_RenderScheduler.PrintReport();
+    m_RenderScheduler.ResetStatistics();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Action handler: Boards (starts a new game)
+void MainWindow::SelectNumberOfBoards(QAction * mpAction)
+{
+    CALL_IN("mpAction=...");
+
+    // Check action
+    const int num_boards = mpAction -> data().toInt();
+    if (num_boards < 1 ||
+        num_boards > GameSession::MAXIMUM_NUMBER_OF_BOARDS)
+    {
+        const QString reason = tr("Invalid number of boards %1.")
+            .arg(QString::number(num_boards));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfBoards = num_boards;
+    NewGame();
+
+    CALL_OUT("");
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Get key
 void MainWindow::keyPressEvent(QKeyEvent * mpEvent)
@@ -204,41 +380,86 @@ void MainWindow::keyPressEvent(QKeyEvent * mpEvent)
     }
 
     const int key = mpEvent -> key();
+    const int current_try = m_GameSession.GetNumberOfTries();
     if (key == Qt::Key_Return ||
         key == Qt::Key_Enter)
     {
-        const QString current = m_Tries.last();
-        if (current.size() == m_Word.size())
+        if (m_GameSession.IsFinished() ||
+            m_GameSession.GetCurrentLength() !=
+                m_GameSession.GetWordLength())
+        {
+            CALL_OUT("");
+            return;
+        }
+
+        // Boards still in play get colors and the next try (one board
+        // grows, so everything below it moves), and some letters of the
+        // alphabet change
+        const int num_boards = m_GameSession.GetNumberOfBoards();
+        bool in_play[GameSession::MAXIMUM_NUMBER_OF_BOARDS];
+        for (int board = 0;
+             board < num_boards;
+             board++)
+        {
+            in_play[board] = !m_GameSession.IsBoardSolved(board);
+        }
+        CheckNewTry();
+        if (num_boards == 1 ||
+            m_GameSession.GetNumberOfBoards() != num_boards ||
+            m_GameSession.GetNumberOfTries() != current_try + 1)
+        {
+            // One board, a new game, or the try was refused
+            m_RenderScheduler.InvalidateAll();
+            CALL_OUT("");
+            return;
+        }
+        for (int board = 0;
+             board < num_boards;
+             board++)
+        {
+            if (in_play[board])
+            {
+                m_RenderScheduler.Invalidate(
+                    GetTryRect(board, current_try)
+                        .united(GetTryRect(board, current_try + 1)));
+            }
+        }
+        const quint32 changed_letters = m_GameSession.GetChangedLetters();
+        for (int letter = 0;
+             letter < 26;
+             letter++)
         {
-            CheckNewTry();
-            repaint();
+            if (changed_letters & (1u << letter))
+            {
+                m_RenderScheduler.Invalidate(GetKeyTileRect(letter));
+            }
         }
         CALL_OUT("");
         return;
     }
+
+    // Editing the current try only changes one tile per board, unless all
+    // of its letters change color
+    const bool was_dead_end = m_GameSession.IsCurrentTryDeadEnd();
     if (key == Qt::Key_Backspace ||
         key == Qt::Key_Delete)
     {
-        QString current = m_Tries.takeLast();
-        if (current.size() > 0)
+        const int index = m_GameSession.GetCurrentLength() - 1;
+        if (m_GameSession.RemoveLetter())
         {
-            current = current.left(current.size() - 1);
+            InvalidateCurrentTry(index, was_dead_end);
         }
-        m_Tries << current;
-        repaint();
         CALL_OUT("");
         return;
     }
-    const QString text = mpEvent -> text().toLower();
-    if (text >= "a" && text <= "z")
+    if (key >= Qt::Key_A &&
+        key <= Qt::Key_Z)
     {
-        QString current = m_Tries.takeLast();
-        if (current.size() < m_Word.size())
+        const int index = m_GameSession.GetCurrentLength();
+        if (m_GameSession.AddLetter(key - Qt::Key_A))
         {
-            current += text;
+            InvalidateCurrentTry(index, was_dead_end);
         }
-        m_Tries << current;
-        repaint();
         CALL_OUT("");
         return;
     }
@@ -250,6 +471,36 @@ void MainWindow::keyPressEvent(QKeyEvent * mpEvent)
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// The current try changed at one letter
+void MainWindow::InvalidateCurrentTry(const int mcIndex,
+    const bool mcWasDeadEnd)
+{
+    CALL_IN(QString("mcIndex=%1, mcWasDeadEnd=%2")
+        .arg(QString::number(mcIndex),
+             mcWasDeadEnd ? "true" : "false"));
+
+    const int current_try = m_GameSession.GetNumberOfTries();
+    const bool whole_try =
+        (m_GameSession.IsCurrentTryDeadEnd() != mcWasDeadEnd);
+    for (int board = 0;
+         board < m_GameSession.GetNumberOfBoards();
+         board++)
+    {
+        if (m_GameSession.IsBoardSolved(board))
+        {
+            continue;
+        }
+        m_RenderScheduler.Invalidate(whole_try ?
+            GetTryRect(board, current_try) :
+            GetTryTileRect(board, current_try, mcIndex));
+    }
+
+    CALL_OUT("");
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Redraw
 void MainWindow::paintEvent(QPaintEvent * mpEvent)
@@ -259,108 +510,86 @@ void MainWindow::paintEvent(QPaintEvent * mpEvent)
     // Accept event
     mpEvent -> accept();
 
-    // Some prep
-    QFont small_font;
-    QFont large_font;
-    large_font.setPixelSize(30);
-
-    // Draw everything
+    // Tiles for this screen; only draw the ones that need it (boards that
+    // did not change are skipped as a whole)
+    m_RenderScheduler.PaintStarted();
+    m_TileCache.SetDevicePixelRatio(devicePixelRatioF());
     QPainter painter(this);
-    int y = 20;
-
-    // Past tries
-    const int try_scale = 40;
-    const int try_space = 5;
-    int left =
-        (width() - (m_Word.size() * (try_scale + try_space) - try_space)) / 2;
-    painter.setFont(large_font);
-    QFontMetrics metrics(large_font);
-    for (int this_try = 0;
-         this_try < m_Tries.size();
-         this_try++)
+    const QRect dirty_rect = mpEvent -> rect();
+    const int length = m_GameSession.GetWordLength();
+    const int num_tries = m_GameSession.GetNumberOfTries();
+    const int tile_size = GetTryTileSize();
+    quint8 status[Feedback::MAXIMUM_WORD_LENGTH];
+    for (int board = 0;
+         board < m_GameSession.GetNumberOfBoards();
+         board++)
     {
-        const bool is_current_try =
-            (!m_LastTryFinished) && (this_try == m_Tries.size() - 1);
-        const QString text = m_Tries[this_try];
-
-        int x = left;
-        for (int index = 0;
-             index < m_Word.size();
-             index++)
+        if (!GetBoardRect(board).intersects(dirty_rect))
+        {
+            continue;
+        }
+
+        // Past tries, then the current one
+        for (int this_try = 0;
+             this_try < GetNumberOfRows(board);
+             this_try++)
         {
-            QColor color(255, 255, 255);
-            if (!is_current_try)
+            if (!GetTryRect(board, this_try).intersects(dirty_rect))
             {
-                if (text[index] == m_Word[index])
-                {
-                    color = m_StatusToColor[Status_CorrectPosition];
-                } else if (m_Word.contains(text[index]))
-                {
-                    color = m_StatusToColor[Status_WrongPosition];
-                } else
-                {
-                    color = m_StatusToColor[Status_NotInWord];
-                }
+                continue;
+            }
+            const bool is_current_try = (this_try == num_tries);
+            const quint8 * letters;
+            int num_letters;
+            if (is_current_try)
+            {
+                letters = m_GameSession.GetCurrentLetters();
+                num_letters = m_GameSession.GetCurrentLength();
+            } else
+            {
+                letters = m_GameSession.GetTryLetters(this_try);
+                num_letters = length;
+                Feedback::Decode(m_GameSession.GetTryCode(board, this_try),
+                    length, status);
             }
-            painter.fillRect(x,
-                             y,
-                             try_scale,
-                             try_scale,
-                             color);
-            painter.drawRect(x,
-                             y,
-                             try_scale,
-                             try_scale);
-            if (index < text.size())
+            for (int index = 0;
+                 index < length;
+                 index++)
             {
-                const QString letter = text[index].toUpper();
-                const int dx =
-                    (try_scale - metrics.horizontalAdvance(letter)) / 2;
-                painter.drawText(x + dx,
-                                 y + 30,
-                                 letter);
+                const QRect rect = GetTryTileRect(board, this_try, index);
+                if (!rect.intersects(dirty_rect))
+                {
+                    continue;
+                }
+                const int letter = index < num_letters ?
+                    letters[index] : TileCache::NO_LETTER;
+                const int tile_status = is_current_try ?
+                    int(GameSession::Status_NotTried) :
+                    GameSession::Status_NotInWord + status[index];
+
+                // No word starts like the current try
+                const bool highlighted =
+                    is_current_try && m_GameSession.IsCurrentTryDeadEnd();
+                painter.drawPixmap(rect.topLeft(), m_TileCache.GetTile(
+                    letter, tile_status, highlighted, tile_size));
             }
-            x += try_scale + try_space;
         }
-        y += try_scale + try_space;
     }
 
-    // Alphabet
-    const int letter_scale = 20;
-    const int letters_per_row = 8;
-    left = (width() - letters_per_row * letter_scale) / 2;
-    y += 20;
-    painter.setFont(small_font);
-    metrics = QFontMetrics(small_font);
-    for (char letter = 'a';
-         letter <= 'z';
+    // Alphabet (best status on the boards still in play)
+    for (int letter = 0;
+         letter < 26;
          letter++)
     {
-        const int row = (letter - 'a') / letters_per_row;
-        const int column = (letter - 'a') % letters_per_row;
-        if (column == 0 &&
-            row == ('z' - 'a') / letters_per_row)
+        const QRect rect = GetKeyTileRect(letter);
+        if (rect.intersects(dirty_rect))
         {
-            left = (width() - ('z' - letter + 1) * letter_scale) / 2;
+            painter.drawPixmap(rect.topLeft(), m_TileCache.GetTile(letter,
+                m_GameSession.GetLetterStatus(letter), false, KEY_TILE_SIZE));
         }
-        const QString letter_text = QString(letter);
-        const Status status = m_LetterStatus[letter_text];
-        QColor color(m_StatusToColor[status]);
-        painter.fillRect(left + column * letter_scale,
-                         y + row * letter_scale,
-                         letter_scale,
-                         letter_scale,
-                         color);
-        painter.drawRect(left + column * letter_scale,
-                         y + row * letter_scale,
-                         letter_scale,
-                         letter_scale);
-        const int dx = (letter_scale
-            - metrics.horizontalAdvance(letter_text.toUpper())) / 2;
-        painter.drawText(left + column * letter_scale + dx,
-                         y + (row + .5) * letter_scale + 5,
-                         letter_text.toUpper());
     }
+    painter.end();
+    m_RenderScheduler.PaintFinished();
 
     CALL_OUT("");
 }
@@ -368,73 +597,313 @@ void MainWindow::paintEvent(QPaintEvent * mpEvent)
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Check if finished
-void MainWindow::CheckNewTry()
+// Largest size of a tile of a try
+const int MainWindow::TRY_TILE_SIZE = 40;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Space between tiles of a try (at the largest size)
+const int MainWindow::TRY_TILE_SPACING = 5;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Space between boards
+const int MainWindow::BOARD_SPACING = 20;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of a tile of the alphabet
+const int MainWindow::KEY_TILE_SIZE = 20;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letters per row of the alphabet
+const int MainWindow::KEYS_PER_ROW = 8;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of tries shown on a board
+int MainWindow::GetNumberOfRows(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    // No current try once the board is solved or the game is over
+    const bool has_current_try = !m_GameSession.IsFinished() &&
+        !m_GameSession.IsBoardSolved(mcBoard);
+
+    CALL_OUT("");
+    return m_GameSession.GetNumberOfTries(mcBoard) + (has_current_try ? 1 : 0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Boards per row of boards
+int MainWindow::GetNumberOfBoardColumns() const
 {
     CALL_IN("");
 
-    // Check if there a duplicates if that's not currently desired
-    AllWords * aw = AllWords::Instance();
-    const QString word = m_Tries.last();
-    if (aw -> GetAvoidDuplicateLetters() &&
-        aw -> HasDuplicateLetters(word))
+    // Up to four boards side by side; eight for more than eight boards
+    const int num_boards = qMax(1, m_GameSession.GetNumberOfBoards());
+
+    CALL_OUT("");
+    return qMin(num_boards, num_boards > 8 ? 8 : 4);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Distance between tiles of a try
+int MainWindow::GetTryTileStep() const
+{
+    CALL_IN("");
+
+    // One board: full size
+    const int largest_step = TRY_TILE_SIZE + TRY_TILE_SPACING;
+    const int num_boards = m_GameSession.GetNumberOfBoards();
+    const int length = m_GameSession.GetWordLength();
+    if (num_boards <= 1 ||
+        length == 0)
     {
         CALL_OUT("");
-        return;
+        return largest_step;
     }
 
-    // Check if that's a real word
-    if (!aw -> IsValid(word))
+    // Several boards: all of them, with all of their tries, and the
+    // alphabet fit into the window
+    const int num_columns = GetNumberOfBoardColumns();
+    const int num_rows = (num_boards + num_columns - 1) / num_columns;
+    const int key_rows = (26 + KEYS_PER_ROW - 1) / KEYS_PER_ROW;
+    const int step_for_width =
+        (width() - 2 * 20 - (num_columns - 1) * BOARD_SPACING)
+            / (num_columns * length);
+    const int step_for_height = (height() - 20
+        - (num_rows - 1) * BOARD_SPACING - 20 - key_rows * KEY_TILE_SIZE - 20)
+            / (num_rows * m_GameSession.GetMaximumNumberOfTries());
+
+    CALL_OUT("");
+    return qBound(8, qMin(step_for_width, step_for_height), largest_step);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of a tile of a try
+int MainWindow::GetTryTileSize() const
+{
+    CALL_IN("");
+
+    // Same proportion of tile and space at all sizes
+    CALL_OUT("");
+    return GetTryTileStep() * TRY_TILE_SIZE
+        / (TRY_TILE_SIZE + TRY_TILE_SPACING);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Top left corner of a board
+QPoint MainWindow::GetBoardOrigin(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    // Rows of boards, centered
+    const int step = GetTryTileStep();
+    const int spacing = step - GetTryTileSize();
+    const int board_width = m_GameSession.GetWordLength() * step - spacing;
+    const int num_columns = GetNumberOfBoardColumns();
+    const int left = (width() - (num_columns * board_width
+        + (num_columns - 1) * BOARD_SPACING)) / 2;
+    const int column = mcBoard % num_columns;
+    const int row = mcBoard / num_columns;
+
+    CALL_OUT("");
+    return QPoint(left + column * (board_width + BOARD_SPACING),
+        20 + row * (GetBoardHeight() + BOARD_SPACING));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Height of a board
+int MainWindow::GetBoardHeight() const
+{
+    CALL_IN("");
+
+    // One board grows with every try; several have room for all of them
+    const int step = GetTryTileStep();
+    const int spacing = step - GetTryTileSize();
+    const int num_rows = m_GameSession.GetNumberOfBoards() <= 1 ?
+        GetNumberOfRows(0) : m_GameSession.GetMaximumNumberOfTries();
+
+    CALL_OUT("");
+    return qMax(0, num_rows * step - spacing);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Area of a tile of a try (including its frame)
+QRect MainWindow::GetTryTileRect(const int mcBoard, const int mcTry,
+    const int mcIndex) const
+{
+    CALL_IN(QString("mcBoard=%1, mcTry=%2, mcIndex=%3")
+        .arg(QString::number(mcBoard),
+             QString::number(mcTry),
+             QString::number(mcIndex)));
+
+    const QPoint origin = GetBoardOrigin(mcBoard);
+    const int step = GetTryTileStep();
+    const int tile_size = GetTryTileSize();
+
+    CALL_OUT("");
+    return QRect(origin.x() + mcIndex * step, origin.y() + mcTry * step,
+        tile_size + 1, tile_size + 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Area of a whole try
+QRect MainWindow::GetTryRect(const int mcBoard, const int mcTry) const
+{
+    CALL_IN(QString("mcBoard=%1, mcTry=%2")
+        .arg(QString::number(mcBoard),
+             QString::number(mcTry)));
+
+    CALL_OUT("");
+    return GetTryTileRect(mcBoard, mcTry, 0)
+        .united(GetTryTileRect(mcBoard, mcTry,
+            qMax(0, m_GameSession.GetWordLength() - 1)));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Area of a whole board
+QRect MainWindow::GetBoardRect(const int mcBoard) const
+{
+    CALL_IN(QString("mcBoard=%1")
+        .arg(QString::number(mcBoard)));
+
+    const QPoint origin = GetBoardOrigin(mcBoard);
+    const int step = GetTryTileStep();
+    const int spacing = step - GetTryTileSize();
+    const int board_width = m_GameSession.GetWordLength() * step - spacing;
+
+    CALL_OUT("");
+    return QRect(origin.x(), origin.y(), board_width + 1,
+        GetBoardHeight() + 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Area of a letter of the alphabet (including its frame)
+QRect MainWindow::GetKeyTileRect(const int mcLetter) const
+{
+    CALL_IN(QString("mcLetter=%1")
+        .arg(QString::number(mcLetter)));
+
+    // Below the boards; every row is centered
+    const int num_columns = GetNumberOfBoardColumns();
+    const int num_rows =
+        (qMax(1, m_GameSession.GetNumberOfBoards()) + num_columns - 1)
+            / num_columns;
+    const int top = 20 + num_rows * (GetBoardHeight() + BOARD_SPACING)
+        - BOARD_SPACING + 20;
+    const int row = mcLetter / KEYS_PER_ROW;
+    const int column = mcLetter % KEYS_PER_ROW;
+    const int keys_in_row = qMin(KEYS_PER_ROW, 26 - row * KEYS_PER_ROW);
+    const int left = (width() - keys_in_row * KEY_TILE_SIZE) / 2;
+
+    CALL_OUT("");
+    return QRect(left + column * KEY_TILE_SIZE, top + row * KEY_TILE_SIZE,
+        KEY_TILE_SIZE + 1, KEY_TILE_SIZE + 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Submit the current try, and check if finished
+void MainWindow::CheckNewTry()
+{
+    CALL_IN("");
+
+    // Tries with duplicate letters are ignored if that's not currently
+    // desired; unknown words may be added
+    GameSession::SubmitResult result = m_GameSession.Submit();
+    if (result == GameSession::Submit_UnknownWord)
     {
+        const QString word = AllWords::DecodeWord(
+            m_GameSession.GetCurrentLetters(),
+            m_GameSession.GetCurrentLength());
         const int response = QMessageBox::question(this,
             tr("New word"),
             tr("Is \"%1\" actually a valid word?")
                 .arg(word));
-        if (response == QMessageBox::Yes)
-        {
-            aw -> AddWord(word);
-        } else
+        if (response != QMessageBox::Yes)
         {
             CALL_OUT("");
             return;
         }
+        AllWords::Instance() -> AddWord(word);
+        result = m_GameSession.Submit();
     }
 
-    // Update letter status
-    for (int index = 0;
-         index < m_Word.size();
-         index++)
-    {
-        const QString letter = word[index];
-        if (letter == m_Word[index])
-        {
-            m_LetterStatus[letter] = Status_CorrectPosition;
-        } else if (m_Word.contains(letter) &&
-                   m_LetterStatus[letter] != Status_CorrectPosition)
-        {
-            m_LetterStatus[letter] = Status_WrongPosition;
-        } else
-        {
-            m_LetterStatus[letter] = Status_NotInWord;
-        }
-    }
-
-    // Finished?
-    if (word == m_Word)
+    // Finished? (drawn while the message box is up)
+    const int num_tries = m_GameSession.GetNumberOfTries();
+    const int num_boards = m_GameSession.GetNumberOfBoards();
+    if (result == GameSession::Submit_Solved)
     {
-        m_LastTryFinished = true;
-        repaint();
-        QMessageBox::information(this, tr("You won!"),
+        m_RenderScheduler.InvalidateAll();
+        const QString attempts =
+            num_tries == 1 ? tr("attempt") : tr("attempts");
+        QMessageBox::information(this, tr("You won!"), num_boards == 1 ?
             tr("Congratulations! You correctly guessed the word after %1 %2.")
-                .arg(QString::number(m_Tries.size()),
-                     m_Tries.size() == 1 ? tr("attempt") : tr("attempts")));
+                .arg(QString::number(num_tries),
+                     attempts) :
+            tr("Congratulations! You correctly guessed all %1 words after "
+                "%2 %3.")
+                .arg(QString::number(num_boards),
+                     QString::number(num_tries),
+                     attempts));
         NewGame();
-    } else
+    } else if (result == GameSession::Submit_OutOfTries)
     {
-        // Next try
-        m_Tries << QString();
+        // Words not found
+        QStringList words;
+        for (int board = 0;
+             board < num_boards;
+             board++)
+        {
+            if (!m_GameSession.IsBoardSolved(board))
+            {
+                words << QString("\"%1\"")
+                    .arg(AllWords::DecodeWord(m_GameSession.GetAnswer(board),
+                        m_GameSession.GetWordLength()).toUpper());
+            }
+        }
+        // A game has at most GameSession::MAXIMUM_NUMBER_OF_TRIES tries,
+        // even with a single board
+        m_RenderScheduler.InvalidateAll();
+        QMessageBox::information(this, tr("Out of tries"),
+            words.size() == 1 ?
+                tr("All %1 tries are used up. The word was %2.")
+                    .arg(QString::number(num_tries),
+                         words.first()) :
+                tr("All %1 tries are used up. The words were %2.")
+                    .arg(QString::number(num_tries),
+                         words.join(", ")));
+        NewGame();
     }
 
     CALL_OUT("");
 }
-
@@ -4,9 +4,19 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+// Project includes
+#include "CandidateFilter.h"
+#include "Feedback.h"
+#include "GameSession.h"
+#include "RenderScheduler.h"
+#include "Solver.h"
+#include "TileCache.h"
+
 // Qt includes
-#include <QHash>
+#include <QAction>
 #include <QList>
+#include <QPoint>
+#include <QRect>
 #include <QWidget>
 
 
@@ -46,30 +56,73 @@ private slots:
     // Action handlers
     void About() const;
     void NewGame();
+    void Hint();
+    void Profile(const bool mcEnabled);
+    void FrameStatistics();
+    void SelectNumberOfBoards(QAction * mpAction);
     void Quit();
 
 private:
-    QString m_Word;
-    QList < QString > m_Tries;
-    bool m_LastTryFinished;
-
-    enum Status {
-        Status_NotTried,
-        Status_NotInWord,
-        Status_WrongPosition,
-        Status_CorrectPosition
-    };
-    QHash < QString, Status > m_LetterStatus;
-    QHash < Status, QColor > m_StatusToColor;
+    // The game: words, tries and what is known about every letter
+    GameSession m_GameSession;
+
+    // Boards (words guessed at the same time) of the next game; with more
+    // than one, there are that many plus five tries
+    int m_NumberOfBoards;
+
+    // Words still possible on a board given the tries so far, and hints
+    CandidateFilter m_CandidateFilter;
+    Solver m_Solver;
+
+    // Layout (in pixels): boards of tries, then the alphabet. One board
+    // has tiles of TRY_TILE_SIZE and grows with every try; several boards
+    // have room for all of their tries, with tiles as large as fit.
+    static const int TRY_TILE_SIZE;
+    static const int TRY_TILE_SPACING;
+    static const int BOARD_SPACING;
+    static const int KEY_TILE_SIZE;
+    static const int KEYS_PER_ROW;
+
+    // Number of tries shown on a board (the finished ones and the current
+    // one)
+    int GetNumberOfRows(const int mcBoard) const;
+
+    // Boards per row of boards
+    int GetNumberOfBoardColumns() const;
+
+    // Distance between tiles of a try, and their size
+    int GetTryTileStep() const;
+    int GetTryTileSize() const;
+
+    // Top left corner of a board, and its height
+    QPoint GetBoardOrigin(const int mcBoard) const;
+    int GetBoardHeight() const;
+
+    // Area of a tile (including its frame), of a whole try, of a whole
+    // board, and of a letter of the alphabet
+    QRect GetTryTileRect(const int mcBoard, const int mcTry,
+        const int mcIndex) const;
+    QRect GetTryRect(const int mcBoard, const int mcTry) const;
+    QRect GetBoardRect(const int mcBoard) const;
+    QRect GetKeyTileRect(const int mcLetter) const;
+
+    // The current try changed at one letter (on all boards still in play)
+    void InvalidateCurrentTry(const int mcIndex, const bool mcWasDeadEnd);
+
+    // Pre-rendered tiles; the status of a tile is a GameSession::Status
+    TileCache m_TileCache;
+
+    // Changes are drawn at most once per frame
+    RenderScheduler m_RenderScheduler;
 
 protected:
-    // Get key
+    // Get key; only the tiles that changed are redrawn, with the next frame
     virtual void keyPressEvent(QKeyEvent * mpEvent);
 
-    // Redraw
+    // Redraw (the part of the window that needs it)
     void paintEvent(QPaintEvent * mpEvent);
 
-    // Check if finished
+    // Submit the current try, and check if finished
     void CheckNewTry();
 };
 
@@ -0,0 +1,151 @@
+// ParallelLoop.cpp
+// Class definition
+
+// Project includes
+#include "MessageLogger.h"
+#include "ParallelLoop.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QAtomicInt>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+ParallelLoop::ParallelLoop()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ======================================================================== Run
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Run body for all items
+void ParallelLoop::Run(const int mcNumberOfItems, const int mcChunkSize,
+    const int mcNumberOfThreads,
+    const std::function < void(int, int, int) > & mcrBody)
+{
+    CALL_IN(QString("mcNumberOfItems=%1, mcChunkSize=%2, "
+        "mcNumberOfThreads=%3, mcrBody=...")
+        .arg(QString::number(mcNumberOfItems),
+             QString::number(mcChunkSize),
+             QString::number(mcNumberOfThreads)));
+
+    // Check parameters
+    if (mcChunkSize < 1 ||
+        mcNumberOfThreads < 1)
+    {
+        const QString reason = QObject::tr("Invalid chunk size %1 or number "
+            "of threads %2.")
+            .arg(QString::number(mcChunkSize),
+                 QString::number(mcNumberOfThreads));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    // Nothing to do?
+    if (mcNumberOfItems <= 0)
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Shared state. Workers that only start after everything is done still
+    // find the state (and then simply find no more chunks to take).
+    struct Context
+    {
+        QAtomicInt m_NextItem;
+        QAtomicInt m_DoneItems;
+        QMutex m_Mutex;
+        QWaitCondition m_AllDone;
+    };
+    QSharedPointer < Context > context(new Context);
+    context -> m_NextItem.storeRelaxed(0);
+    context -> m_DoneItems.storeRelaxed(0);
+
+    // The body is only ever called while there are items left, i.e. before
+    // we return - so referencing it (and whatever it references) is safe.
+    const std::function < void(int, int, int) > * body = &mcrBody;
+    const int num_items = mcNumberOfItems;
+    const int chunk_size = mcChunkSize;
+    auto worker = [context, body, num_items, chunk_size](const int mcWorker)
+    {
+        while (true)
+        {
+            const int first =
+                context -> m_NextItem.fetchAndAddRelaxed(chunk_size);
+            if (first >= num_items)
+            {
+                break;
+            }
+            const int last = qMin(first + chunk_size, num_items);
+            (*body)(mcWorker, first, last);
+
+            // Let the caller know if this was the last chunk
+            const int done = last - first
+                + context -> m_DoneItems.fetchAndAddOrdered(last - first);
+            if (done == num_items)
+            {
+                QMutexLocker locker(&context -> m_Mutex);
+                context -> m_AllDone.wakeAll();
+            }
+        }
+    };
+
+    // Helpers in the global pool; no point in more workers than chunks
+    const int num_chunks = (num_items + chunk_size - 1) / chunk_size;
+    const int num_workers = qMin(mcNumberOfThreads, num_chunks);
+    QThreadPool * pool = QThreadPool::globalInstance();
+    for (int worker_index = 1;
+         worker_index < num_workers;
+         worker_index++)
+    {
+        pool -> start([worker, worker_index]()
+            {
+                worker(worker_index);
+            });
+    }
+
+    // Do our share, then wait for chunks still in progress elsewhere
+    worker(0);
+    QMutexLocker locker(&context -> m_Mutex);
+    while (context -> m_DoneItems.loadAcquire() < num_items)
+    {
+        context -> m_AllDone.wait(&context -> m_Mutex);
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Default number of threads
+int ParallelLoop::GetDefaultNumberOfThreads()
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return qMax(1, QThread::idealThreadCount());
+}
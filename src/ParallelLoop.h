@@ -0,0 +1,39 @@
+// ParallelLoop.h
+// Class definition
+
+#ifndef PARALLELLOOP_H
+#define PARALLELLOOP_H
+
+// System includes
+#include <functional>
+
+
+
+// Class definition
+class ParallelLoop
+{
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    ParallelLoop();
+
+
+
+    // ==================================================================== Run
+public:
+    // Run mcrBody(worker, first, last) for all items [0, mcNumberOfItems) in
+    // chunks of mcChunkSize items, on up to mcNumberOfThreads threads (the
+    // calling thread included; it has worker index 0). Returns once all items
+    // are done. Workers take the next chunk from a shared counter as soon as
+    // they are done with the previous one, so uneven chunks balance out.
+    // Loops may be nested: the caller never waits for a worker that has not
+    // started yet.
+    static void Run(const int mcNumberOfItems, const int mcChunkSize,
+        const int mcNumberOfThreads,
+        const std::function < void(int, int, int) > & mcrBody);
+
+    // Default number of threads
+    static int GetDefaultNumberOfThreads();
+};
+
+#endif
@@ -10,7 +10,6 @@
 #include "AllTaskLinks.h"
 #include "AutocompletionLineEdit.h"
 #include "Calendar.h"
-#include "CallTracer.h"
 #include "CommentEditor.h"
 #include "GroupEditor.h"
 #include "LinkEditor.h"
@@ -20,6 +19,7 @@
 #include "ProjectEditor.h"
 #include "StringHelper.h"
 #include "TaskEditor.h"
+#include "Tracing.h"
 
 // Qt includes
 #include <QAction>
@@ -976,6 +976,7 @@ void ProjectEditor::ScheduleHasChanged()
 void ProjectEditor::SetSelection(const QSet < int > mcNewSelectedTaskIDs,
     const QSet < int > mcNewSelectedGroupIDs)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_selected_task_ids;
     for (const int task_id : mcNewSelectedTaskIDs)
     {
@@ -988,6 +989,7 @@ void ProjectEditor::SetSelection(const QSet < int > mcNewSelectedTaskIDs,
         all_selected_group_ids << QString::number(group_id);
     }
     std::sort(all_selected_group_ids.begin(), all_selected_group_ids.end());
+#endif
     CALL_IN(QString("mcNewSelectedTaskIDs={%1}, mcNewSelectedGroupIDs={%2}")
         .arg(all_selected_task_ids.join(", "),
              all_selected_group_ids.join(", ")));
@@ -1091,12 +1093,14 @@ void ProjectEditor::SetSelection(const QSet < int > mcNewSelectedTaskIDs,
 // Select task IDs only
 void ProjectEditor::SetSelectedTaskIDs(const QSet < int > mcNewSelectedTaskIDs)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_selected_task_ids;
     for (const int task_id : mcNewSelectedTaskIDs)
     {
         all_selected_task_ids << QString::number(task_id);
     }
     std::sort(all_selected_task_ids.begin(), all_selected_task_ids.end());
+#endif
     CALL_IN(QString("mcNewSelectedTaskIDs={%1}")
         .arg(all_selected_task_ids.join(", ")));
 
@@ -1112,12 +1116,14 @@ void ProjectEditor::SetSelectedTaskIDs(const QSet < int > mcNewSelectedTaskIDs)
 void ProjectEditor::SetSelectedGroupIDs(
     const QSet < int > mcNewSelectedGroupIDs)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_selected_group_ids;
     for (const int group_id : mcNewSelectedGroupIDs)
     {
         all_selected_group_ids << QString::number(group_id);
     }
     std::sort(all_selected_group_ids.begin(), all_selected_group_ids.end());
+#endif
     CALL_IN(QString("mcNewSelectedGroupIDs={%1}")
         .arg(all_selected_group_ids.join(", ")));
 
@@ -3021,6 +3027,7 @@ int ProjectEditor::GetRowImageHeight_TaskItem(const int mcIndex)
                  content_index < content_html.size();
                  content_index++)
             {
+                CALL_BLOCK("QTextDocument layout");
                 QTextDocument text;
                 text.setHtml(content_html[content_index]);
                 text.setDocumentMargin(0.0);
@@ -5787,6 +5794,18 @@ void ProjectEditor::paintEvent(QPaintEvent * mpEvent)
         const QImage image_attributes = GetRowImage_Attributes(index);
         const QImage image_ganttchart = GetRowImage_GanttChart(index);
         const int row_height = GetRowImageHeight(index);
+        const bool show_ganttchart =
+            m_VisibleAttributes.contains(Attribute_GanttChart);
+        QPixmap pixmap_attributes;
+        QPixmap pixmap_ganttchart;
+        {
+            CALL_BLOCK("QPixmap::fromImage");
+            pixmap_attributes = QPixmap::fromImage(image_attributes);
+            if (show_ganttchart)
+            {
+                pixmap_ganttchart = QPixmap::fromImage(image_ganttchart);
+            }
+        }
         QImage row_image(
             m_AttributesTotalWidth + m_AttributeWidths[Attribute_GanttChart],
             row_height,
@@ -5796,19 +5815,19 @@ void ProjectEditor::paintEvent(QPaintEvent * mpEvent)
             0,
             m_AttributesTotalWidth,
             row_height,
-            QPixmap::fromImage(image_attributes),
+            pixmap_attributes,
             0,
             0,
             m_AttributesTotalWidth,
             row_height);
         int overall_width = m_AttributesTotalWidth;
-        if (m_VisibleAttributes.contains(Attribute_GanttChart))
+        if (show_ganttchart)
         {
             row_painter.drawPixmap(m_AttributesTotalWidth,
                 0,
                 m_AttributeWidths[Attribute_GanttChart],
                 row_height,
-                QPixmap::fromImage(image_ganttchart),
+                pixmap_ganttchart,
                 0,
                 0,
                 m_AttributeWidths[Attribute_GanttChart],
@@ -8640,12 +8659,14 @@ void ProjectEditor::Context_ToggleResource(const int mcTaskID,
 void ProjectEditor::Context_ToggleResource(const QSet < int > mcTaskIDs,
     const int mcResourceID)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_ids;
     for (const int task_id : mcTaskIDs)
     {
         all_ids << QString::number(task_id);
     }
     std::sort(all_ids.begin(), all_ids.end());
+#endif
     CALL_IN(QString("mcTaskIDs={%1}, mcResourceID=%2")
         .arg(all_ids.join(", "),
              QString::number(mcResourceID)));
@@ -8708,12 +8729,14 @@ void ProjectEditor::Context_AddResource(const int mcTaskID)
 // Add a resource (new or existing)
 void ProjectEditor::Context_AddResource(const QSet < int > mcTaskIDs)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_ids;
     for (const int task_id : mcTaskIDs)
     {
         all_ids << QString::number(task_id);
     }
     std::sort(all_ids.begin(), all_ids.end());
+#endif
     CALL_IN(QString("mcTaskIDs={%1}")
         .arg(all_ids.join(", ")));
 
@@ -8896,12 +8919,14 @@ void ProjectEditor::Context_DeleteTask(const int mcTaskID)
 // Context menu: delete tasks
 void ProjectEditor::Context_DeleteTasks(const QSet < int > mcTaskIDs)
 {
+#if GUESSWORD_TRACE_LEVEL > 1
     QList < QString > all_ids;
     for (const int task_id : mcTaskIDs)
     {
         all_ids << QString::number(task_id);
     }
     std::sort(all_ids.begin(), all_ids.end());
+#endif
     CALL_IN(QString("mcTaskIDs={%1}")
         .arg(all_ids.join(", ")));
 
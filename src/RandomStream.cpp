@@ -0,0 +1,166 @@
+// RandomStream.cpp
+// Class definition
+
+// Project includes
+#include "RandomStream.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+
+
+
+// Feistel rounds per permutation step
+static const int NUMBER_OF_ROUNDS = 4;
+
+// Round keys come from counters no stream gets to
+static const quint64 ROUND_KEY_COUNTER = 0x8000000000000000ull;
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+RandomStream::RandomStream()
+{
+    CALL_IN("");
+
+    Seed(0, 0);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+RandomStream::RandomStream(const quint64 mcSeed, const quint64 mcStream)
+{
+    CALL_IN(QString("mcSeed=%1, mcStream=%2")
+        .arg(QString::number(mcSeed),
+             QString::number(mcStream)));
+
+    Seed(mcSeed, mcStream);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start over with another stream
+void RandomStream::Seed(const quint64 mcSeed, const quint64 mcStream)
+{
+    CALL_IN(QString("mcSeed=%1, mcStream=%2")
+        .arg(QString::number(mcSeed),
+             QString::number(mcStream)));
+
+    m_Key = GetKey(mcSeed, mcStream);
+    m_Counter = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Key for a stream
+quint64 RandomStream::GetKey(const quint64 mcSeed, const quint64 mcStream)
+{
+    CALL_IN(QString("mcSeed=%1, mcStream=%2")
+        .arg(QString::number(mcSeed),
+             QString::number(mcStream)));
+
+    CALL_OUT("");
+    return Mix(Mix(mcSeed) + mcStream * 0xd1b54a32d192ed03ull);
+}
+
+
+
+// ==================================================================== Numbers
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Position within the stream
+void RandomStream::SetPosition(const quint64 mcPosition)
+{
+    CALL_IN(QString("mcPosition=%1")
+        .arg(QString::number(mcPosition)));
+
+    m_Counter = mcPosition;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Position within the stream
+quint64 RandomStream::GetPosition() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Counter;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Position of an index in a random permutation
+quint64 RandomStream::Permute(const quint64 mcKey, const quint64 mcIndex,
+    const quint64 mcSize)
+{
+    CALL_IN(QString("mcKey=%1, mcIndex=%2, mcSize=%3")
+        .arg(QString::number(mcKey),
+             QString::number(mcIndex),
+             QString::number(mcSize)));
+
+    if (mcSize <= 1 ||
+        mcIndex >= mcSize)
+    {
+        CALL_OUT("");
+        return mcSize <= 1 ? 0 : mcIndex % mcSize;
+    }
+
+    // Both halves have the same number of bits
+    int half_bits = 1;
+    while ((quint64(1) << (2 * half_bits)) < mcSize)
+    {
+        half_bits++;
+    }
+    const quint64 half_mask = (quint64(1) << half_bits) - 1;
+    quint64 round_keys[NUMBER_OF_ROUNDS];
+    for (int round = 0;
+         round < NUMBER_OF_ROUNDS;
+         round++)
+    {
+        round_keys[round] = Generate(mcKey, ROUND_KEY_COUNTER + round);
+    }
+
+    // Permute until we are in range again (the values in between are
+    // outside, so every index in range maps to a different one in range)
+    quint64 value = mcIndex;
+    do
+    {
+        quint64 left = value >> half_bits;
+        quint64 right = value & half_mask;
+        for (int round = 0;
+             round < NUMBER_OF_ROUNDS;
+             round++)
+        {
+            const quint64 next_right =
+                left ^ (Mix(right ^ round_keys[round]) & half_mask);
+            left = right;
+            right = next_right;
+        }
+        value = (left << half_bits) | right;
+    } while (value >= mcSize);
+
+    CALL_OUT("");
+    return value;
+}
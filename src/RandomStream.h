@@ -0,0 +1,102 @@
+// RandomStream.h
+// Class definition
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+// Qt includes
+#include <QtGlobal>
+
+
+
+// Class definition
+class RandomStream
+{
+    // Counter based random number generator: the n-th number of a stream is
+    // a hash of the stream's key and n, so any position can be reached in
+    // O(1) and streams (e.g. one per thread or per game) never share state.
+    // A stream's key follows from a seed and a stream number, so the same
+    // seed always gives the same numbers. Not suitable for cryptography.
+    //
+    // Permute() maps indices to a random permutation, e.g. to pick words
+    // without repetition and without remembering earlier picks.
+    //
+    // The inline functions are the innermost primitives of every random
+    // draw and are not traced; the rest of the class is.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor (stream 0 of seed 0)
+    RandomStream();
+
+    // Constructor
+    RandomStream(const quint64 mcSeed, const quint64 mcStream);
+
+    // Start over with another stream
+    void Seed(const quint64 mcSeed, const quint64 mcStream);
+
+    // Key for a stream
+    static quint64 GetKey(const quint64 mcSeed, const quint64 mcStream);
+
+private:
+    // Key and position
+    quint64 m_Key;
+    quint64 m_Counter;
+
+
+
+    // ================================================================ Numbers
+public:
+    // Position within the stream (number of numbers drawn so far)
+    void SetPosition(const quint64 mcPosition);
+    quint64 GetPosition() const;
+
+    // Number at a given position of the stream with a given key
+    static inline quint64 Generate(const quint64 mcKey,
+        const quint64 mcCounter)
+    {
+        return Mix(Mix(mcKey + mcCounter * 0x9e3779b97f4a7c15ull) ^ mcKey);
+    }
+
+    // Next number
+    inline quint64 Next()
+    {
+        return Generate(m_Key, m_Counter++);
+    }
+
+    // Next number in [0, mcBound) (without bias; mcBound must not be 0)
+    inline quint32 Bounded(const quint32 mcBound)
+    {
+        // Lemire's method: multiply and reject the few values that would
+        // make some results more likely than others
+        quint64 product = quint64(quint32(Next())) * mcBound;
+        if (quint32(product) < mcBound)
+        {
+            const quint32 threshold = quint32(-mcBound) % mcBound;
+            while (quint32(product) < threshold)
+            {
+                product = quint64(quint32(Next())) * mcBound;
+            }
+        }
+        return quint32(product >> 32);
+    }
+
+    // Position of mcIndex in a random permutation of [0, mcSize) given by
+    // mcKey, in O(1) without any table (a Feistel network over the next
+    // power of four, walking the cycle until the result is in range; that
+    // takes fewer than four steps on average). Uses counters no stream
+    // reaches, so a stream's key may also serve as a permutation's key.
+    static quint64 Permute(const quint64 mcKey, const quint64 mcIndex,
+        const quint64 mcSize);
+
+private:
+    // Mixing function (the SplitMix64 finalizer)
+    static inline quint64 Mix(quint64 mValue)
+    {
+        mValue = (mValue ^ (mValue >> 30)) * 0xbf58476d1ce4e5b9ull;
+        mValue = (mValue ^ (mValue >> 27)) * 0x94d049bb133111ebull;
+        return mValue ^ (mValue >> 31);
+    }
+};
+
+#endif
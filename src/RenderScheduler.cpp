@@ -0,0 +1,327 @@
+// RenderScheduler.cpp
+// Class definition
+
+// Project includes
+#include "LatencyStatistics.h"
+#include "MessageLogger.h"
+#include "RenderScheduler.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QStringList>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+RenderScheduler::RenderScheduler()
+{
+    CALL_IN("");
+
+    m_Widget = nullptr;
+
+    // Timer for the next frame
+    m_FlushTimer.setSingleShot(true);
+    m_FlushTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_FlushTimer, SIGNAL(timeout()),
+        this, SLOT(Flush()));
+
+    // Nothing drawn yet
+    m_Clock.start();
+    m_LastFlushTime = -1;
+    m_PaintStartTime = -1;
+
+    // Changes are recorded while typing; no allocations then
+    m_PendingChanges.reserve(NUMBER_OF_SAMPLES);
+    m_RequestedChanges.reserve(NUMBER_OF_SAMPLES);
+    m_FrameTimes.reserve(NUMBER_OF_SAMPLES);
+    m_Latencies.reserve(NUMBER_OF_SAMPLES);
+    ResetStatistics();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+RenderScheduler::~RenderScheduler()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ================================================================= Scheduling
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Widget to update
+void RenderScheduler::SetWidget(QWidget * mpWidget)
+{
+    CALL_IN("mpWidget=...");
+
+    m_Widget = mpWidget;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Part of the widget changed
+void RenderScheduler::Invalidate(const QRect & mcrRect)
+{
+    CALL_IN("mcrRect=...");
+
+    // Remember the change
+    const qint64 now = m_Clock.nsecsElapsed();
+    m_NumberOfChanges++;
+    if (m_PendingChanges.size() < NUMBER_OF_SAMPLES)
+    {
+        m_PendingChanges << now;
+    }
+    m_DirtyRegion += mcrRect;
+
+    // Already waiting for the next frame
+    if (m_FlushTimer.isActive())
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Right away (after the events already queued) if the last frame is at
+    // least one interval ago, otherwise when it is
+    const qint64 interval = qint64(GetFrameInterval()) * 1000000;
+    int delay = 0;
+    if (m_LastFlushTime >= 0 &&
+        now - m_LastFlushTime < interval)
+    {
+        delay = int((interval - (now - m_LastFlushTime) + 999999) / 1000000);
+    }
+    m_FlushTimer.start(delay);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// All of the widget changed
+void RenderScheduler::InvalidateAll()
+{
+    CALL_IN("");
+
+    // Need a widget
+    if (!m_Widget)
+    {
+        const QString reason = tr("No widget to draw.");
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    Invalidate(m_Widget -> rect());
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Time between frames
+int RenderScheduler::GetFrameInterval() const
+{
+    CALL_IN("");
+
+    // Screen the widget is on (60 Hz if it cannot tell)
+    QScreen * screen = m_Widget ?
+        m_Widget -> screen() : QGuiApplication::primaryScreen();
+    const qreal refresh_rate = screen ? screen -> refreshRate() : 0;
+    if (refresh_rate <= 0)
+    {
+        CALL_OUT("");
+        return 16;
+    }
+
+    CALL_OUT("");
+    return qMax(1, qRound(1000. / refresh_rate));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Ask the widget to draw what changed
+void RenderScheduler::Flush()
+{
+    CALL_IN("");
+
+    // Nothing to draw (or nowhere to draw it)
+    if (!m_Widget ||
+        m_DirtyRegion.isEmpty())
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Changes are shown by the next paint
+    m_LastFlushTime = m_Clock.nsecsElapsed();
+    m_NumberOfFlushes++;
+    for (const qint64 change_time : std::as_const(m_PendingChanges))
+    {
+        if (m_RequestedChanges.size() < NUMBER_OF_SAMPLES)
+        {
+            m_RequestedChanges << change_time;
+        }
+    }
+    m_PendingChanges.clear();
+    m_Widget -> update(m_DirtyRegion);
+    m_DirtyRegion = QRegion();
+
+    CALL_OUT("");
+}
+
+
+
+// ============================================================ Instrumentation
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of frame times and latencies kept
+const int RenderScheduler::NUMBER_OF_SAMPLES = 4096;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Paint of the widget starts
+void RenderScheduler::PaintStarted()
+{
+    CALL_IN("");
+
+    m_PaintStartTime = m_Clock.nsecsElapsed();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Paint of the widget ends
+void RenderScheduler::PaintFinished()
+{
+    CALL_IN("");
+
+    // Needs a start
+    if (m_PaintStartTime < 0)
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Frame time, and latency of every change this paint shows
+    const qint64 now = m_Clock.nsecsElapsed();
+    m_NumberOfPaints++;
+    AddSample(m_FrameTimes, m_NextFrameTime, now - m_PaintStartTime);
+    for (const qint64 change_time : std::as_const(m_RequestedChanges))
+    {
+        AddSample(m_Latencies, m_NextLatency, now - change_time);
+    }
+    m_RequestedChanges.clear();
+    m_PaintStartTime = -1;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Changes, update() calls and paints so far, with percentiles
+QString RenderScheduler::GetReport() const
+{
+    CALL_IN("");
+
+    // Counts first; fewer update() calls than changes is what coalescing
+    // saves
+    QStringList lines;
+    lines << tr("%1 changes, %2 update() calls, %3 paints; frame interval "
+        "%4 ms")
+        .arg(QString::number(m_NumberOfChanges),
+             QString::number(m_NumberOfFlushes),
+             QString::number(m_NumberOfPaints),
+             QString::number(GetFrameInterval()));
+    lines << LatencyStatistics::GetHeader();
+    lines << LatencyStatistics::GetLine(tr("frame time"), m_FrameTimes);
+    lines << LatencyStatistics::GetLine(tr("input latency"), m_Latencies);
+
+    CALL_OUT("");
+    return lines.join("\n");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Print the report
+void RenderScheduler::PrintReport() const
+{
+    CALL_IN("");
+
+    qDebug().noquote() << GetReport();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Forget everything measured so far
+void RenderScheduler::ResetStatistics()
+{
+    CALL_IN("");
+
+    m_NumberOfChanges = 0;
+    m_NumberOfFlushes = 0;
+    m_NumberOfPaints = 0;
+    m_FrameTimes.clear();
+    m_NextFrameTime = 0;
+    m_Latencies.clear();
+    m_NextLatency = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Add a sample to a list of the most recent ones
+void RenderScheduler::AddSample(QList < qint64 > & mrSamples,
+    int & mrNextSample, const qint64 mcValue)
+{
+    CALL_IN(QString("mrSamples=..., mrNextSample=%1, mcValue=%2")
+        .arg(QString::number(mrNextSample),
+             QString::number(mcValue)));
+
+    if (mrSamples.size() < NUMBER_OF_SAMPLES)
+    {
+        mrSamples << mcValue;
+    } else
+    {
+        mrSamples[mrNextSample] = mcValue;
+        mrNextSample = (mrNextSample + 1) % NUMBER_OF_SAMPLES;
+    }
+
+    CALL_OUT("");
+}
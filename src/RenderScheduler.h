@@ -0,0 +1,129 @@
+// RenderScheduler.h
+// Class definition
+
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QRegion>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+
+
+// Class definition
+class RenderScheduler
+    : public QObject
+{
+    // Collects the parts of a widget that need to be redrawn and asks for at
+    // most one update() per frame interval (the refresh interval of the
+    // widget's screen), so input arriving faster than the screen refreshes
+    // (key auto-repeat, scanners typing) is merged into the next frame
+    // instead of painting once per event. The first change after an idle
+    // period is drawn right away.
+    //
+    // It also measures every paint (frame time) and, for every change, the
+    // time from the change until the end of the paint that shows it
+    // (input-to-present latency); see GetReport().
+
+    Q_OBJECT
+
+
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    RenderScheduler();
+
+    // Destructor
+    virtual ~RenderScheduler();
+
+
+
+    // ============================================================= Scheduling
+public:
+    // Widget to update
+    void SetWidget(QWidget * mpWidget);
+
+    // Part of the widget changed; it will be drawn in the next frame
+    void Invalidate(const QRect & mcrRect);
+
+    // All of the widget changed
+    void InvalidateAll();
+
+    // Time between frames (in milliseconds): the refresh interval of the
+    // widget's screen
+    int GetFrameInterval() const;
+
+private slots:
+    // Ask the widget to draw what changed
+    void Flush();
+
+private:
+    // Widget
+    QWidget * m_Widget;
+
+    // Pending changes
+    QRegion m_DirtyRegion;
+    QTimer m_FlushTimer;
+
+    // Time since construction (for all times here)
+    QElapsedTimer m_Clock;
+
+    // Time of the last update() (in nanoseconds; -1 if none yet)
+    qint64 m_LastFlushTime;
+
+
+
+    // ======================================================== Instrumentation
+public:
+    // Number of frame times and latencies kept for percentiles (the most
+    // recent ones)
+    static const int NUMBER_OF_SAMPLES;
+
+    // Paint of the widget starts/ends (call from its paintEvent())
+    void PaintStarted();
+    void PaintFinished();
+
+    // Changes, update() calls and paints so far, with frame time and
+    // latency percentiles
+    QString GetReport() const;
+
+    // Print the report
+    void PrintReport() const;
+
+    // Forget everything measured so far
+    void ResetStatistics();
+
+private:
+    // Add a sample to a list of the most recent ones
+    static void AddSample(QList < qint64 > & mrSamples, int & mrNextSample,
+        const qint64 mcValue);
+
+    // Times of changes not yet passed on with update(), and of the ones
+    // passed on but not painted yet (in nanoseconds)
+    QList < qint64 > m_PendingChanges;
+    QList < qint64 > m_RequestedChanges;
+
+    // Start of the current paint (in nanoseconds; -1 if not painting)
+    qint64 m_PaintStartTime;
+
+    // Counts
+    quint64 m_NumberOfChanges;
+    quint64 m_NumberOfFlushes;
+    quint64 m_NumberOfPaints;
+
+    // Most recent frame times and latencies (in nanoseconds); once there
+    // are NUMBER_OF_SAMPLES, a new one replaces the oldest
+    QList < qint64 > m_FrameTimes;
+    int m_NextFrameTime;
+    QList < qint64 > m_Latencies;
+    int m_NextLatency;
+};
+
+#endif
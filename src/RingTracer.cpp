@@ -0,0 +1,263 @@
+// RingTracer.cpp
+// Class definition
+
+// Project includes
+#include "MessageLogger.h"
+#include "RingTracer.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSaveFile>
+
+// System includes
+#include <chrono>
+
+
+
+// Events as stored in the buffers
+struct RingTracerEvent
+{
+    quint64 m_Timestamp;
+    quint32 m_Payload;
+    quint16 m_FunctionID;
+    quint8 m_Type;
+};
+
+// Buffer of one thread; only that thread writes events and the head
+struct RingTracerBuffer
+{
+    std::atomic < quint64 > m_Head { 0 };
+    RingTracerEvent m_Events[RingTracer::BUFFER_SIZE];
+};
+
+// Buffer of the calling thread (created on its first event)
+static thread_local RingTracerBuffer * s_ThreadBuffer = nullptr;
+
+// Everything else is only touched with the lock held: all buffers (they live
+// until the application ends, so dumps include threads that are gone) and
+// the interned function names
+static QMutex s_Mutex;
+static QList < RingTracerBuffer * > s_Buffers;
+static QHash < QByteArray, quint16 > s_FunctionIDs;
+static QList < QByteArray > s_FunctionNames;
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+RingTracer::RingTracer()
+{
+    // Nothing to do.
+}
+
+
+
+// ================================================================== Recording
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of events per thread
+const int RingTracer::BUFFER_SIZE;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+std::atomic < bool > RingTracer::m_Enabled { false };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+void RingTracer::SetEnabled(const bool mcEnabled)
+{
+    m_Enabled.store(mcEnabled, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ID for a function name
+quint16 RingTracer::InternFunction(const char * mcpName)
+{
+    QMutexLocker locker(&s_Mutex);
+
+    // Same name, same ID (e.g. inline functions used in several places)
+    const QByteArray name(mcpName);
+    const auto existing = s_FunctionIDs.constFind(name);
+    if (existing != s_FunctionIDs.constEnd())
+    {
+        return existing.value();
+    }
+
+    // New one (all functions beyond the 16 bit range share the last ID)
+    if (s_FunctionNames.size() == 0xffff)
+    {
+        return 0xffff;
+    }
+    const quint16 function_id = quint16(s_FunctionNames.size());
+    s_FunctionNames << name;
+    s_FunctionIDs.insert(name, function_id);
+    return function_id;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ID for a named block within a function
+quint16 RingTracer::InternBlock(const char * mcpFunctionName,
+    const char * mcpBlockName)
+{
+    const QByteArray name = QByteArray(mcpFunctionName) + " [" +
+        mcpBlockName + "]";
+    return InternFunction(name.constData());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Name for an ID
+QByteArray RingTracer::GetFunctionName(const quint16 mcFunctionID)
+{
+    QMutexLocker locker(&s_Mutex);
+    return mcFunctionID < s_FunctionNames.size() ?
+        s_FunctionNames[mcFunctionID] : QByteArray("?");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Record an event for the calling thread
+void RingTracer::Record(const quint16 mcFunctionID, const EventType mcType,
+    const quint32 mcPayload)
+{
+    // First event of this thread
+    RingTracerBuffer * buffer = s_ThreadBuffer;
+    if (!buffer)
+    {
+        buffer = new RingTracerBuffer();
+        QMutexLocker locker(&s_Mutex);
+        s_Buffers << buffer;
+        s_ThreadBuffer = buffer;
+    }
+
+    // Write the event, then publish it
+    const quint64 head = buffer -> m_Head.load(std::memory_order_relaxed);
+    RingTracerEvent & event = buffer -> m_Events[head & (BUFFER_SIZE - 1)];
+    event.m_Timestamp = quint64(std::chrono::duration_cast <
+        std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    event.m_Payload = mcPayload;
+    event.m_FunctionID = mcFunctionID;
+    event.m_Type = quint8(mcType);
+    buffer -> m_Head.store(head + 1, std::memory_order_release);
+}
+
+
+
+// ======================================================================= Dump
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Format of the binary file
+const quint32 RingTracer::DUMP_MAGIC = 0x47575254;
+const quint32 RingTracer::DUMP_VERSION = 1;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write all buffers to a compact binary file
+bool RingTracer::Dump(const QString mcFileName)
+{
+    // Copy events first, so the file is written without holding the lock.
+    // Writers keep going while we copy; events they overwrote in the
+    // meantime are dropped (they are the oldest ones).
+    QList < QByteArray > function_names;
+    QList < QList < RingTracerEvent > > thread_events;
+    {
+        QMutexLocker locker(&s_Mutex);
+        function_names = s_FunctionNames;
+        for (RingTracerBuffer * buffer : s_Buffers)
+        {
+            const quint64 head =
+                buffer -> m_Head.load(std::memory_order_acquire);
+            const quint64 first = head > quint64(BUFFER_SIZE) ?
+                head - BUFFER_SIZE : 0;
+            QList < RingTracerEvent > events;
+            events.reserve(int(head - first));
+            for (quint64 index = first;
+                 index < head;
+                 index++)
+            {
+                events << buffer -> m_Events[index & (BUFFER_SIZE - 1)];
+            }
+            // A writer fills slot new_head before it publishes new_head + 1,
+            // so event new_head - BUFFER_SIZE may be half overwritten too
+            const quint64 new_head =
+                buffer -> m_Head.load(std::memory_order_acquire);
+            if (new_head + 1 > first + BUFFER_SIZE)
+            {
+                events.remove(0, qMin(qsizetype(new_head + 1 - BUFFER_SIZE
+                    - first), events.size()));
+            }
+            thread_events << events;
+        }
+    }
+
+    // Write everything; QSaveFile only replaces the file once complete
+    QSaveFile file(mcFileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        const QString reason = QObject::tr("Could not write \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        return false;
+    }
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << DUMP_MAGIC
+        << DUMP_VERSION
+        << quint32(function_names.size())
+        << quint32(thread_events.size());
+    for (const QByteArray & name : function_names)
+    {
+        out << quint32(name.size());
+        out.writeRawData(name.constData(), name.size());
+    }
+    for (const QList < RingTracerEvent > & events : thread_events)
+    {
+        out << quint32(events.size());
+        for (const RingTracerEvent & event : events)
+        {
+            out << event.m_Timestamp
+                << event.m_Payload
+                << event.m_FunctionID
+                << event.m_Type;
+        }
+    }
+    if (out.status() != QDataStream::Ok ||
+        !file.commit())
+    {
+        const QString reason = QObject::tr("Could not write \"%1\".")
+            .arg(mcFileName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,129 @@
+// RingTracer.h
+// Class definition
+
+#ifndef RINGTRACER_H
+#define RINGTRACER_H
+
+// Project includes
+#include "CallProfiler.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// System includes
+#include <atomic>
+
+
+
+// Class definition
+class RingTracer
+{
+    // The ring tracer records function entry and exit (and marks with a
+    // small payload) into one ring buffer per thread. Writing an event takes
+    // no locks: every buffer has a single writer, and a dump only reads.
+    // When a buffer is full, the oldest events are overwritten, so a dump
+    // shows what happened most recently. Recording is off until enabled at
+    // runtime; while off, an event costs one relaxed atomic load.
+    //
+    // Function names are interned once per call site, so events only hold a
+    // 16 bit ID. This class is not traced itself.
+
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    RingTracer();
+
+
+
+    // ============================================================== Recording
+public:
+    // Event types
+    enum EventType {
+        Event_Enter = 0,
+        Event_Exit,
+        Event_Mark
+    };
+
+    // Number of events per thread (a power of two)
+    static const int BUFFER_SIZE = 65536;
+
+    // Runtime switch
+    static void SetEnabled(const bool mcEnabled);
+    static inline bool IsEnabled()
+    {
+        return m_Enabled.load(std::memory_order_relaxed);
+    }
+
+    // ID for a function name (mcpName must stay valid, e.g. Q_FUNC_INFO)
+    static quint16 InternFunction(const char * mcpName);
+
+    // ID for a named block within a function
+    static quint16 InternBlock(const char * mcpFunctionName,
+        const char * mcpBlockName);
+
+    // Name for an ID
+    static QByteArray GetFunctionName(const quint16 mcFunctionID);
+
+    // Record an event for the calling thread
+    static void Record(const quint16 mcFunctionID, const EventType mcType,
+        const quint32 mcPayload);
+
+    // Records entry on construction and exit on destruction, and measures
+    // the call for the CallProfiler (each only if enabled on entry, so
+    // entries and exits always come in pairs)
+    class Scope
+    {
+    public:
+        inline Scope(const quint16 mcFunctionID)
+        {
+            m_FunctionID = mcFunctionID;
+            m_Recording = IsEnabled();
+            if (m_Recording)
+            {
+                Record(m_FunctionID, Event_Enter, 0);
+            }
+            m_Profiling = CallProfiler::IsEnabled();
+            if (m_Profiling)
+            {
+                CallProfiler::Enter(m_FunctionID);
+            }
+        }
+        inline ~Scope()
+        {
+            if (m_Profiling)
+            {
+                CallProfiler::Exit(m_FunctionID);
+            }
+            if (m_Recording)
+            {
+                Record(m_FunctionID, Event_Exit, 0);
+            }
+        }
+
+    private:
+        quint16 m_FunctionID;
+        bool m_Recording;
+        bool m_Profiling;
+    };
+
+private:
+    // Runtime switch
+    static std::atomic < bool > m_Enabled;
+
+
+
+    // =================================================================== Dump
+public:
+    // Write all buffers to a compact binary file (see tools/TraceToChrome.cpp
+    // for the format and for converting it to Chrome/Perfetto trace JSON).
+    // May be called while other threads are recording.
+    static bool Dump(const QString mcFileName);
+
+    // Format of the binary file
+    static const quint32 DUMP_MAGIC;
+    static const quint32 DUMP_VERSION;
+};
+
+#endif
@@ -0,0 +1,433 @@
+// ServerConnection.cpp
+// Class definition
+
+// Project includes
+#include "AsyncMessageLogger.h"
+#include "GameServer.h"
+#include "GameSession.h"
+#include "ServerConnection.h"
+#include "ServerProtocol.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+
+// System includes
+#include <cstring>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+ServerConnection::ServerConnection(GameServer * mpServer,
+    QIODevice * mpSocket, const quint32 mcID)
+    : QObject(mpServer)
+{
+    CALL_IN(QString("mpServer=%1, mpSocket=%2, mcID=%3")
+        .arg(mpServer ? "..." : "nullptr",
+             mpSocket ? "..." : "nullptr",
+             QString::number(mcID)));
+
+    m_Server = mpServer;
+    m_Socket = mpSocket;
+    m_Socket -> setParent(this);
+    m_ID = mcID;
+    m_Words = AllWords::Instance();
+
+    // Buffers are allocated once
+    m_Input.resize(INPUT_BUFFER_SIZE);
+    m_InputSize = 0;
+    m_Output.reserve(INPUT_BUFFER_SIZE);
+    m_Sessions.reserve(GameSession::MAXIMUM_NUMBER_OF_BOARDS);
+
+    // Both QTcpSocket and QLocalSocket have disconnected()
+    connect(m_Socket, SIGNAL(readyRead()),
+        this, SLOT(ReadMessages()));
+    connect(m_Socket, SIGNAL(disconnected()),
+        this, SLOT(Disconnected()));
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+ServerConnection::~ServerConnection()
+{
+    CALL_IN("");
+
+    // Games of this client end with it
+    SessionPool & pool = m_Server -> GetSessionPool();
+    for (const quint32 session_id : std::as_const(m_Sessions))
+    {
+        pool.Release(session_id);
+    }
+    m_Server -> ConnectionClosed();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Client disconnected
+void ServerConnection::Disconnected()
+{
+    CALL_IN("");
+
+    // Not right away; we may be in one of the socket's signals
+    deleteLater();
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Messages
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of the input buffer
+const int ServerConnection::INPUT_BUFFER_SIZE = 65536;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Read and answer all complete messages
+void ServerConnection::ReadMessages()
+{
+    CALL_IN("");
+
+    bool malformed = false;
+    while (!malformed)
+    {
+        // As much as fits (there is always room for a frame after the
+        // incomplete one kept below)
+        const qint64 num_read = m_Socket -> read(m_Input.data() + m_InputSize,
+            INPUT_BUFFER_SIZE - m_InputSize);
+        if (num_read <= 0)
+        {
+            break;
+        }
+        m_InputSize += int(num_read);
+
+        // Complete messages
+        int offset = 0;
+        while (true)
+        {
+            const int frame_size = ServerProtocol::GetFrameSize(
+                m_Input.constData() + offset, m_InputSize - offset);
+            if (frame_size == 0)
+            {
+                break;
+            }
+            if (frame_size < 0 ||
+                !HandleMessage(m_Input.constData() + offset, frame_size))
+            {
+                AsyncMessageLogger::Error(CALL_METHOD,
+                    tr("Connection %1 sent a malformed message; closing it.")
+                        .arg(QString::number(m_ID)));
+                malformed = true;
+                break;
+            }
+            offset += frame_size;
+        }
+
+        // Keep the start of an incomplete message
+        if (offset > 0)
+        {
+            m_InputSize -= offset;
+            memmove(m_Input.data(), m_Input.constData() + offset,
+                size_t(m_InputSize));
+        }
+    }
+
+    // Can't tell where the next message starts
+    if (malformed)
+    {
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_Malformed, SessionPool::INVALID_ID);
+    }
+
+    // All answers at once
+    if (!m_Output.isEmpty())
+    {
+        ServerProtocol::Send(m_Socket, m_Output);
+    }
+
+    // Answers are still written before the connection closes
+    if (malformed)
+    {
+        m_InputSize = 0;
+        m_Socket -> close();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Answer a message
+bool ServerConnection::HandleMessage(const char * mcpFrame, const int mcSize)
+{
+    CALL_IN(QString("mcpFrame=%1, mcSize=%2")
+        .arg(mcpFrame ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    const char * payload = mcpFrame + ServerProtocol::HEADER_SIZE;
+    const int payload_size = mcSize - ServerProtocol::HEADER_SIZE;
+    const int type = ServerProtocol::ReadUInt8(mcpFrame + 2);
+    bool success = true;
+    switch (type)
+    {
+    case ServerProtocol::Message_NewGame:
+        success = HandleNewGame(payload, payload_size);
+        break;
+
+    case ServerProtocol::Message_Guess:
+        success = HandleGuess(payload, payload_size);
+        break;
+
+    case ServerProtocol::Message_EndGame:
+        success = HandleEndGame(payload, payload_size);
+        break;
+
+    default:
+    {
+        // Framing is still fine, so just tell the client
+        const QString reason =
+            tr("Connection %1 sent an unknown message (type %2).")
+                .arg(QString::number(m_ID),
+                     QString::number(type));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_UnknownMessage, SessionPool::INVALID_ID);
+        CALL_OUT(reason);
+        return true;
+    }
+    }
+
+    CALL_OUT("");
+    return success;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Answer a NewGame message
+bool ServerConnection::HandleNewGame(const char * mcpPayload,
+    const int mcSize)
+{
+    CALL_IN(QString("mcpPayload=%1, mcSize=%2")
+        .arg(mcpPayload ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    if (mcSize != 18)
+    {
+        CALL_OUT("");
+        return false;
+    }
+    const int num_boards = ServerProtocol::ReadUInt8(mcpPayload);
+    int max_tries = ServerProtocol::ReadUInt8(mcpPayload + 1);
+    const quint64 seed = ServerProtocol::ReadUInt64(mcpPayload + 2);
+    const quint64 game_index = ServerProtocol::ReadUInt64(mcpPayload + 10);
+
+    // Check settings
+    if (num_boards < 1 ||
+        num_boards > GameSession::MAXIMUM_NUMBER_OF_BOARDS ||
+        max_tries > GameSession::MAXIMUM_NUMBER_OF_TRIES)
+    {
+        const QString reason = tr("Connection %1 asked for a game with "
+            "invalid settings (%2 boards, %3 tries).")
+            .arg(QString::number(m_ID),
+                 QString::number(num_boards),
+                 QString::number(max_tries));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_InvalidSettings, SessionPool::INVALID_ID);
+        CALL_OUT(reason);
+        return true;
+    }
+    if (max_tries == 0)
+    {
+        max_tries = num_boards + 5;
+    }
+
+    // Answers: consecutive games of the seeded sequence, one per board
+    quint32 answer_ids[GameSession::MAXIMUM_NUMBER_OF_BOARDS];
+    for (int board = 0;
+         board < num_boards;
+         board++)
+    {
+        answer_ids[board] = m_Words -> GetWordIDForGame(seed,
+            game_index * quint64(num_boards) + quint64(board));
+        if (answer_ids[board] == AllWords::INVALID_ID)
+        {
+            const QString reason =
+                tr("No words for a game of connection %1.")
+                    .arg(QString::number(m_ID));
+            AsyncMessageLogger::Error(CALL_METHOD,
+                reason);
+            ServerProtocol::WriteError(m_Output,
+                ServerProtocol::Error_NoWords, SessionPool::INVALID_ID);
+            CALL_OUT(reason);
+            return true;
+        }
+    }
+
+    // Session
+    SessionPool & pool = m_Server -> GetSessionPool();
+    const quint32 session_id = pool.Allocate(m_ID);
+    if (session_id == SessionPool::INVALID_ID)
+    {
+        const QString reason =
+            tr("No session left for a game of connection %1.")
+                .arg(QString::number(m_ID));
+        AsyncMessageLogger::Error(CALL_METHOD,
+            reason);
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_ServerFull, SessionPool::INVALID_ID);
+        CALL_OUT(reason);
+        return true;
+    }
+    GameSession * session = pool.GetSession(session_id, m_ID);
+    session -> SetAvoidDuplicateLetters(
+        m_Words -> GetAvoidDuplicateLetters());
+    session -> SetMaximumNumberOfTries(max_tries);
+    if (!session -> Start(answer_ids, num_boards))
+    {
+        // The session logged why
+        pool.Release(session_id);
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_NoWords, SessionPool::INVALID_ID);
+        CALL_OUT("");
+        return true;
+    }
+    m_Sessions << session_id;
+    m_Server -> GameStarted();
+
+    ServerProtocol::WriteGameStarted(m_Output, session_id,
+        session -> GetWordLength(), num_boards, max_tries);
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Answer a Guess message
+bool ServerConnection::HandleGuess(const char * mcpPayload, const int mcSize)
+{
+    CALL_IN(QString("mcpPayload=%1, mcSize=%2")
+        .arg(mcpPayload ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    if (mcSize < 5 ||
+        mcSize != 5 + ServerProtocol::ReadUInt8(mcpPayload + 4))
+    {
+        CALL_OUT("");
+        return false;
+    }
+    const quint32 session_id = ServerProtocol::ReadUInt32(mcpPayload);
+    const int length = mcSize - 5;
+    GameSession * session =
+        m_Server -> GetSessionPool().GetSession(session_id, m_ID);
+    if (!session)
+    {
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_UnknownSession, session_id);
+        CALL_OUT("");
+        return true;
+    }
+
+    // Try the word (refused as incomplete if the length is wrong)
+    GameSession::SubmitResult result;
+    quint8 letters[GameSession::MAXIMUM_WORD_LENGTH];
+    if (session -> IsFinished())
+    {
+        result = GameSession::Submit_Finished;
+    } else if (length != session -> GetWordLength())
+    {
+        result = GameSession::Submit_Incomplete;
+    } else if (!AllWords::EncodeWord(mcpPayload + 5, length, letters))
+    {
+        result = GameSession::Submit_UnknownWord;
+    } else
+    {
+        result = session -> Submit(letters);
+    }
+    m_Server -> GuessHandled();
+
+    // Codes of an accepted try on every board
+    quint32 codes[GameSession::MAXIMUM_NUMBER_OF_BOARDS];
+    int num_codes = 0;
+    if (result == GameSession::Submit_Accepted ||
+        result == GameSession::Submit_Solved ||
+        result == GameSession::Submit_OutOfTries)
+    {
+        const int try_index = session -> GetNumberOfTries() - 1;
+        num_codes = session -> GetNumberOfBoards();
+        for (int board = 0;
+             board < num_codes;
+             board++)
+        {
+            codes[board] = session -> GetNumberOfTries(board) <= try_index ?
+                ServerProtocol::NO_CODE :
+                session -> GetTryCode(board, try_index);
+        }
+    }
+
+    ServerProtocol::WriteFeedback(m_Output, session_id, int(result),
+        session -> GetNumberOfTries(), codes, num_codes);
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Answer an EndGame message
+bool ServerConnection::HandleEndGame(const char * mcpPayload,
+    const int mcSize)
+{
+    CALL_IN(QString("mcpPayload=%1, mcSize=%2")
+        .arg(mcpPayload ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    if (mcSize != 4)
+    {
+        CALL_OUT("");
+        return false;
+    }
+    const quint32 session_id = ServerProtocol::ReadUInt32(mcpPayload);
+    SessionPool & pool = m_Server -> GetSessionPool();
+    const GameSession * session = pool.GetSession(session_id, m_ID);
+    if (!session)
+    {
+        ServerProtocol::WriteError(m_Output,
+            ServerProtocol::Error_UnknownSession, session_id);
+        CALL_OUT("");
+        return true;
+    }
+
+    // Answers are back to back
+    ServerProtocol::WriteGameEnded(m_Output, session_id,
+        session -> GetAnswer(0), session -> GetWordLength(),
+        session -> GetNumberOfBoards());
+    pool.Release(session_id);
+    m_Sessions.removeOne(session_id);
+
+    CALL_OUT("");
+    return true;
+}
@@ -0,0 +1,93 @@
+// ServerConnection.h
+// Class definition
+
+#ifndef SERVERCONNECTION_H
+#define SERVERCONNECTION_H
+
+// Project includes
+#include "AllWords.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QObject>
+
+// Forward declarations
+class GameServer;
+
+
+
+// Class definition
+class ServerConnection
+    : public QObject
+{
+    // One client of a GameServer (on TCP or a local socket): reads the
+    // messages it sends (see ServerProtocol), plays its games in sessions
+    // of the server's pool, and answers. Messages are parsed in place from
+    // a fixed input buffer and all answers to what was read are written
+    // at once, so handling a guess does not allocate. The connection ends
+    // its sessions and deletes itself (and the socket) when the client
+    // disconnects; malformed data from the client closes the connection.
+
+    Q_OBJECT
+
+
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor (takes over the socket; the server is the parent)
+    ServerConnection(GameServer * mpServer, QIODevice * mpSocket,
+        const quint32 mcID);
+
+    // Destructor
+    virtual ~ServerConnection();
+
+private slots:
+    // Client disconnected
+    void Disconnected();
+
+private:
+    // Server and socket
+    GameServer * m_Server;
+    QIODevice * m_Socket;
+
+    // ID (owner of the sessions in the pool)
+    quint32 m_ID;
+
+    // Dictionary (shared by all connections, and only read)
+    const AllWords * m_Words;
+
+
+
+    // =============================================================== Messages
+public:
+    // Size of the input buffer (at least one frame)
+    static const int INPUT_BUFFER_SIZE;
+
+private slots:
+    // Read and answer all complete messages
+    void ReadMessages();
+
+private:
+    // Answer a message (a complete frame); returns false if it is
+    // malformed
+    bool HandleMessage(const char * mcpFrame, const int mcSize);
+
+    // Answer messages (payload only)
+    bool HandleNewGame(const char * mcpPayload, const int mcSize);
+    bool HandleGuess(const char * mcpPayload, const int mcSize);
+    bool HandleEndGame(const char * mcpPayload, const int mcSize);
+
+    // Received data not handled yet (the first m_InputSize bytes)
+    QByteArray m_Input;
+    int m_InputSize;
+
+    // Answers not written yet
+    QByteArray m_Output;
+
+    // Sessions of this client
+    QList < quint32 > m_Sessions;
+};
+
+#endif
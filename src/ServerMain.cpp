@@ -0,0 +1,108 @@
+// ServerMain.cpp
+// Hosts GuessWord games for clients (e.g. kiosks) on TCP and/or a local
+// socket (see GameServer and ServerProtocol), until it is killed.
+//
+// Usage: GuessWordServer [--address A] [--port N] [--local NAME]
+//     [--length N] [--sessions N] [--report N]
+
+// Project includes
+#include "AllWords.h"
+#include "AsyncMessageLogger.h"
+#include "GameServer.h"
+#include "SessionPool.h"
+
+// Qt includes
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStringList>
+#include <QTimer>
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    // Same name as the GUI, so learned words are shared
+    QCoreApplication app(mNumParameters, mpParameter);
+    QCoreApplication::setApplicationName("GuessWord");
+
+    // Command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Hosts GuessWord games for clients.");
+    parser.addHelpOption();
+    const QCommandLineOption address_option("address",
+        "Address to listen on for TCP.", "A", "127.0.0.1");
+    const QCommandLineOption port_option("port",
+        "TCP port (none if 0).", "N", "0");
+    const QCommandLineOption local_option("local",
+        "Local socket name (none if empty).", "name");
+    const QCommandLineOption length_option("length", "Word length.", "N",
+        "5");
+    const QCommandLineOption sessions_option("sessions",
+        "Most sessions at the same time.", "N",
+        QString::number(SessionPool::MAXIMUM_NUMBER_OF_SESSIONS));
+    const QCommandLineOption report_option("report",
+        "Print statistics every N seconds (never if 0).", "N", "0");
+    parser.addOptions({ address_option, port_option, local_option,
+        length_option, sessions_option, report_option });
+    parser.process(app);
+
+    // Dictionary: settings are made here, then it is only read
+    AllWords * aw = AllWords::Instance();
+    aw -> SetWordSize(parser.value(length_option).toInt());
+
+    // Listen
+    GameServer server;
+    server.SetMaximumNumberOfSessions(
+        parser.value(sessions_option).toInt());
+    const quint16 port = quint16(parser.value(port_option).toUInt());
+    const QString local_name = parser.value(local_option);
+    if (port == 0 &&
+        local_name.isEmpty())
+    {
+        qDebug().noquote() << "Need a TCP port or a local socket name.";
+        return 1;
+    }
+    if (port != 0)
+    {
+        if (!server.ListenTcp(parser.value(address_option), port))
+        {
+            return 1;
+        }
+        qDebug().noquote() << QString("Listening on %1 port %2")
+            .arg(parser.value(address_option),
+                 QString::number(server.GetTcpPort()));
+    }
+    if (!local_name.isEmpty())
+    {
+        if (!server.ListenLocal(local_name))
+        {
+            return 1;
+        }
+        qDebug().noquote() << QString("Listening on local socket \"%1\"")
+            .arg(local_name);
+    }
+
+    // Statistics
+    QTimer report_timer;
+    const int report_interval = parser.value(report_option).toInt();
+    if (report_interval > 0)
+    {
+        QObject::connect(&report_timer, SIGNAL(timeout()),
+            &server, SLOT(PrintReport()));
+        report_timer.start(report_interval * 1000);
+    }
+
+    // Serve (requests refused by a connection are logged in the
+    // background)
+    AsyncMessageLogger::Start();
+    const int result = app.exec();
+
+    // Errors still queued
+    AsyncMessageLogger::Stop();
+
+    // Done here
+    return result;
+}
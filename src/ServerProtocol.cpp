@@ -0,0 +1,375 @@
+// ServerProtocol.cpp
+// Class definition
+
+// Project includes
+#include "ServerProtocol.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+#include <QTcpSocket>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+ServerProtocol::ServerProtocol()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Messages
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bytes before the payload
+const int ServerProtocol::HEADER_SIZE = 3;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Largest frame
+const int ServerProtocol::MAXIMUM_FRAME_SIZE = 1024;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Code of a board that was solved before the guess
+const quint32 ServerProtocol::NO_CODE = 0xffffffff;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of the first frame in a buffer
+int ServerProtocol::GetFrameSize(const char * mcpData, const int mcSize)
+{
+    CALL_IN(QString("mcpData=%1, mcSize=%2")
+        .arg(mcpData ? "..." : "nullptr",
+             QString::number(mcSize)));
+
+    // Size field
+    if (mcSize < 2)
+    {
+        CALL_OUT("");
+        return 0;
+    }
+    const int frame_size = 2 + qFromLittleEndian < quint16 >(mcpData);
+
+    // Needs a type, and must not be too large
+    if (frame_size < HEADER_SIZE ||
+        frame_size > MAXIMUM_FRAME_SIZE)
+    {
+        CALL_OUT("");
+        return -1;
+    }
+
+    CALL_OUT("");
+    return frame_size <= mcSize ? frame_size : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a NewGame message
+void ServerProtocol::WriteNewGame(QByteArray & mrBuffer,
+    const int mcNumberOfBoards, const int mcMaximumNumberOfTries,
+    const quint64 mcSeed, const quint64 mcGameIndex)
+{
+    CALL_IN(QString("mrBuffer=..., mcNumberOfBoards=%1, "
+        "mcMaximumNumberOfTries=%2, mcSeed=%3, mcGameIndex=%4")
+        .arg(QString::number(mcNumberOfBoards),
+             QString::number(mcMaximumNumberOfTries),
+             QString::number(mcSeed),
+             QString::number(mcGameIndex)));
+
+    const int start = BeginFrame(mrBuffer, Message_NewGame);
+    AppendUInt8(mrBuffer, quint8(mcNumberOfBoards));
+    AppendUInt8(mrBuffer, quint8(mcMaximumNumberOfTries));
+    AppendUInt64(mrBuffer, mcSeed);
+    AppendUInt64(mrBuffer, mcGameIndex);
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a Guess message
+void ServerProtocol::WriteGuess(QByteArray & mrBuffer,
+    const quint32 mcSessionID, const quint8 * mcpLetters, const int mcLength)
+{
+    CALL_IN(QString("mrBuffer=..., mcSessionID=%1, mcpLetters=%2, mcLength=%3")
+        .arg(QString::number(mcSessionID),
+             mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    const int start = BeginFrame(mrBuffer, Message_Guess);
+    AppendUInt32(mrBuffer, mcSessionID);
+    AppendUInt8(mrBuffer, quint8(mcLength));
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        AppendUInt8(mrBuffer, quint8('a' + mcpLetters[index]));
+    }
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write an EndGame message
+void ServerProtocol::WriteEndGame(QByteArray & mrBuffer,
+    const quint32 mcSessionID)
+{
+    CALL_IN(QString("mrBuffer=..., mcSessionID=%1")
+        .arg(QString::number(mcSessionID)));
+
+    const int start = BeginFrame(mrBuffer, Message_EndGame);
+    AppendUInt32(mrBuffer, mcSessionID);
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a GameStarted message
+void ServerProtocol::WriteGameStarted(QByteArray & mrBuffer,
+    const quint32 mcSessionID, const int mcWordLength,
+    const int mcNumberOfBoards, const int mcMaximumNumberOfTries)
+{
+    CALL_IN(QString("mrBuffer=..., mcSessionID=%1, mcWordLength=%2, "
+        "mcNumberOfBoards=%3, mcMaximumNumberOfTries=%4")
+        .arg(QString::number(mcSessionID),
+             QString::number(mcWordLength),
+             QString::number(mcNumberOfBoards),
+             QString::number(mcMaximumNumberOfTries)));
+
+    const int start = BeginFrame(mrBuffer, Message_GameStarted);
+    AppendUInt32(mrBuffer, mcSessionID);
+    AppendUInt8(mrBuffer, quint8(mcWordLength));
+    AppendUInt8(mrBuffer, quint8(mcNumberOfBoards));
+    AppendUInt8(mrBuffer, quint8(mcMaximumNumberOfTries));
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a Feedback message
+void ServerProtocol::WriteFeedback(QByteArray & mrBuffer,
+    const quint32 mcSessionID, const int mcResult,
+    const int mcNumberOfTries, const quint32 * mcpCodes,
+    const int mcNumberOfCodes)
+{
+    CALL_IN(QString("mrBuffer=..., mcSessionID=%1, mcResult=%2, "
+        "mcNumberOfTries=%3, mcpCodes=%4, mcNumberOfCodes=%5")
+        .arg(QString::number(mcSessionID),
+             QString::number(mcResult),
+             QString::number(mcNumberOfTries),
+             mcpCodes ? "..." : "nullptr",
+             QString::number(mcNumberOfCodes)));
+
+    const int start = BeginFrame(mrBuffer, Message_Feedback);
+    AppendUInt32(mrBuffer, mcSessionID);
+    AppendUInt8(mrBuffer, quint8(mcResult));
+    AppendUInt8(mrBuffer, quint8(mcNumberOfTries));
+    AppendUInt8(mrBuffer, quint8(mcNumberOfCodes));
+    for (int index = 0;
+         index < mcNumberOfCodes;
+         index++)
+    {
+        AppendUInt32(mrBuffer, mcpCodes[index]);
+    }
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write a GameEnded message
+void ServerProtocol::WriteGameEnded(QByteArray & mrBuffer,
+    const quint32 mcSessionID, const quint8 * mcpAnswers,
+    const int mcWordLength, const int mcNumberOfBoards)
+{
+    CALL_IN(QString("mrBuffer=..., mcSessionID=%1, mcpAnswers=%2, "
+        "mcWordLength=%3, mcNumberOfBoards=%4")
+        .arg(QString::number(mcSessionID),
+             mcpAnswers ? "..." : "nullptr",
+             QString::number(mcWordLength),
+             QString::number(mcNumberOfBoards)));
+
+    const int start = BeginFrame(mrBuffer, Message_GameEnded);
+    AppendUInt32(mrBuffer, mcSessionID);
+    AppendUInt8(mrBuffer, quint8(mcWordLength));
+    AppendUInt8(mrBuffer, quint8(mcNumberOfBoards));
+    for (int index = 0;
+         index < mcWordLength * mcNumberOfBoards;
+         index++)
+    {
+        AppendUInt8(mrBuffer, quint8('a' + mcpAnswers[index]));
+    }
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write an Error message
+void ServerProtocol::WriteError(QByteArray & mrBuffer, const int mcError,
+    const quint32 mcSessionID)
+{
+    CALL_IN(QString("mrBuffer=..., mcError=%1, mcSessionID=%2")
+        .arg(QString::number(mcError),
+             QString::number(mcSessionID)));
+
+    const int start = BeginFrame(mrBuffer, Message_Error);
+    AppendUInt8(mrBuffer, quint8(mcError));
+    AppendUInt32(mrBuffer, mcSessionID);
+    EndFrame(mrBuffer, start);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Start a frame
+int ServerProtocol::BeginFrame(QByteArray & mrBuffer, const int mcType)
+{
+    CALL_IN(QString("mrBuffer=..., mcType=%1")
+        .arg(QString::number(mcType)));
+
+    // Size is set by EndFrame()
+    const int start = int(mrBuffer.size());
+    mrBuffer.append(2, '\0');
+    AppendUInt8(mrBuffer, quint8(mcType));
+
+    CALL_OUT("");
+    return start;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Finish a frame
+void ServerProtocol::EndFrame(QByteArray & mrBuffer, const int mcStart)
+{
+    CALL_IN(QString("mrBuffer=..., mcStart=%1")
+        .arg(QString::number(mcStart)));
+
+    const quint16 size = quint16(mrBuffer.size() - mcStart - 2);
+    qToLittleEndian < quint16 >(size, mrBuffer.data() + mcStart);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Append a byte
+void ServerProtocol::AppendUInt8(QByteArray & mrBuffer, const quint8 mcValue)
+{
+    CALL_IN(QString("mrBuffer=..., mcValue=%1")
+        .arg(QString::number(mcValue)));
+
+    mrBuffer.append(char(mcValue));
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Append a 32 bit number
+void ServerProtocol::AppendUInt32(QByteArray & mrBuffer,
+    const quint32 mcValue)
+{
+    CALL_IN(QString("mrBuffer=..., mcValue=%1")
+        .arg(QString::number(mcValue)));
+
+    char bytes[4];
+    qToLittleEndian < quint32 >(mcValue, bytes);
+    mrBuffer.append(bytes, 4);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Append a 64 bit number
+void ServerProtocol::AppendUInt64(QByteArray & mrBuffer,
+    const quint64 mcValue)
+{
+    CALL_IN(QString("mrBuffer=..., mcValue=%1")
+        .arg(QString::number(mcValue)));
+
+    char bytes[8];
+    qToLittleEndian < quint64 >(mcValue, bytes);
+    mrBuffer.append(bytes, 8);
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Sockets
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Set up a new connection's socket for messages
+void ServerProtocol::SetUpSocket(QIODevice * mpSocket)
+{
+    CALL_IN(QString("mpSocket=%1")
+        .arg(mpSocket ? "..." : "nullptr"));
+
+    // Messages are small and latency matters; don't wait for more data
+    QTcpSocket * tcp_socket = qobject_cast < QTcpSocket * >(mpSocket);
+    if (tcp_socket)
+    {
+        tcp_socket -> setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write the messages in a buffer to a socket and empty the buffer
+void ServerProtocol::Send(QIODevice * mpSocket, QByteArray & mrBuffer)
+{
+    CALL_IN(QString("mpSocket=%1, mrBuffer=...")
+        .arg(mpSocket ? "..." : "nullptr"));
+
+    mpSocket -> write(mrBuffer.constData(), mrBuffer.size());
+
+    // resize() keeps the buffer's capacity
+    mrBuffer.resize(0);
+
+    CALL_OUT("");
+}
@@ -0,0 +1,148 @@
+// ServerProtocol.h
+// Class definition
+
+#ifndef SERVERPROTOCOL_H
+#define SERVERPROTOCOL_H
+
+// Qt includes
+#include <QByteArray>
+#include <QIODevice>
+#include <QtEndian>
+#include <QtGlobal>
+
+
+
+// Class definition
+class ServerProtocol
+{
+    // Wire protocol between GameServer and its clients (e.g. kiosks, or
+    // LoadGenerator). Every message is a frame
+    //
+    //     u16 size (of everything after it), u8 type, payload
+    //
+    // with all numbers little endian and words as ASCII letters. Clients
+    // send
+    //
+    //     NewGame   u8 boards, u8 tries (0 for boards + 5), u64 seed,
+    //               u64 game index
+    //     Guess     u32 session, u8 length, letters
+    //     EndGame   u32 session
+    //
+    // and the server answers every one of them, in order, with
+    //
+    //     GameStarted  u32 session, u8 word length, u8 boards, u8 tries
+    //     Feedback     u32 session, u8 result (a GameSession::SubmitResult),
+    //                  u8 tries so far, u8 boards, u32 code per board (see
+    //                  Feedback; NO_CODE for boards solved before; no
+    //                  boards if the guess was refused)
+    //     GameEnded    u32 session, u8 word length, u8 boards, answers
+    //     Error        u8 error, u32 session (0 if none)
+    //
+    // Answers of a game follow from the seed and game index (see
+    // AllWords::GetWordIDForGame()), so kiosks can play the same puzzles.
+    // A client may have several sessions at once; they end with EndGame
+    // or when the client disconnects.
+
+    // ============================================================== Lifecycle
+private:
+    // Constructor (static methods only)
+    ServerProtocol();
+
+
+
+    // =============================================================== Messages
+public:
+    // Message types
+    enum MessageType {
+        Message_NewGame = 0x01,
+        Message_Guess = 0x02,
+        Message_EndGame = 0x03,
+        Message_GameStarted = 0x81,
+        Message_Feedback = 0x82,
+        Message_GameEnded = 0x83,
+        Message_Error = 0xff
+    };
+
+    // Errors
+    enum Error {
+        Error_Malformed = 1,
+        Error_UnknownMessage,
+        Error_UnknownSession,
+        Error_ServerFull,
+        Error_InvalidSettings,
+        Error_NoWords
+    };
+
+    // Bytes before the payload (size and type)
+    static const int HEADER_SIZE;
+
+    // Largest frame (header included)
+    static const int MAXIMUM_FRAME_SIZE;
+
+    // Code of a board that was solved before the guess
+    static const quint32 NO_CODE;
+
+    // Size of the first frame in a buffer (header included): 0 if it is
+    // not complete yet, -1 if it is malformed
+    static int GetFrameSize(const char * mcpData, const int mcSize);
+
+    // Write messages (appended to a buffer)
+    static void WriteNewGame(QByteArray & mrBuffer,
+        const int mcNumberOfBoards, const int mcMaximumNumberOfTries,
+        const quint64 mcSeed, const quint64 mcGameIndex);
+    static void WriteGuess(QByteArray & mrBuffer, const quint32 mcSessionID,
+        const quint8 * mcpLetters, const int mcLength);
+    static void WriteEndGame(QByteArray & mrBuffer,
+        const quint32 mcSessionID);
+    static void WriteGameStarted(QByteArray & mrBuffer,
+        const quint32 mcSessionID, const int mcWordLength,
+        const int mcNumberOfBoards, const int mcMaximumNumberOfTries);
+    static void WriteFeedback(QByteArray & mrBuffer,
+        const quint32 mcSessionID, const int mcResult,
+        const int mcNumberOfTries, const quint32 * mcpCodes,
+        const int mcNumberOfCodes);
+    static void WriteGameEnded(QByteArray & mrBuffer,
+        const quint32 mcSessionID, const quint8 * mcpAnswers,
+        const int mcWordLength, const int mcNumberOfBoards);
+    static void WriteError(QByteArray & mrBuffer, const int mcError,
+        const quint32 mcSessionID);
+
+    // Read numbers (no bounds checks; see GetFrameSize()). These are the
+    // innermost primitive of every message read and are not traced.
+    static inline quint8 ReadUInt8(const char * mcpData)
+    {
+        return quint8(*mcpData);
+    }
+    static inline quint32 ReadUInt32(const char * mcpData)
+    {
+        return qFromLittleEndian < quint32 >(mcpData);
+    }
+    static inline quint64 ReadUInt64(const char * mcpData)
+    {
+        return qFromLittleEndian < quint64 >(mcpData);
+    }
+
+private:
+    // Start a frame; returns where it starts
+    static int BeginFrame(QByteArray & mrBuffer, const int mcType);
+
+    // Finish a frame (sets its size)
+    static void EndFrame(QByteArray & mrBuffer, const int mcStart);
+
+    // Append numbers
+    static void AppendUInt8(QByteArray & mrBuffer, const quint8 mcValue);
+    static void AppendUInt32(QByteArray & mrBuffer, const quint32 mcValue);
+    static void AppendUInt64(QByteArray & mrBuffer, const quint64 mcValue);
+
+
+
+    // ================================================================ Sockets
+public:
+    // Set up a new connection's socket (TCP or local) for messages
+    static void SetUpSocket(QIODevice * mpSocket);
+
+    // Write the messages in a buffer to a socket and empty the buffer
+    static void Send(QIODevice * mpSocket, QByteArray & mrBuffer);
+};
+
+#endif
@@ -0,0 +1,241 @@
+// SessionPool.cpp
+// Class definition
+
+// Project includes
+#include "SessionPool.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QString>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+SessionPool::SessionPool()
+{
+    CALL_IN("");
+
+    m_NumberOfSessions = 0;
+    m_MaximumNumberOfSessions = MAXIMUM_NUMBER_OF_SESSIONS;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+SessionPool::~SessionPool()
+{
+    CALL_IN("");
+
+    for (GameSession * chunk : std::as_const(m_Chunks))
+    {
+        delete [] chunk;
+    }
+
+    CALL_OUT("");
+}
+
+
+
+// =================================================================== Sessions
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sessions per chunk
+const int SessionPool::CHUNK_SIZE = 256;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most sessions
+const int SessionPool::MAXIMUM_NUMBER_OF_SESSIONS = 0xffffff;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// No session
+const quint32 SessionPool::INVALID_ID = 0;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most sessions at the same time
+void SessionPool::SetMaximumNumberOfSessions(
+    const int mcMaximumNumberOfSessions)
+{
+    CALL_IN(QString("mcMaximumNumberOfSessions=%1")
+        .arg(QString::number(mcMaximumNumberOfSessions)));
+
+    // Sessions in use stay
+    m_MaximumNumberOfSessions =
+        qBound(1, mcMaximumNumberOfSessions, MAXIMUM_NUMBER_OF_SESSIONS);
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most sessions at the same time
+int SessionPool::GetMaximumNumberOfSessions() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_MaximumNumberOfSessions;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// New session for an owner
+quint32 SessionPool::Allocate(const quint32 mcOwner)
+{
+    CALL_IN(QString("mcOwner=%1")
+        .arg(QString::number(mcOwner)));
+
+    // Full (or no owner)
+    if (mcOwner == 0 ||
+        m_NumberOfSessions >= m_MaximumNumberOfSessions)
+    {
+        CALL_OUT("");
+        return INVALID_ID;
+    }
+
+    // New chunk if no slot is free
+    if (m_FreeSlots.isEmpty())
+    {
+        const int first_slot = int(m_Owners.size());
+        const int num_slots =
+            qMin(CHUNK_SIZE, MAXIMUM_NUMBER_OF_SESSIONS - first_slot);
+        if (num_slots <= 0)
+        {
+            CALL_OUT("");
+            return INVALID_ID;
+        }
+        m_Chunks << new GameSession[CHUNK_SIZE];
+        m_Owners.resize(first_slot + num_slots, 0);
+        m_Generations.resize(first_slot + num_slots, 1);
+        m_FreeSlots.reserve(m_Owners.size());
+
+        // Lowest slot first
+        for (int slot = first_slot + num_slots - 1;
+             slot >= first_slot;
+             slot--)
+        {
+            m_FreeSlots << slot;
+        }
+    }
+
+    // Most recently freed slot (likely still in the cache)
+    const int slot = m_FreeSlots.takeLast();
+    m_Owners[slot] = mcOwner;
+    m_NumberOfSessions++;
+
+    CALL_OUT("");
+    return (quint32(m_Generations[slot]) << 24) | quint32(slot);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// End a session
+void SessionPool::Release(const quint32 mcSessionID)
+{
+    CALL_IN(QString("mcSessionID=%1")
+        .arg(QString::number(mcSessionID)));
+
+    const int slot = GetSlot(mcSessionID);
+    if (slot < 0)
+    {
+        CALL_OUT("");
+        return;
+    }
+
+    // Next use of the slot has another ID (generation 0 is skipped, so no
+    // ID is 0)
+    m_Owners[slot] = 0;
+    m_Generations[slot] = m_Generations[slot] == 0xff ?
+        1 : m_Generations[slot] + 1;
+    m_FreeSlots << slot;
+    m_NumberOfSessions--;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Session of an owner
+GameSession * SessionPool::GetSession(const quint32 mcSessionID,
+    const quint32 mcOwner) const
+{
+    CALL_IN(QString("mcSessionID=%1, mcOwner=%2")
+        .arg(QString::number(mcSessionID),
+             QString::number(mcOwner)));
+
+    const int slot = GetSlot(mcSessionID);
+    if (slot < 0 ||
+        m_Owners[slot] != mcOwner)
+    {
+        CALL_OUT("");
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return &m_Chunks[slot / CHUNK_SIZE][slot % CHUNK_SIZE];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sessions in use
+int SessionPool::GetNumberOfSessions() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfSessions;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Slots allocated so far
+int SessionPool::GetNumberOfSlots() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return int(m_Owners.size());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Slot of a session ID
+int SessionPool::GetSlot(const quint32 mcSessionID) const
+{
+    CALL_IN(QString("mcSessionID=%1")
+        .arg(QString::number(mcSessionID)));
+
+    const int slot = int(mcSessionID & 0xffffff);
+    if (slot >= m_Owners.size() ||
+        m_Owners[slot] == 0 ||
+        m_Generations[slot] != quint8(mcSessionID >> 24))
+    {
+        CALL_OUT("");
+        return -1;
+    }
+
+    CALL_OUT("");
+    return slot;
+}
@@ -0,0 +1,85 @@
+// SessionPool.h
+// Class definition
+
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+// Project includes
+#include "GameSession.h"
+
+// Qt includes
+#include <QList>
+
+
+
+// Class definition
+class SessionPool
+{
+    // Game sessions of the server. Sessions are allocated in chunks of
+    // CHUNK_SIZE and reused after a game ends, so after warming up, starting
+    // and ending games never allocate, and a session (a GameSession, one
+    // block of memory) stays where it is. A session ID names a slot and how
+    // often the slot was used before (in the top 8 bits), so IDs of ended
+    // sessions do not name a new session right away; ID 0 is never used.
+    // Every session belongs to an owner (a connection), and only the owner
+    // can get it.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    SessionPool();
+
+    // Destructor
+    ~SessionPool();
+
+
+
+    // =============================================================== Sessions
+public:
+    // Sessions per chunk
+    static const int CHUNK_SIZE;
+
+    // Most sessions (IDs have 24 bits for the slot)
+    static const int MAXIMUM_NUMBER_OF_SESSIONS;
+
+    // No session
+    static const quint32 INVALID_ID;
+
+    // Most sessions at the same time
+    void SetMaximumNumberOfSessions(const int mcMaximumNumberOfSessions);
+    int GetMaximumNumberOfSessions() const;
+
+    // New session for an owner (not 0); INVALID_ID if there are too many
+    quint32 Allocate(const quint32 mcOwner);
+
+    // End a session
+    void Release(const quint32 mcSessionID);
+
+    // Session of an owner (nullptr if there is none with this ID)
+    GameSession * GetSession(const quint32 mcSessionID,
+        const quint32 mcOwner) const;
+
+    // Sessions in use, and slots allocated so far
+    int GetNumberOfSessions() const;
+    int GetNumberOfSlots() const;
+
+private:
+    // Slot of a session ID if it is in use (-1 otherwise)
+    int GetSlot(const quint32 mcSessionID) const;
+
+    // Chunks of sessions
+    QList < GameSession * > m_Chunks;
+
+    // Owner (0 if free) and use count of every slot
+    QList < quint32 > m_Owners;
+    QList < quint8 > m_Generations;
+
+    // Free slots (the most recently freed one last)
+    QList < int > m_FreeSlots;
+
+    // Counts
+    int m_NumberOfSessions;
+    int m_MaximumNumberOfSessions;
+};
+
+#endif
@@ -0,0 +1,511 @@
+// Simulation.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "Feedback.h"
+#include "GameSession.h"
+#include "MessageLogger.h"
+#include "ParallelLoop.h"
+#include "Simulation.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+
+// System includes
+#include <memory>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+Simulation::Simulation()
+{
+    CALL_IN("");
+
+    m_WordLength = 5;
+    m_NumberOfGames = 10000;
+    m_MaximumNumberOfGuesses = 6;
+    m_NumberOfThreads = ParallelLoop::GetDefaultNumberOfThreads();
+    m_Seed = 1;
+    m_SetupTime = 0;
+    m_PrepareTime = 0;
+    m_PlayTime = 0;
+    m_PickTime = 0;
+    m_FilterTime = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+Simulation::~Simulation()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ============================================================== Configuration
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word length
+void Simulation::SetWordLength(const int mcWordLength)
+{
+    CALL_IN(QString("mcWordLength=%1")
+        .arg(QString::number(mcWordLength)));
+
+    // Check if word length is valid
+    if (mcWordLength < 1 ||
+        mcWordLength > Feedback::MAXIMUM_WORD_LENGTH)
+    {
+        const QString reason = QObject::tr("Invalid word length %1.")
+            .arg(QString::number(mcWordLength));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_WordLength = mcWordLength;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Word length
+int Simulation::GetWordLength() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_WordLength;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of games
+void Simulation::SetNumberOfGames(const int mcNumberOfGames)
+{
+    CALL_IN(QString("mcNumberOfGames=%1")
+        .arg(QString::number(mcNumberOfGames)));
+
+    // Check if number of games is valid
+    if (mcNumberOfGames < 1)
+    {
+        const QString reason = QObject::tr("Invalid number of games %1.")
+            .arg(QString::number(mcNumberOfGames));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfGames = mcNumberOfGames;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of games
+int Simulation::GetNumberOfGames() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfGames;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Games with more guesses count as failed
+void Simulation::SetMaximumNumberOfGuesses(
+    const int mcMaximumNumberOfGuesses)
+{
+    CALL_IN(QString("mcMaximumNumberOfGuesses=%1")
+        .arg(QString::number(mcMaximumNumberOfGuesses)));
+
+    // Check if number of guesses is valid
+    if (mcMaximumNumberOfGuesses < 1 ||
+        mcMaximumNumberOfGuesses > GameSession::MAXIMUM_NUMBER_OF_TRIES)
+    {
+        const QString reason =
+            QObject::tr("Invalid maximum number of guesses %1.")
+                .arg(QString::number(mcMaximumNumberOfGuesses));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_MaximumNumberOfGuesses = mcMaximumNumberOfGuesses;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Games with more guesses count as failed
+int Simulation::GetMaximumNumberOfGuesses() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_MaximumNumberOfGuesses;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of threads
+void Simulation::SetNumberOfThreads(const int mcNumberOfThreads)
+{
+    CALL_IN(QString("mcNumberOfThreads=%1")
+        .arg(QString::number(mcNumberOfThreads)));
+
+    // Check if number of threads is valid
+    if (mcNumberOfThreads < 1)
+    {
+        const QString reason = QObject::tr("Invalid number of threads %1.")
+            .arg(QString::number(mcNumberOfThreads));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfThreads = mcNumberOfThreads;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of threads
+int Simulation::GetNumberOfThreads() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfThreads;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed for the random number generators
+void Simulation::SetSeed(const quint64 mcSeed)
+{
+    CALL_IN(QString("mcSeed=%1")
+        .arg(QString::number(mcSeed)));
+
+    m_Seed = mcSeed;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Seed for the random number generators
+quint64 Simulation::GetSeed() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Seed;
+}
+
+
+
+// ==================================================================== Running
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Play all games with a strategy
+bool Simulation::Run(const SimulationStrategy & mcrStrategy)
+{
+    CALL_IN(QString("mcrStrategy=%1")
+        .arg(mcrStrategy.GetName()));
+
+    m_StrategyName = mcrStrategy.GetName();
+    m_GuessDistribution =
+        QList < quint64 >(m_MaximumNumberOfGuesses + 1, 0);
+    m_SetupTime = 0;
+    m_PrepareTime = 0;
+    m_PlayTime = 0;
+    m_PickTime = 0;
+    m_FilterTime = 0;
+
+    // Setup: dictionary (loaded on first use)
+    QElapsedTimer phase_timer;
+    phase_timer.start();
+    AllWords * aw = AllWords::Instance();
+    const int length = m_WordLength;
+    const int num_answers = aw -> GetSlabSize(length);
+    if (num_answers == 0)
+    {
+        const QString reason = QObject::tr("No words of length %1.")
+            .arg(QString::number(length));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    const quint8 * answer_letters = aw -> GetSlabLetters(length);
+    m_SetupTime = phase_timer.nsecsElapsed();
+
+    // Prepare: strategy, then one copy per worker
+    phase_timer.restart();
+    std::unique_ptr < SimulationStrategy > prototype(mcrStrategy.Clone());
+    if (!prototype -> Prepare(length))
+    {
+        const QString reason =
+            QObject::tr("Strategy \"%1\" cannot play words of length %2.")
+                .arg(m_StrategyName,
+                     QString::number(length));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return false;
+    }
+    struct Worker
+    {
+        std::unique_ptr < SimulationStrategy > m_Strategy;
+        CandidateFilter m_Filter;
+        GameSession m_Session;
+        QList < quint64 > m_GuessDistribution;
+        qint64 m_PickTime;
+        qint64 m_FilterTime;
+    };
+    QList < Worker * > workers;
+    for (int index = 0;
+         index < m_NumberOfThreads;
+         index++)
+    {
+        Worker * worker = new Worker();
+        worker -> m_Strategy.reset(prototype -> Clone());
+        worker -> m_Filter.Reset(length);
+        worker -> m_GuessDistribution =
+            QList < quint64 >(m_MaximumNumberOfGuesses + 1, 0);
+        worker -> m_PickTime = 0;
+        worker -> m_FilterTime = 0;
+        workers << worker;
+    }
+    m_PrepareTime = phase_timer.nsecsElapsed();
+
+    // Play
+    phase_timer.restart();
+    const int max_guesses = m_MaximumNumberOfGuesses;
+    const quint64 seed = m_Seed;
+    ParallelLoop::Run(m_NumberOfGames, 64, m_NumberOfThreads,
+        [&](const int mcWorker, const int mcFirstGame, const int mcLastGame)
+        {
+            Worker & worker = *workers[mcWorker];
+            QElapsedTimer timer;
+            timer.start();
+            qint64 last_time;
+            for (int game = mcFirstGame;
+                 game < mcLastGame;
+                 game++)
+            {
+                // Answers are a permutation of all words, so no word is
+                // played twice before all were; the strategy gets a random
+                // number stream for this game
+                const quint64 round = quint64(game) / num_answers;
+                const quint8 * answer = answer_letters + length *
+                    RandomStream::Permute(RandomStream::GetKey(seed, round),
+                        quint64(game) % num_answers, num_answers);
+                RandomStream random_stream(seed, quint64(game));
+
+                // Guess until solved or out of guesses
+                worker.m_Filter.Reset(length);
+                worker.m_Session.Start(answer, length);
+                last_time = timer.nsecsElapsed();
+                int num_guesses = max_guesses;
+                for (int guess_index = 0;
+                     guess_index < max_guesses;
+                     guess_index++)
+                {
+                    const quint8 * guess = worker.m_Strategy -> PickGuess(
+                        worker.m_Filter, random_stream);
+                    const qint64 pick_time = timer.nsecsElapsed();
+                    worker.m_PickTime += pick_time - last_time;
+                    const GameSession::SubmitResult result =
+                        worker.m_Session.Submit(guess);
+                    if (result == GameSession::Submit_Solved)
+                    {
+                        num_guesses = guess_index;
+                        break;
+                    }
+                    if (result != GameSession::Submit_Accepted)
+                    {
+                        // Guess was refused; the game counts as failed
+                        break;
+                    }
+                    worker.m_Filter.AddGuess(guess,
+                        worker.m_Session.GetTryCode(0, guess_index));
+                    last_time = timer.nsecsElapsed();
+                    worker.m_FilterTime += last_time - pick_time;
+                }
+                worker.m_GuessDistribution[num_guesses]++;
+            }
+        });
+    m_PlayTime = phase_timer.nsecsElapsed();
+
+    // Add up workers
+    for (Worker * worker : std::as_const(workers))
+    {
+        for (int index = 0;
+             index <= max_guesses;
+             index++)
+        {
+            m_GuessDistribution[index] += worker -> m_GuessDistribution[index];
+        }
+        m_PickTime += worker -> m_PickTime;
+        m_FilterTime += worker -> m_FilterTime;
+    }
+    qDeleteAll(workers);
+
+    CALL_OUT("");
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Games by number of guesses needed
+QList < quint64 > Simulation::GetGuessDistribution() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_GuessDistribution;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Games per second
+double Simulation::GetGamesPerSecond() const
+{
+    CALL_IN("");
+
+    if (m_PlayTime <= 0)
+    {
+        CALL_OUT("");
+        return 0.;
+    }
+
+    CALL_OUT("");
+    return m_NumberOfGames * 1e9 / m_PlayTime;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Summary of the last run
+QString Simulation::GetReport() const
+{
+    CALL_IN("");
+
+    if (m_GuessDistribution.isEmpty())
+    {
+        CALL_OUT("");
+        return QObject::tr("No simulation run.");
+    }
+
+    // Totals
+    quint64 num_games = 0;
+    quint64 num_solved = 0;
+    quint64 total_guesses = 0;
+    for (int index = 0;
+         index < m_GuessDistribution.size();
+         index++)
+    {
+        num_games += m_GuessDistribution[index];
+        if (index < m_GuessDistribution.size() - 1)
+        {
+            num_solved += m_GuessDistribution[index];
+            total_guesses += (index + 1) * m_GuessDistribution[index];
+        }
+    }
+    auto percent = [num_games](const quint64 mcCount)
+    {
+        return QString::number(100. * mcCount / qMax(num_games,
+            quint64(1)), 'f', 2);
+    };
+    auto milliseconds = [](const qint64 mcNanoseconds)
+    {
+        return QString::number(mcNanoseconds / 1e6, 'f', 1);
+    };
+
+    QStringList lines;
+    lines << QObject::tr("Strategy \"%1\", %2 letters, %3 games on %4 "
+        "threads (seed %5)")
+        .arg(m_StrategyName,
+             QString::number(m_WordLength),
+             QString::number(num_games),
+             QString::number(m_NumberOfThreads),
+             QString::number(m_Seed));
+    lines << QObject::tr("Solved: %1 (%2%), mean %3 guesses")
+        .arg(QString::number(num_solved),
+             percent(num_solved),
+             QString::number(double(total_guesses) /
+                qMax(num_solved, quint64(1)), 'f', 3));
+
+    // Distribution
+    for (int index = 0;
+         index < m_GuessDistribution.size();
+         index++)
+    {
+        const quint64 count = m_GuessDistribution[index];
+        const QString label = index < m_GuessDistribution.size() - 1 ?
+            QString::number(index + 1) : QObject::tr("failed");
+        lines << QString("%1 %2 %3% %4")
+            .arg(label.rightJustified(8, ' '),
+                 QString::number(count).rightJustified(12, ' '),
+                 percent(count).rightJustified(6, ' '),
+                 QString(int(50. * count / qMax(num_games, quint64(1))),
+                    '#'));
+    }
+
+    // Throughput and phases
+    lines << QObject::tr("Throughput: %1 games/s")
+        .arg(QString::number(GetGamesPerSecond(), 'f', 1));
+    const qint64 worker_time = qMax(m_PickTime + m_FilterTime, qint64(1));
+    lines << QObject::tr("Phases: setup %1 ms, prepare %2 ms, play %3 ms "
+        "(workers: %4% picking guesses, %5% scoring and filtering)")
+        .arg(milliseconds(m_SetupTime),
+             milliseconds(m_PrepareTime),
+             milliseconds(m_PlayTime),
+             QString::number(100. * m_PickTime / worker_time, 'f', 1),
+             QString::number(100. * m_FilterTime / worker_time, 'f', 1));
+
+    CALL_OUT("");
+    return lines.join("\n");
+}
@@ -0,0 +1,112 @@
+// Simulation.h
+// Class definition
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+// Project includes
+#include "SimulationStrategy.h"
+
+// Qt includes
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+
+
+// Class definition
+class Simulation
+{
+    // Plays many games without a GUI: every game picks an answer from all
+    // words of the word length and lets a strategy guess until it is found
+    // or the maximum number of guesses is used up. Games are played with
+    // GameSession, as in the window. Answers follow a seeded permutation of
+    // the words, so every word is played once before any is played again.
+    // Games run in parallel; each one has its own random number stream,
+    // given by the seed and the game's index, so results do not depend on
+    // the number of threads. The dictionary (AllWords) is only read, never
+    // changed, so used words are not tracked.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    Simulation();
+
+    // Destructor
+    ~Simulation();
+
+
+
+    // ========================================================== Configuration
+public:
+    // Word length
+    void SetWordLength(const int mcWordLength);
+    int GetWordLength() const;
+private:
+    int m_WordLength;
+
+public:
+    // Number of games
+    void SetNumberOfGames(const int mcNumberOfGames);
+    int GetNumberOfGames() const;
+private:
+    int m_NumberOfGames;
+
+public:
+    // Games with more guesses count as failed
+    void SetMaximumNumberOfGuesses(const int mcMaximumNumberOfGuesses);
+    int GetMaximumNumberOfGuesses() const;
+private:
+    int m_MaximumNumberOfGuesses;
+
+public:
+    // Number of threads
+    void SetNumberOfThreads(const int mcNumberOfThreads);
+    int GetNumberOfThreads() const;
+private:
+    int m_NumberOfThreads;
+
+public:
+    // Seed for the random number generators
+    void SetSeed(const quint64 mcSeed);
+    quint64 GetSeed() const;
+private:
+    quint64 m_Seed;
+
+
+
+    // ================================================================ Running
+public:
+    // Play all games with a strategy. Returns false if the strategy cannot
+    // play the word length or there are no words of that length.
+    bool Run(const SimulationStrategy & mcrStrategy);
+
+    // Games by number of guesses needed (index 0: one guess); the last
+    // entry counts failed games
+    QList < quint64 > GetGuessDistribution() const;
+
+    // Games per second (during the play phase)
+    double GetGamesPerSecond() const;
+
+    // Summary of the last run: guess distribution, throughput and time per
+    // phase
+    QString GetReport() const;
+
+private:
+    // Results of the last run
+    QString m_StrategyName;
+    QList < quint64 > m_GuessDistribution;
+
+    // Wall clock time per phase (in nanoseconds): loading the dictionary,
+    // preparing the strategy, playing
+    qint64 m_SetupTime;
+    qint64 m_PrepareTime;
+    qint64 m_PlayTime;
+
+    // Time all workers spent picking guesses and scoring/filtering them
+    // (in nanoseconds)
+    qint64 m_PickTime;
+    qint64 m_FilterTime;
+};
+
+#endif
@@ -0,0 +1,89 @@
+// SimulationMain.cpp
+// Plays many games without a GUI (see Simulation) and prints the guess
+// distribution, throughput and time per phase. Used for tuning the
+// dictionary and difficulty, and as the throughput benchmark.
+//
+// Usage: GuessWordSimulation [--strategy random|greedy|entropy]
+//     [--games N] [--length N] [--guesses N] [--threads N] [--seed N]
+
+// Project includes
+#include "AllWords.h"
+#include "AsyncMessageLogger.h"
+#include "Simulation.h"
+#include "SimulationStrategy.h"
+
+// Qt includes
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStringList>
+
+// System includes
+#include <memory>
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    // Same name as the GUI, so learned words and caches are shared
+    QCoreApplication app(mNumParameters, mpParameter);
+    QCoreApplication::setApplicationName("GuessWord");
+
+    // Command line
+    Simulation simulation;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays GuessWord games without a GUI.");
+    parser.addHelpOption();
+    const QCommandLineOption strategy_option("strategy",
+        QString("Guessing strategy (%1).")
+            .arg(SimulationStrategy::GetNames().join(", ")),
+        "name", "entropy");
+    const QCommandLineOption games_option("games", "Number of games.", "N",
+        QString::number(simulation.GetNumberOfGames()));
+    const QCommandLineOption length_option("length", "Word length.", "N",
+        QString::number(simulation.GetWordLength()));
+    const QCommandLineOption guesses_option("guesses",
+        "Games with more guesses count as failed.", "N",
+        QString::number(simulation.GetMaximumNumberOfGuesses()));
+    const QCommandLineOption threads_option("threads",
+        "Number of threads.", "N",
+        QString::number(simulation.GetNumberOfThreads()));
+    const QCommandLineOption seed_option("seed",
+        "Seed for the random number generators.", "N",
+        QString::number(simulation.GetSeed()));
+    parser.addOptions({ strategy_option, games_option, length_option,
+        guesses_option, threads_option, seed_option });
+    parser.process(app);
+
+    // Settings
+    std::unique_ptr < SimulationStrategy > strategy(
+        SimulationStrategy::Create(parser.value(strategy_option)));
+    if (!strategy)
+    {
+        return 1;
+    }
+    simulation.SetNumberOfGames(parser.value(games_option).toInt());
+    simulation.SetWordLength(parser.value(length_option).toInt());
+    simulation.SetMaximumNumberOfGuesses(
+        parser.value(guesses_option).toInt());
+    simulation.SetNumberOfThreads(parser.value(threads_option).toInt());
+    simulation.SetSeed(parser.value(seed_option).toULongLong());
+
+    // Play (errors from the worker threads are logged in the background)
+    AsyncMessageLogger::Start();
+    const bool success = simulation.Run(*strategy);
+    AsyncMessageLogger::Stop();
+    if (!success)
+    {
+        return 1;
+    }
+    qDebug().noquote() << simulation.GetReport();
+
+    // Nothing learned, but keep the journal consistent
+    AllWords::Instance() -> FlushJournal();
+
+    // Done here
+    return 0;
+}
@@ -0,0 +1,303 @@
+// SimulationStrategy.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "MessageLogger.h"
+#include "SimulationStrategy.h"
+#include "Solver.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QObject>
+
+
+
+// Random valid: any word still consistent with the feedback so far
+class RandomValidStrategy
+    : public SimulationStrategy
+{
+public:
+    SimulationStrategy * Clone() const override
+    {
+        return new RandomValidStrategy(*this);
+    }
+    QString GetName() const override
+    {
+        return "random";
+    }
+    bool Prepare(const int mcWordLength) override
+    {
+        m_WordLength = mcWordLength;
+        return true;
+    }
+    const quint8 * PickGuess(CandidateFilter & mrFilter,
+        RandomStream & mrRandomStream) override
+    {
+        const BitVector & candidates = mrFilter.GetCandidateBits();
+        const int slab_index = candidates.Select(int(
+            mrRandomStream.Bounded(quint32(candidates.GetCount()))));
+        return AllWords::Instance() -> GetSlabLetters(m_WordLength) +
+            slab_index * m_WordLength;
+    }
+
+private:
+    int m_WordLength = 0;
+};
+
+
+
+// Greedy filter: the candidate whose distinct letters occur in the most
+// candidates, i.e. which rules out the most candidates if they are missing
+class GreedyFilterStrategy
+    : public SimulationStrategy
+{
+public:
+    SimulationStrategy * Clone() const override
+    {
+        return new GreedyFilterStrategy(*this);
+    }
+    QString GetName() const override
+    {
+        return "greedy";
+    }
+    bool Prepare(const int mcWordLength) override
+    {
+        m_WordLength = mcWordLength;
+        return true;
+    }
+    const quint8 * PickGuess(CandidateFilter & mrFilter,
+        RandomStream & mrRandomStream) override
+    {
+        Q_UNUSED(mrRandomStream)
+
+        // Number of candidates containing each letter
+        AllWords * aw = AllWords::Instance();
+        const quint32 * letter_masks = aw -> GetSlabLetterMasks(m_WordLength);
+        const BitVector & candidates = mrFilter.GetCandidateBits();
+        const quint64 * words = candidates.GetWords();
+        const int num_words = candidates.GetNumberOfWords();
+        int letter_counts[26] = { 0 };
+        for (int word_index = 0;
+             word_index < num_words;
+             word_index++)
+        {
+            quint64 word = words[word_index];
+            while (word)
+            {
+                quint32 mask = letter_masks[64 * word_index +
+                    qCountTrailingZeroBits(word)];
+                while (mask)
+                {
+                    letter_counts[qCountTrailingZeroBits(mask)]++;
+                    mask &= mask - 1;
+                }
+                word &= word - 1;
+            }
+        }
+
+        // Best candidate (first one on ties)
+        int best_index = -1;
+        int best_score = -1;
+        for (int word_index = 0;
+             word_index < num_words;
+             word_index++)
+        {
+            quint64 word = words[word_index];
+            while (word)
+            {
+                const int slab_index =
+                    64 * word_index + qCountTrailingZeroBits(word);
+                quint32 mask = letter_masks[slab_index];
+                int score = 0;
+                while (mask)
+                {
+                    score += letter_counts[qCountTrailingZeroBits(mask)];
+                    mask &= mask - 1;
+                }
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_index = slab_index;
+                }
+                word &= word - 1;
+            }
+        }
+        return aw -> GetSlabLetters(m_WordLength) +
+            best_index * m_WordLength;
+    }
+
+private:
+    int m_WordLength = 0;
+};
+
+
+
+// Entropy solver: the guess with the most expected information (see
+// Solver); the opening guess is the same in every game, so it is ranked
+// once in Prepare()
+class EntropyStrategy
+    : public SimulationStrategy
+{
+public:
+    EntropyStrategy()
+    {
+        // Games run in parallel already
+        m_Solver.SetNumberOfThreads(1);
+    }
+    SimulationStrategy * Clone() const override
+    {
+        return new EntropyStrategy(*this);
+    }
+    QString GetName() const override
+    {
+        return "entropy";
+    }
+    bool Prepare(const int mcWordLength) override
+    {
+        if (mcWordLength > Solver::MAXIMUM_WORD_LENGTH)
+        {
+            return false;
+        }
+        m_WordLength = mcWordLength;
+
+        // Pattern matrix changes AllWords, so it must be there before games
+        // start
+        AllWords * aw = AllWords::Instance();
+        aw -> PreparePatternMatrix(mcWordLength);
+
+        // Opening guess
+        CandidateFilter filter;
+        filter.Reset(mcWordLength);
+        Solver solver;
+        const QList < QPair < quint32, double > > ranking =
+            solver.RankGuesses(filter, 1);
+        if (ranking.isEmpty())
+        {
+            return false;
+        }
+        m_Opening = aw -> GetPackedLetters(ranking.first().first);
+        return true;
+    }
+    const quint8 * PickGuess(CandidateFilter & mrFilter,
+        RandomStream & mrRandomStream) override
+    {
+        Q_UNUSED(mrRandomStream)
+
+        AllWords * aw = AllWords::Instance();
+        if (mrFilter.GetNumberOfGuesses() == 0)
+        {
+            return m_Opening;
+        }
+
+        // With two candidates left, no guess does better than one of them
+        const BitVector & candidates = mrFilter.GetCandidateBits();
+        if (candidates.GetCount() <= 2)
+        {
+            return aw -> GetSlabLetters(m_WordLength) +
+                candidates.Select(0) * m_WordLength;
+        }
+        const QList < QPair < quint32, double > > ranking =
+            m_Solver.RankGuesses(mrFilter, 1);
+        return aw -> GetPackedLetters(ranking.first().first);
+    }
+
+private:
+    int m_WordLength = 0;
+    const quint8 * m_Opening = nullptr;
+    Solver m_Solver;
+};
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+SimulationStrategy::SimulationStrategy()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+SimulationStrategy::~SimulationStrategy()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Strategy by name
+SimulationStrategy * SimulationStrategy::Create(const QString mcName)
+{
+    CALL_IN(QString("mcName=\"%1\"")
+        .arg(mcName));
+
+    SimulationStrategy * strategy = nullptr;
+    if (mcName == "random")
+    {
+        strategy = new RandomValidStrategy();
+    } else if (mcName == "greedy")
+    {
+        strategy = new GreedyFilterStrategy();
+    } else if (mcName == "entropy")
+    {
+        strategy = new EntropyStrategy();
+    } else
+    {
+        const QString reason = QObject::tr("Unknown strategy \"%1\".")
+            .arg(mcName);
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return nullptr;
+    }
+
+    CALL_OUT("");
+    return strategy;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Names of all strategies
+QList < QString > SimulationStrategy::GetNames()
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return QList < QString > { "random", "greedy", "entropy" };
+}
+
+
+
+// ==================================================================== Playing
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Prepare for a word length
+bool SimulationStrategy::Prepare(const int mcWordLength)
+{
+    CALL_IN(QString("mcWordLength=%1")
+        .arg(QString::number(mcWordLength)));
+
+    // Nothing to do.
+
+    CALL_OUT("");
+    return true;
+}
@@ -0,0 +1,64 @@
+// SimulationStrategy.h
+// Class definition
+
+#ifndef SIMULATIONSTRATEGY_H
+#define SIMULATIONSTRATEGY_H
+
+// Project includes
+#include "CandidateFilter.h"
+#include "RandomStream.h"
+
+// Qt includes
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+
+
+// Class definition
+class SimulationStrategy
+{
+    // A strategy picks the next guess in simulated games (see Simulation).
+    // Every worker thread plays with its own copy (see Clone()), so a
+    // strategy may keep state between calls without locking. New strategies
+    // derive from this class and are added to Create().
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    SimulationStrategy();
+
+    // Destructor
+    virtual ~SimulationStrategy();
+
+    // Strategy by name (nullptr if there is no such strategy)
+    static SimulationStrategy * Create(const QString mcName);
+
+    // Names of all strategies
+    static QList < QString > GetNames();
+
+    // Copy for another worker thread
+    virtual SimulationStrategy * Clone() const = 0;
+
+
+
+    // ================================================================ Playing
+public:
+    // Name
+    virtual QString GetName() const = 0;
+
+    // Called once before any games are played with a word length, from the
+    // thread running the simulation (e.g. for precomputing the opening
+    // guess; may use all threads). Returns false if the strategy cannot play
+    // words of that length.
+    virtual bool Prepare(const int mcWordLength);
+
+    // Letter codes of the next guess, given the feedback so far. Candidates
+    // are never empty as the answer always is one. mrRandomStream belongs to
+    // the game. This is called for every guess of every game, so it is not
+    // traced.
+    virtual const quint8 * PickGuess(CandidateFilter & mrFilter,
+        RandomStream & mrRandomStream) = 0;
+};
+
+#endif
@@ -0,0 +1,302 @@
+// Solver.cpp
+// Class definition
+
+// Project includes
+#include "AllWords.h"
+#include "Feedback.h"
+#include "MessageLogger.h"
+#include "ParallelLoop.h"
+#include "Solver.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QObject>
+#include <QtAlgorithms>
+
+// System includes
+#include <algorithm>
+#include <cmath>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+Solver::Solver()
+{
+    CALL_IN("");
+
+    SetNumberOfThreads(ParallelLoop::GetDefaultNumberOfThreads());
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+Solver::~Solver()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ==================================================================== Ranking
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest words we can rank guesses for
+const int Solver::MAXIMUM_WORD_LENGTH = 10;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Rank all guesses by expected information
+QList < QPair < quint32, double > > Solver::RankGuesses(
+    CandidateFilter & mrFilter, const int mcNumberOfGuesses)
+{
+    CALL_IN(QString("mrFilter=..., mcNumberOfGuesses=%1")
+        .arg(QString::number(mcNumberOfGuesses)));
+
+    // Check word length
+    const int length = mrFilter.GetWordLength();
+    if (length > MAXIMUM_WORD_LENGTH)
+    {
+        const QString reason =
+            QObject::tr("Cannot rank guesses for words of length %1.")
+                .arg(QString::number(length));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return QList < QPair < quint32, double > >();
+    }
+
+    // Nothing to rank without candidates
+    const BitVector & candidate_bits = mrFilter.GetCandidateBits();
+    const int num_candidates = candidate_bits.GetCount();
+    if (num_candidates == 0)
+    {
+        CALL_OUT("");
+        return QList < QPair < quint32, double > >();
+    }
+
+    // Guesses are all words of the right length
+    AllWords * aw = AllWords::Instance();
+    const int num_guesses = aw -> GetSlabSize(length);
+    const quint8 * guess_letters = aw -> GetSlabLetters(length);
+    const quint32 * guess_ids = aw -> GetSlabIDs(length);
+
+    // Feedback for words of up to five letters is precomputed
+    const quint8 * pattern_matrix = nullptr;
+    if (aw -> PreparePatternMatrix(length))
+    {
+        pattern_matrix = aw -> GetPatternMatrix(length);
+    }
+
+    // Collect candidates' slab indices (for the matrix lookup) or copy their
+    // letters next to each other for cache friendly scans
+    QList < int > candidate_indices;
+    QByteArray candidate_letters;
+    if (pattern_matrix)
+    {
+        candidate_indices.reserve(num_candidates);
+    } else
+    {
+        candidate_letters.reserve(num_candidates * length);
+    }
+    const quint64 * candidate_words = candidate_bits.GetWords();
+    for (int word_index = 0;
+         word_index < candidate_bits.GetNumberOfWords();
+         word_index++)
+    {
+        quint64 word = candidate_words[word_index];
+        while (word)
+        {
+            const int slab_index =
+                64 * word_index + qCountTrailingZeroBits(word);
+            if (pattern_matrix)
+            {
+                candidate_indices << slab_index;
+            } else
+            {
+                candidate_letters.append(reinterpret_cast < const char * >(
+                    guess_letters + slab_index * length), length);
+            }
+            word &= word - 1;
+        }
+    }
+    const int * answer_indices = candidate_indices.constData();
+    const quint8 * answers =
+        reinterpret_cast < const quint8 * >(candidate_letters.constData());
+
+    // k * log2(k) for all bucket sizes k
+    QList < double > k_log_k(num_candidates + 1, 0.);
+    for (int k = 2;
+         k <= num_candidates;
+         k++)
+    {
+        k_log_k[k] = k * std::log2(double(k));
+    }
+
+    // Expected information for every guess. Every guess is written by
+    // exactly one worker, so there is no need for locking.
+    QList < double > information(num_guesses, 0.);
+    double * information_data = information.data();
+    const double * k_log_k_data = k_log_k.constData();
+    const double log_candidates = std::log2(double(num_candidates));
+    const int num_codes = Feedback::GetNumberOfCodes(length);
+
+    // Histogram of feedback codes for each worker, and which entries it
+    // touched (one spare entry as we always write before checking)
+    QList < QList < quint32 > > histograms(m_NumberOfThreads,
+        QList < quint32 >(num_codes, 0));
+    QList < QList < quint32 > > touched_codes(m_NumberOfThreads,
+        QList < quint32 >(num_codes + 1, 0));
+
+    // Without a matrix, each worker scores a guess against all candidates
+    // in one batch
+    QList < QList < quint32 > > answer_codes(m_NumberOfThreads,
+        QList < quint32 >(pattern_matrix ? 0 : num_candidates));
+
+    // Every guess is independent
+    ParallelLoop::Run(num_guesses, 8, m_NumberOfThreads,
+        [&](const int mcWorker, const int mcFirstGuess, const int mcLastGuess)
+        {
+            quint32 * counts = histograms[mcWorker].data();
+            quint32 * touched = touched_codes[mcWorker].data();
+            for (int guess = mcFirstGuess;
+                 guess < mcLastGuess;
+                 guess++)
+            {
+                // Sort candidates into feedback buckets
+                int num_touched = 0;
+                if (pattern_matrix)
+                {
+                    const quint8 * row =
+                        pattern_matrix + qsizetype(guess) * num_guesses;
+                    for (int answer = 0;
+                         answer < num_candidates;
+                         answer++)
+                    {
+                        const quint32 code = row[answer_indices[answer]];
+                        touched[num_touched] = code;
+                        num_touched += (counts[code] == 0);
+                        counts[code]++;
+                    }
+                } else
+                {
+                    quint32 * codes = answer_codes[mcWorker].data();
+                    Feedback::ScoreBatch(guess_letters + guess * length,
+                        answers, num_candidates, length, codes);
+                    for (int answer = 0;
+                         answer < num_candidates;
+                         answer++)
+                    {
+                        const quint32 code = codes[answer];
+                        touched[num_touched] = code;
+                        num_touched += (counts[code] == 0);
+                        counts[code]++;
+                    }
+                }
+
+                // Entropy of the bucket distribution:
+                // log2(n) - sum(k log2 k) / n
+                double sum = 0.;
+                for (int index = 0;
+                     index < num_touched;
+                     index++)
+                {
+                    const quint32 code = touched[index];
+                    sum += k_log_k_data[counts[code]];
+                    counts[code] = 0;
+                }
+                information_data[guess] =
+                    log_candidates - sum / num_candidates;
+            }
+        });
+
+    // Pick the best ones
+    QList < int > order(num_guesses);
+    for (int guess = 0;
+         guess < num_guesses;
+         guess++)
+    {
+        order[guess] = guess;
+    }
+    const int num_results = qBound(0, mcNumberOfGuesses, num_guesses);
+    std::partial_sort(order.begin(), order.begin() + num_results, order.end(),
+        [&](const int mcA, const int mcB)
+        {
+            if (information_data[mcA] != information_data[mcB])
+            {
+                return information_data[mcA] > information_data[mcB];
+            }
+            const bool a_is_candidate =
+                (candidate_words[mcA / 64] >> (mcA % 64)) & 1;
+            const bool b_is_candidate =
+                (candidate_words[mcB / 64] >> (mcB % 64)) & 1;
+            if (a_is_candidate != b_is_candidate)
+            {
+                return a_is_candidate;
+            }
+            return mcA < mcB;
+        });
+    QList < QPair < quint32, double > > result;
+    for (int index = 0;
+         index < num_results;
+         index++)
+    {
+        const int guess = order[index];
+        result << qMakePair(guess_ids[guess], information_data[guess]);
+    }
+
+    CALL_OUT("");
+    return result;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of threads used for ranking
+void Solver::SetNumberOfThreads(const int mcNumberOfThreads)
+{
+    CALL_IN(QString("mcNumberOfThreads=%1")
+        .arg(QString::number(mcNumberOfThreads)));
+
+    // Check if number of threads is valid
+    if (mcNumberOfThreads < 1)
+    {
+        const QString reason = QObject::tr("Invalid number of threads %1.")
+            .arg(QString::number(mcNumberOfThreads));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_NumberOfThreads = mcNumberOfThreads;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of threads used for ranking
+int Solver::GetNumberOfThreads() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfThreads;
+}
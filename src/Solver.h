@@ -0,0 +1,48 @@
+// Solver.h
+// Class definition
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+// Project includes
+#include "CandidateFilter.h"
+
+// Qt includes
+#include <QList>
+#include <QPair>
+
+
+
+// Class definition
+class Solver
+{
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    Solver();
+
+    // Destructor
+    ~Solver();
+
+
+
+    // ================================================================ Ranking
+public:
+    // Longest words we can rank guesses for (3^10 feedback codes)
+    static const int MAXIMUM_WORD_LENGTH;
+
+    // Rank all words of the filter's word length as guesses by the expected
+    // information (in bits) their feedback gives about the remaining
+    // candidates. Returns word IDs and expected information of the best
+    // guesses, best first; ties go to guesses that may be the answer.
+    QList < QPair < quint32, double > > RankGuesses(
+        CandidateFilter & mrFilter, const int mcNumberOfGuesses);
+
+    // Number of threads used for ranking
+    void SetNumberOfThreads(const int mcNumberOfThreads);
+    int GetNumberOfThreads() const;
+private:
+    int m_NumberOfThreads;
+};
+
+#endif
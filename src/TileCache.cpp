@@ -0,0 +1,227 @@
+// TileCache.cpp
+// Class definition
+
+// Project includes
+#include "MessageLogger.h"
+#include "TileCache.h"
+#include "Tracing.h"
+
+// Qt includes
+#include <QFontMetrics>
+#include <QObject>
+#include <QPainter>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+TileCache::TileCache()
+{
+    CALL_IN("");
+
+    // Black on white until told otherwise
+    m_BackgroundColors << QColor(255,255,255);
+    m_TextColor = QColor(0,0,0);
+    m_HighlightColor = QColor(0,0,0);
+    m_DevicePixelRatio = 1.;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+TileCache::~TileCache()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ===================================================================== Access
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Letter for an empty tile
+const int TileCache::NO_LETTER = 26;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Most tiles kept (a few sizes of all tiles)
+const int TileCache::MAXIMUM_NUMBER_OF_TILES = 1024;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Colors
+void TileCache::SetColors(const QList < QColor > & mcrBackgroundColors,
+    const QColor & mcrTextColor, const QColor & mcrHighlightColor)
+{
+    CALL_IN(QString("mcrBackgroundColors=..., mcrTextColor=%1, "
+        "mcrHighlightColor=%2")
+        .arg(mcrTextColor.name(),
+             mcrHighlightColor.name()));
+
+    // Status is stored in two bits of the key
+    if (mcrBackgroundColors.isEmpty() ||
+        mcrBackgroundColors.size() > 4)
+    {
+        const QString reason = QObject::tr("Invalid number of colors %1.")
+            .arg(QString::number(mcrBackgroundColors.size()));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        return;
+    }
+
+    m_BackgroundColors = mcrBackgroundColors;
+    m_TextColor = mcrTextColor;
+    m_HighlightColor = mcrHighlightColor;
+    Clear();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Device pixel ratio tiles are rendered for
+void TileCache::SetDevicePixelRatio(const qreal mcRatio)
+{
+    CALL_IN(QString("mcRatio=%1")
+        .arg(QString::number(mcRatio)));
+
+    // Tiles for the old ratio would look blurry
+    if (mcRatio != m_DevicePixelRatio)
+    {
+        m_DevicePixelRatio = mcRatio;
+        Clear();
+    }
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Device pixel ratio tiles are rendered for
+qreal TileCache::GetDevicePixelRatio() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_DevicePixelRatio;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of tiles rendered so far
+int TileCache::GetNumberOfTiles() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Tiles.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Forget all tiles
+void TileCache::Clear()
+{
+    CALL_IN("");
+
+    m_Tiles.clear();
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Render a tile and keep it
+const QPixmap & TileCache::RenderTile(const quint32 mcKey,
+    const int mcLetter, const int mcStatus, const bool mcHighlighted,
+    const int mcSize)
+{
+    CALL_IN(QString("mcKey=%1, mcLetter=%2, mcStatus=%3, mcHighlighted=%4, "
+        "mcSize=%5")
+        .arg(QString::number(mcKey),
+             QString::number(mcLetter),
+             QString::number(mcStatus),
+             mcHighlighted ? "true" : "false",
+             QString::number(mcSize)));
+
+    // Check parameters (an empty tile is still a tile, so painting goes on)
+    if (mcLetter < 0 ||
+        mcLetter > NO_LETTER ||
+        mcStatus < 0 ||
+        mcStatus >= m_BackgroundColors.size() ||
+        mcSize < 1 ||
+        mcSize > 0xffff)
+    {
+        const QString reason = QObject::tr("Invalid tile (letter %1, "
+            "status %2, size %3).")
+            .arg(QString::number(mcLetter),
+                 QString::number(mcStatus),
+                 QString::number(mcSize));
+        MessageLogger::Error(CALL_METHOD,
+            reason);
+        CALL_OUT(reason);
+        static const QPixmap no_tile;
+        return no_tile;
+    }
+
+    // Letters fill three quarters of the tile
+    if (!m_Fonts.contains(mcSize))
+    {
+        QFont font;
+        font.setPixelSize(qMax(1, mcSize * 3 / 4));
+        m_Fonts[mcSize] = font;
+    }
+    const QFont & font = m_Fonts[mcSize];
+
+    // Background and frame (the frame is one pixel wider than the tile)
+    QPixmap tile(QSize(mcSize + 1, mcSize + 1) * m_DevicePixelRatio);
+    tile.setDevicePixelRatio(m_DevicePixelRatio);
+    tile.fill(Qt::transparent);
+    QPainter painter(&tile);
+    painter.fillRect(0, 0, mcSize, mcSize, m_BackgroundColors[mcStatus]);
+    painter.setPen(QColor(0,0,0));
+    painter.drawRect(0, 0, mcSize, mcSize);
+
+    // Letter, centered
+    if (mcLetter != NO_LETTER)
+    {
+        const QString text = QString(QChar('A' + mcLetter));
+        const QFontMetrics metrics(font);
+        painter.setFont(font);
+        painter.setPen(mcHighlighted ? m_HighlightColor : m_TextColor);
+        painter.drawText((mcSize - metrics.horizontalAdvance(text)) / 2,
+            mcSize * 3 / 4, text);
+    }
+    painter.end();
+
+    // Keep it (sizes no longer used go away eventually)
+    if (m_Tiles.size() >= MAXIMUM_NUMBER_OF_TILES)
+    {
+        Clear();
+    }
+    m_Tiles[mcKey] = tile;
+
+    CALL_OUT("");
+    return m_Tiles[mcKey];
+}
@@ -0,0 +1,98 @@
+// TileCache.h
+// Class definition
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+// Qt includes
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+
+
+
+// Class definition
+class TileCache
+{
+    // Pre-rendered letter tiles (background, frame and letter), so painting
+    // a tile is a single pixmap blit instead of filling, stroking and laying
+    // out text. Tiles are rendered on first use for every combination of
+    // letter, status and size, at the current device pixel ratio; changing
+    // the ratio or the colors starts over, and so does rendering more than
+    // MAXIMUM_NUMBER_OF_TILES tiles (e.g. sizes of a layout that depends on
+    // the window size, while resizing).
+    //
+    // GetTile() is called for every tile painted and is not traced.
+
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    TileCache();
+
+    // Destructor
+    ~TileCache();
+
+
+
+    // ================================================================= Access
+public:
+    // Letter for an empty tile (otherwise 0 for "a" to 25 for "z")
+    static const int NO_LETTER;
+
+    // Most tiles kept
+    static const int MAXIMUM_NUMBER_OF_TILES;
+
+    // Background color for each status (the status is an index into this
+    // list), and text colors for regular letters and highlighted ones
+    void SetColors(const QList < QColor > & mcrBackgroundColors,
+        const QColor & mcrTextColor, const QColor & mcrHighlightColor);
+
+    // Device pixel ratio tiles are rendered for
+    void SetDevicePixelRatio(const qreal mcRatio);
+    qreal GetDevicePixelRatio() const;
+
+    // Tile of mcSize x mcSize pixels (logical), plus one for the frame on
+    // the right and bottom; valid until the next call
+    inline const QPixmap & GetTile(const int mcLetter, const int mcStatus,
+        const bool mcHighlighted, const int mcSize)
+    {
+        const quint32 key = quint32(mcLetter)
+            | (quint32(mcStatus) << 5)
+            | (quint32(mcHighlighted) << 7)
+            | (quint32(mcSize) << 8);
+        const QHash < quint32, QPixmap >::const_iterator tile =
+            m_Tiles.constFind(key);
+        if (tile != m_Tiles.constEnd())
+        {
+            return tile.value();
+        }
+        return RenderTile(key, mcLetter, mcStatus, mcHighlighted, mcSize);
+    }
+
+    // Number of tiles rendered so far
+    int GetNumberOfTiles() const;
+
+    // Forget all tiles
+    void Clear();
+
+private:
+    // Render a tile and keep it
+    const QPixmap & RenderTile(const quint32 mcKey, const int mcLetter,
+        const int mcStatus, const bool mcHighlighted, const int mcSize);
+
+    // Settings
+    QList < QColor > m_BackgroundColors;
+    QColor m_TextColor;
+    QColor m_HighlightColor;
+    qreal m_DevicePixelRatio;
+
+    // Fonts by tile size
+    QHash < int, QFont > m_Fonts;
+
+    // Tiles by key (letter, status, highlight and size)
+    QHash < quint32, QPixmap > m_Tiles;
+};
+
+#endif
@@ -0,0 +1,74 @@
+// TracedCall.cpp
+// Class definition
+
+// Project includes
+#include "TracedCall.h"
+
+// Qt includes
+#include <QByteArray>
+
+// System includes
+#include <cstdio>
+
+
+
+// Call depth of the calling thread
+static thread_local int s_Depth = 0;
+
+
+
+// ==================================================================== Tracing
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+std::atomic < bool > TracedCall::m_Enabled {
+    qEnvironmentVariableIsSet("GUESSWORD_TRACE_CALLS") };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime switch
+void TracedCall::SetEnabled(const bool mcEnabled)
+{
+    m_Enabled.store(mcEnabled, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write entry
+void TracedCall::Enter(const QString & mcrArguments)
+{
+    const QByteArray indent(2 * s_Depth, ' ');
+    fprintf(stderr, "%s> %s (%s)\n", indent.constData(), m_Function,
+        qUtf8Printable(mcrArguments));
+    s_Depth++;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Write exit
+void TracedCall::Leave(const QString & mcrReason) const
+{
+    const QByteArray indent(2 * (s_Depth - 1), ' ');
+    if (mcrReason.isEmpty())
+    {
+        fprintf(stderr, "%s< %s\n", indent.constData(), m_Function);
+    } else
+    {
+        fprintf(stderr, "%s< %s: %s\n", indent.constData(), m_Function,
+            qUtf8Printable(mcrReason));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Function is done
+void TracedCall::Exit()
+{
+    s_Depth--;
+}
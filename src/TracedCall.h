@@ -0,0 +1,94 @@
+// TracedCall.h
+// Class definition
+
+#ifndef TRACEDCALL_H
+#define TRACEDCALL_H
+
+// Qt includes
+#include <QString>
+#include <QtGlobal>
+
+// System includes
+#include <atomic>
+
+
+
+// Class definition
+class TracedCall
+{
+    // Call tracing with arguments (GUESSWORD_TRACE_LEVEL 2, see Tracing.h).
+    // CALL_IN() and CALL_OUT() hand their arguments over as lambdas, which
+    // are only called - and the argument strings only formatted - while
+    // tracing is enabled at runtime; while off, a call costs one relaxed
+    // atomic load. Traced calls are written to stderr, indented by call
+    // depth (per thread). Tracing starts enabled if the environment
+    // variable GUESSWORD_TRACE_CALLS is set.
+    //
+    // Tracing is decided on entry, so a call that was entered while enabled
+    // is also left (and its depth restored) if tracing is disabled in
+    // between.
+
+    // ============================================================== Lifecycle
+public:
+    // Entering a function (mcpFunction must stay valid, e.g. Q_FUNC_INFO)
+    template < typename Arguments >
+    inline TracedCall(const char * mcpFunction,
+        const Arguments & mcrArguments)
+    {
+        m_Function = nullptr;
+        if (IsEnabled())
+        {
+            m_Function = mcpFunction;
+            Enter(mcrArguments());
+        }
+    }
+
+    // Function is done
+    inline ~TracedCall()
+    {
+        if (m_Function)
+        {
+            Exit();
+        }
+    }
+
+private:
+    // Not copied
+    TracedCall(const TracedCall & mcrOther) = delete;
+    TracedCall & operator=(const TracedCall & mcrOther) = delete;
+
+
+
+    // ================================================================ Tracing
+public:
+    // Runtime switch
+    static void SetEnabled(const bool mcEnabled);
+    static inline bool IsEnabled()
+    {
+        return m_Enabled.load(std::memory_order_relaxed);
+    }
+
+    // Leaving the function (with a reason if it failed)
+    template < typename Reason >
+    inline void Out(const Reason & mcrReason) const
+    {
+        if (m_Function)
+        {
+            Leave(mcrReason());
+        }
+    }
+
+private:
+    // Write entry and exit
+    void Enter(const QString & mcrArguments);
+    void Leave(const QString & mcrReason) const;
+    void Exit();
+
+    // Function (nullptr if the call is not traced)
+    const char * m_Function;
+
+    // Runtime switch
+    static std::atomic < bool > m_Enabled;
+};
+
+#endif
@@ -0,0 +1,84 @@
+// Tracing.h
+// Compile time switch for call tracing
+
+#ifndef TRACING_H
+#define TRACING_H
+
+// Include this instead of CallTracer.h. GUESSWORD_TRACE_LEVEL selects what
+// CALL_IN() and CALL_OUT() cost:
+//   0  nothing: the macros and their arguments are compiled out entirely,
+//      so argument lists are never formatted (release builds)
+//   1  function entry and exit go to the per-thread ring buffers of
+//      RingTracer once it is enabled at runtime; arguments are compiled
+//      out (profiling builds)
+//   2  calls are traced with arguments through TracedCall once it is
+//      enabled at runtime (default, i.e. debug builds)
+// Arguments are evaluated lazily at every level: at level 2 they are
+// wrapped in a lambda that is only called while tracing is enabled, so
+// the QString formatting in CALL_IN() costs nothing otherwise. Arguments
+// that take more than one expression to prepare (e.g. sorted ID lists) go
+// into an immediately called lambda within CALL_IN(), so they are lazy,
+// too.
+//
+// At level 1, the CallProfiler can also measure every traced call.
+//
+// CALL_MARK(payload) records a mark with a 32 bit payload (e.g. a number of
+// words) in the ring tracer; it must come after CALL_IN(). CALL_BLOCK(name)
+// traces the rest of the enclosing block as if it were a function of its
+// own (e.g. a costly Qt call). Both are compiled out unless the level is 1.
+#ifndef GUESSWORD_TRACE_LEVEL
+#define GUESSWORD_TRACE_LEVEL 2
+#endif
+
+// Project includes
+#include "CallTracer.h"
+#include "RingTracer.h"
+#include "TracedCall.h"
+
+// Unique names for variables declared by macros
+#define TRACING_CONCATENATE_(mcFirst, mcSecond) mcFirst##mcSecond
+#define TRACING_CONCATENATE(mcFirst, mcSecond) \
+    TRACING_CONCATENATE_(mcFirst, mcSecond)
+
+#if GUESSWORD_TRACE_LEVEL == 0
+#undef CALL_IN
+#undef CALL_OUT
+#define CALL_IN(mcArguments) do {} while (false)
+#define CALL_OUT(mcReason) do {} while (false)
+#define CALL_MARK(mcPayload) do {} while (false)
+#define CALL_BLOCK(mcName) do {} while (false)
+#elif GUESSWORD_TRACE_LEVEL == 1
+#undef CALL_IN
+#undef CALL_OUT
+#define CALL_IN(mcArguments) \
+    static const quint16 ring_tracer_function_id = \
+        RingTracer::InternFunction(Q_FUNC_INFO); \
+    const RingTracer::Scope ring_tracer_scope(ring_tracer_function_id)
+#define CALL_OUT(mcReason) do {} while (false)
+#define CALL_MARK(mcPayload) \
+    do \
+    { \
+        if (RingTracer::IsEnabled()) \
+        { \
+            RingTracer::Record(ring_tracer_function_id, \
+                RingTracer::Event_Mark, quint32(mcPayload)); \
+        } \
+    } while (false)
+#define CALL_BLOCK(mcName) \
+    static const quint16 TRACING_CONCATENATE(ring_tracer_block_id_, \
+        __LINE__) = RingTracer::InternBlock(Q_FUNC_INFO, mcName); \
+    const RingTracer::Scope TRACING_CONCATENATE(ring_tracer_block_, \
+        __LINE__)(TRACING_CONCATENATE(ring_tracer_block_id_, __LINE__))
+#else
+#undef CALL_IN
+#undef CALL_OUT
+#define CALL_IN(mcArguments) \
+    const TracedCall traced_call(Q_FUNC_INFO, \
+        [&]() { return QString(mcArguments); })
+#define CALL_OUT(mcReason) \
+    traced_call.Out([&]() { return QString(mcReason); })
+#define CALL_MARK(mcPayload) do {} while (false)
+#define CALL_BLOCK(mcName) do {} while (false)
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+// WordBlob.h
+// Class definition
+
+#ifndef WORDBLOB_H
+#define WORDBLOB_H
+
+// This header is shared between the application and the build time word
+// blob compiler (tools/WordBlobCompiler.cpp), so it only uses the standard
+// library.
+
+// System includes
+#include <cstdint>
+#include <cstring>
+
+
+
+// Class definition
+class WordBlob
+{
+    // ============================================================== Lifecycle
+private:
+    // Constructor - only static methods here
+    WordBlob();
+
+
+
+    // ================================================================= Format
+public:
+    // The blob holds the dictionary, validated, deduplicated and sorted
+    // (by length, then alphabetically) at build time. All numbers are 32 bit
+    // little endian; the blob may be at any alignment.
+    //
+    //   Header             HEADER_SIZE bytes
+    //     magic number, version, number of words, maximum word length,
+    //     hash seed, number of hash buckets
+    //   Partitions         (maximum word length + 1) entries of
+    //     offset of letters, first word ID, number of words
+    //   Displacements      one per hash bucket
+    //   Slots              word ID for each hash slot (one per word)
+    //   Weights            selection weight of each word (by word ID), as
+    //                      32 bit IEEE 754 floats (see ReadFloat())
+    //   Fingerprints       one byte of the hash of the word in each slot
+    //                      (padded to a multiple of 4 bytes)
+    //   Letters            letter codes (0 for "a" to 25 for "z"), partition
+    //                      by partition, words back to back
+    //
+    // Word IDs are the position of the word in sorted order, so every
+    // partition is a contiguous range of IDs. Weights (e.g. corpus
+    // frequency or a difficulty score) make a word proportionally more
+    // likely to be picked; 0 means it is valid but never picked.
+    static const uint32_t MAGIC = 0x42575747;
+    static const uint32_t VERSION = 3;
+    static const int HEADER_SIZE = 24;
+    static const int PARTITION_SIZE = 12;
+
+    // Longest word in a blob; this is also the longest word AllWords
+    // stores
+    static const int MAXIMUM_WORD_LENGTH = 32;
+
+    // Header fields (index of the 32 bit number)
+    enum HeaderField {
+        Header_Magic = 0,
+        Header_Version,
+        Header_NumberOfWords,
+        Header_MaximumWordLength,
+        Header_HashSeed,
+        Header_NumberOfBuckets
+    };
+
+    // Partition fields (index of the 32 bit number)
+    enum PartitionField {
+        Partition_LetterOffset = 0,
+        Partition_FirstWordID,
+        Partition_NumberOfWords
+    };
+
+    // Read/write a 32 bit little endian number at any alignment
+    static inline uint32_t Read(const uint8_t * mcpData)
+    {
+        return uint32_t(mcpData[0])
+            | (uint32_t(mcpData[1]) << 8)
+            | (uint32_t(mcpData[2]) << 16)
+            | (uint32_t(mcpData[3]) << 24);
+    }
+    static inline void Write(uint8_t * mpData, const uint32_t mcValue)
+    {
+        mpData[0] = uint8_t(mcValue);
+        mpData[1] = uint8_t(mcValue >> 8);
+        mpData[2] = uint8_t(mcValue >> 16);
+        mpData[3] = uint8_t(mcValue >> 24);
+    }
+
+    // Same for a 32 bit float
+    static inline float ReadFloat(const uint8_t * mcpData)
+    {
+        const uint32_t bits = Read(mcpData);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    static inline void WriteFloat(uint8_t * mpData, const float mcValue)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &mcValue, sizeof(bits));
+        Write(mpData, bits);
+    }
+
+    // Weight of words listed without one
+    static constexpr float DEFAULT_WEIGHT = 1.0f;
+
+
+
+    // =========================================================== Perfect hash
+public:
+    // Hash and displace: every word falls into a bucket, and every bucket has
+    // a displacement that sends its words to slots no other word uses. A
+    // lookup is therefore one hash, two table reads and one comparison.
+    // Most words that are not in the dictionary are already rejected by the
+    // fingerprint of their slot, without looking at any letters.
+
+    // Average number of words per bucket (fewer buckets make the table
+    // smaller but slower to build)
+    static const int WORDS_PER_BUCKET = 3;
+
+    // Hash of letter codes (64 bit FNV-1a with a seed, followed by a final
+    // avalanche so all bits depend on all letters)
+    static inline uint64_t Hash(const uint8_t * mcpLetters,
+        const int mcLength, const uint32_t mcSeed)
+    {
+        uint64_t hash = 14695981039346656037ull ^ mcSeed;
+        for (int index = 0;
+             index < mcLength;
+             index++)
+        {
+            hash = (hash ^ mcpLetters[index]) * 1099511628211ull;
+        }
+        hash ^= uint64_t(mcLength) << 56;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // Bucket for a hash
+    static inline uint32_t GetBucket(const uint64_t mcHash,
+        const uint32_t mcNumberOfBuckets)
+    {
+        return uint32_t((uint64_t(uint32_t(mcHash >> 32)) * mcNumberOfBuckets)
+            >> 32);
+    }
+
+    // Fingerprint for a hash (bits not used for the bucket index)
+    static inline uint8_t GetFingerprint(const uint64_t mcHash)
+    {
+        return uint8_t(mcHash >> 32);
+    }
+
+    // Slot for a hash and the displacement of its bucket
+    static inline uint32_t GetSlot(const uint64_t mcHash,
+        const uint32_t mcDisplacement, const uint32_t mcNumberOfSlots)
+    {
+        uint64_t mixed = (mcHash & 0xffffffffull)
+            ^ (uint64_t(mcDisplacement) * 0x9e3779b97f4a7c15ull);
+        mixed ^= mixed >> 29;
+        mixed *= 0xbf58476d1ce4e5b9ull;
+        mixed ^= mixed >> 32;
+        return uint32_t((uint64_t(uint32_t(mixed)) * mcNumberOfSlots) >> 32);
+    }
+};
+
+#endif
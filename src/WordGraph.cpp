@@ -0,0 +1,459 @@
+// WordGraph.cpp
+// Class definition
+
+// Project includes
+#include "MessageLogger.h"
+#include "Tracing.h"
+#include "WordGraph.h"
+
+// Qt includes
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QtAlgorithms>
+
+// System includes
+#include <algorithm>
+
+
+
+// ================================================================== Lifecycle
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor
+WordGraph::WordGraph()
+{
+    CALL_IN("");
+
+    // Empty graph: just the root
+    m_Nodes << Node { 0, 0, 0 };
+    m_NumberOfWords = 0;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+WordGraph::~WordGraph()
+{
+    CALL_IN("");
+
+    // Nothing to do.
+
+    CALL_OUT("");
+}
+
+
+
+// ====================================================================== Build
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Longest word the graph can hold
+const int WordGraph::MAXIMUM_WORD_LENGTH;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Build a minimized directed acyclic word graph
+void WordGraph::Build(QList < QByteArray > mWords)
+{
+    CALL_IN(QString("mWords=<%1 words>")
+        .arg(QString::number(mWords.size())));
+
+    // Sorted input lets us minimize while adding words (Daciuk et al.):
+    // once the next word no longer shares a prefix with the previous one,
+    // the nodes below that prefix are final and can be merged with an
+    // equivalent node we already have.
+    std::sort(mWords.begin(), mWords.end());
+
+    // Nodes while building; children are (letter, node) in letter order
+    struct BuildNode
+    {
+        QList < QPair < quint8, int > > m_Children;
+        quint64 m_SuffixLengths = 0;
+    };
+    QList < BuildNode > nodes(1);
+
+    // Equivalent nodes have the same suffix lengths and the same children
+    QHash < QByteArray, int > registry;
+
+    // Path of the previous word that has not been minimized yet
+    struct Unchecked
+    {
+        int m_Parent;
+        int m_Child;
+    };
+    QList < Unchecked > unchecked;
+    auto minimize = [&](const int mcDownTo)
+    {
+        while (unchecked.size() > mcDownTo)
+        {
+            const Unchecked entry = unchecked.takeLast();
+            BuildNode & child = nodes[entry.m_Child];
+            for (const QPair < quint8, int > & grandchild : child.m_Children)
+            {
+                child.m_SuffixLengths |=
+                    nodes[grandchild.second].m_SuffixLengths << 1;
+            }
+            QByteArray signature(reinterpret_cast < const char * >(
+                &child.m_SuffixLengths), sizeof(child.m_SuffixLengths));
+            for (const QPair < quint8, int > & grandchild : child.m_Children)
+            {
+                signature.append(char(grandchild.first));
+                signature.append(reinterpret_cast < const char * >(
+                    &grandchild.second), sizeof(grandchild.second));
+            }
+            const auto existing = registry.constFind(signature);
+            if (existing == registry.constEnd())
+            {
+                registry.insert(signature, entry.m_Child);
+            } else
+            {
+                nodes[entry.m_Parent].m_Children.last().second =
+                    existing.value();
+            }
+        }
+    };
+
+    // Add words
+    QByteArray previous;
+    int num_words = 0;
+    for (const QByteArray & word : mWords)
+    {
+        // Skip what we cannot store, and duplicates
+        const bool valid = !word.isEmpty() &&
+            word.size() <= MAXIMUM_WORD_LENGTH &&
+            std::all_of(word.begin(), word.end(),
+                [](const char mcLetter)
+                {
+                    return quint8(mcLetter) < 26;
+                });
+        if (!valid ||
+            word == previous)
+        {
+            continue;
+        }
+
+        // Minimize what is no longer shared with the previous word
+        int common = 0;
+        while (common < qMin(word.size(), previous.size()) &&
+            word[common] == previous[common])
+        {
+            common++;
+        }
+        minimize(common);
+
+        // Add the rest
+        int node = unchecked.isEmpty() ? 0 : unchecked.last().m_Child;
+        for (int index = common;
+             index < word.size();
+             index++)
+        {
+            nodes.append(BuildNode());
+            const int child = nodes.size() - 1;
+            nodes[node].m_Children << qMakePair(quint8(word[index]), child);
+            unchecked << Unchecked { node, child };
+            node = child;
+        }
+        nodes[node].m_SuffixLengths |= 1;
+        previous = word;
+        num_words++;
+    }
+    minimize(0);
+    for (const QPair < quint8, int > & child : nodes[0].m_Children)
+    {
+        nodes[0].m_SuffixLengths |= nodes[child.second].m_SuffixLengths << 1;
+    }
+
+    // Number the nodes still in use (breadth first, root is 0)
+    QList < int > compact_index(nodes.size(), -1);
+    QList < int > order;
+    order << 0;
+    compact_index[0] = 0;
+    for (int index = 0;
+         index < order.size();
+         index++)
+    {
+        for (const QPair < quint8, int > & child :
+            nodes[order[index]].m_Children)
+        {
+            if (compact_index[child.second] == -1)
+            {
+                compact_index[child.second] = order.size();
+                order << child.second;
+            }
+        }
+    }
+
+    // Compact representation
+    m_Nodes.clear();
+    m_Nodes.reserve(order.size());
+    m_EdgeTargets.clear();
+    for (const int build_index : order)
+    {
+        const BuildNode & build_node = nodes[build_index];
+        Node node { quint32(m_EdgeTargets.size()), 0,
+            build_node.m_SuffixLengths };
+        for (const QPair < quint8, int > & child : build_node.m_Children)
+        {
+            node.m_Letters |= quint32(1) << child.first;
+            m_EdgeTargets << quint32(compact_index[child.second]);
+        }
+        m_Nodes << node;
+    }
+    m_EdgeTargets.squeeze();
+    m_NumberOfWords = num_words;
+
+    CALL_OUT("");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of words
+int WordGraph::GetNumberOfWords() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_NumberOfWords;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of nodes
+int WordGraph::GetNumberOfNodes() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_Nodes.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of edges
+int WordGraph::GetNumberOfEdges() const
+{
+    CALL_IN("");
+
+    CALL_OUT("");
+    return m_EdgeTargets.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Memory used (in bytes)
+qint64 WordGraph::GetMemoryUsage() const
+{
+    CALL_IN("");
+
+    const qint64 memory = sizeof(*this)
+        + m_Nodes.capacity() * qint64(sizeof(Node))
+        + m_EdgeTargets.capacity() * qint64(sizeof(quint32));
+
+    CALL_OUT("");
+    return memory;
+}
+
+
+
+// ==================================================================== Queries
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Invalid node
+const quint32 WordGraph::INVALID_NODE = 0xffffffff;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Node reached by a sequence of letter codes
+quint32 WordGraph::FindNode(const quint8 * mcpLetters,
+    const int mcLength) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    // One step per letter
+    quint32 node = 0;
+    for (int index = 0;
+         index < mcLength;
+         index++)
+    {
+        const quint8 letter = mcpLetters[index];
+        const Node & current = m_Nodes[node];
+        const quint32 bit = quint32(1) << (letter & 31);
+        if (letter >= 26 ||
+            !(current.m_Letters & bit))
+        {
+            CALL_OUT("");
+            return INVALID_NODE;
+        }
+        node = m_EdgeTargets[current.m_FirstEdge
+            + qPopulationCount(current.m_Letters & (bit - 1))];
+    }
+
+    CALL_OUT("");
+    return node;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if the graph contains a word
+bool WordGraph::Contains(const quint8 * mcpLetters, const int mcLength) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength)));
+
+    const quint32 node = FindNode(mcpLetters, mcLength);
+
+    CALL_OUT("");
+    return node != INVALID_NODE &&
+        (m_Nodes[node].m_SuffixLengths & 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check if any word starts with the given letter codes
+bool WordGraph::IsPrefix(const quint8 * mcpLetters, const int mcLength,
+    const int mcWordLength) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2, mcWordLength=%3")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength),
+             QString::number(mcWordLength)));
+
+    // Follow the prefix
+    const quint32 node = FindNode(mcpLetters, mcLength);
+    if (node == INVALID_NODE)
+    {
+        CALL_OUT("");
+        return false;
+    }
+
+    // Any length will do
+    const quint64 suffix_lengths = m_Nodes[node].m_SuffixLengths;
+    if (mcWordLength == -1)
+    {
+        CALL_OUT("");
+        return suffix_lengths != 0;
+    }
+
+    // Specific length
+    const int remaining = mcWordLength - mcLength;
+    const bool is_prefix = remaining >= 0 &&
+        remaining <= MAXIMUM_WORD_LENGTH &&
+        ((suffix_lengths >> remaining) & 1);
+
+    CALL_OUT("");
+    return is_prefix;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Words starting with the given letter codes
+QList < QByteArray > WordGraph::GetWordsWithPrefix(const quint8 * mcpLetters,
+    const int mcLength, const int mcWordLength,
+    const int mcMaximumNumber) const
+{
+    CALL_IN(QString("mcpLetters=%1, mcLength=%2, mcWordLength=%3, "
+        "mcMaximumNumber=%4")
+        .arg(mcpLetters ? "..." : "nullptr",
+             QString::number(mcLength),
+             QString::number(mcWordLength),
+             QString::number(mcMaximumNumber)));
+
+    // Check if a node can still lead to a word we want; suffix lengths let
+    // us skip everything else
+    auto is_wanted = [&](const quint32 mcNode, const int mcDepth)
+    {
+        const quint64 suffix_lengths = m_Nodes[mcNode].m_SuffixLengths;
+        if (mcWordLength == -1)
+        {
+            return suffix_lengths != 0;
+        }
+        const int remaining = mcWordLength - mcDepth;
+        return remaining >= 0 &&
+            remaining <= MAXIMUM_WORD_LENGTH &&
+            ((suffix_lengths >> remaining) & 1) != 0;
+    };
+    auto is_result = [&](const quint32 mcNode, const int mcDepth)
+    {
+        return (m_Nodes[mcNode].m_SuffixLengths & 1) &&
+            (mcWordLength == -1 || mcDepth == mcWordLength);
+    };
+
+    // Follow the prefix
+    QList < QByteArray > words;
+    const quint32 start = FindNode(mcpLetters, mcLength);
+    if (start == INVALID_NODE ||
+        !is_wanted(start, mcLength) ||
+        mcMaximumNumber == 0)
+    {
+        CALL_OUT("");
+        return words;
+    }
+    QByteArray word(reinterpret_cast < const char * >(mcpLetters), mcLength);
+    if (is_result(start, mcLength))
+    {
+        words << word;
+    }
+
+    // Depth first, letters in order; every level remembers the node and
+    // the letters it has not visited yet
+    QList < QPair < quint32, quint32 > > stack;
+    stack << qMakePair(start, m_Nodes[start].m_Letters);
+    while (!stack.isEmpty() &&
+        (mcMaximumNumber == -1 || words.size() < mcMaximumNumber))
+    {
+        QPair < quint32, quint32 > & top = stack.last();
+        if (top.second == 0)
+        {
+            // Done with this node
+            stack.removeLast();
+            if (!stack.isEmpty())
+            {
+                word.chop(1);
+            }
+            continue;
+        }
+
+        // Next letter
+        const int letter = qCountTrailingZeroBits(top.second);
+        top.second &= top.second - 1;
+        const Node & current = m_Nodes[top.first];
+        const quint32 child = m_EdgeTargets[current.m_FirstEdge
+            + qPopulationCount(current.m_Letters
+                & ((quint32(1) << letter) - 1))];
+        const int depth = word.size() + 1;
+        if (!is_wanted(child, depth))
+        {
+            continue;
+        }
+        word.append(char(letter));
+        if (is_result(child, depth))
+        {
+            words << word;
+        }
+        stack << qMakePair(child, m_Nodes[child].m_Letters);
+    }
+
+    CALL_OUT("");
+    return words;
+}
@@ -0,0 +1,88 @@
+// WordGraph.h
+// Class definition
+
+#ifndef WORDGRAPH_H
+#define WORDGRAPH_H
+
+// Qt includes
+#include <QByteArray>
+#include <QList>
+
+
+
+// Class definition
+class WordGraph
+{
+    // ============================================================== Lifecycle
+public:
+    // Constructor
+    WordGraph();
+
+    // Destructor
+    ~WordGraph();
+
+
+
+    // ================================================================== Build
+public:
+    // Longest word the graph can hold
+    static const int MAXIMUM_WORD_LENGTH = 63;
+
+    // Build a minimized directed acyclic word graph from words given as
+    // letter codes (0 for "a" to 25 for "z"), in any order. Duplicates are
+    // ignored; words with invalid letters or that are too long are skipped.
+    void Build(QList < QByteArray > mWords);
+
+    // Size of the graph
+    int GetNumberOfWords() const;
+    int GetNumberOfNodes() const;
+    int GetNumberOfEdges() const;
+    qint64 GetMemoryUsage() const;
+
+private:
+    // A node knows which letters lead out of it (bit n for letter n) and
+    // the lengths of all suffixes that complete a word from here (bit n for
+    // n more letters; bit 0 means a word ends here). Its edges are stored
+    // back to back in letter order, so the edge for a letter is found by
+    // counting the bits below it.
+    struct Node
+    {
+        quint32 m_FirstEdge;
+        quint32 m_Letters;
+        quint64 m_SuffixLengths;
+    };
+
+    // Nodes (the root is node 0) and edge targets
+    QList < Node > m_Nodes;
+    QList < quint32 > m_EdgeTargets;
+
+    // Number of words
+    int m_NumberOfWords;
+
+
+
+    // ================================================================ Queries
+public:
+    // Invalid node
+    static const quint32 INVALID_NODE;
+
+    // Node reached by a sequence of letter codes (INVALID_NODE if none)
+    quint32 FindNode(const quint8 * mcpLetters, const int mcLength) const;
+
+    // Check if the graph contains a word
+    bool Contains(const quint8 * mcpLetters, const int mcLength) const;
+
+    // Check if any word starts with the given letter codes; if
+    // mcWordLength is not -1, the word must have that many letters
+    bool IsPrefix(const quint8 * mcpLetters, const int mcLength,
+        const int mcWordLength) const;
+
+    // Words starting with the given letter codes (with mcWordLength letters
+    // unless that is -1), in alphabetical order; at most mcMaximumNumber of
+    // them unless that is -1
+    QList < QByteArray > GetWordsWithPrefix(const quint8 * mcpLetters,
+        const int mcLength, const int mcWordLength,
+        const int mcMaximumNumber) const;
+};
+
+#endif
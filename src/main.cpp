@@ -3,8 +3,10 @@
 // Project includes
 #include "AllWords.h"
 #include "Application.h"
-#include "Deploy.h"
+#include "AsyncMessageLogger.h"
+#include "CallProfiler.h"
 #include "MainWindow.h"
+#include "RingTracer.h"
 
 // Qt includes
 #include <QDebug>
@@ -16,9 +18,27 @@
 // Main
 int main(int mNumParameters, char * mpParameter[])
 {
+    // Profiling builds record calls from the start if asked to, and dump
+    // them when done (see Tracing.h)
+    const QString trace_filename =
+        qEnvironmentVariable("GUESSWORD_TRACE_FILE");
+    if (!trace_filename.isEmpty())
+    {
+        RingTracer::SetEnabled(true);
+    }
+
+    // Same for the profiler (File > Profile does it on demand)
+    if (!qEnvironmentVariableIsEmpty("GUESSWORD_PROFILE"))
+    {
+        CallProfiler::SetEnabled(true);
+    }
+
     // Handle command line parameters for GUI
     Application * app = Application::Instance(mNumParameters, mpParameter);
 
+    // Errors from hot paths are written in the background
+    AsyncMessageLogger::Start();
+
     // Make sure main window is the active one
     MainWindow * main_window = MainWindow::Instance();
     main_window -> raise();
@@ -27,10 +47,22 @@ int main(int mNumParameters, char * mpParameter[])
     // Hand over control to the GUI
     const int result = app -> exec();
 
-    // Dump new words so we can put them in the dictionary
-    if (!DEPLOY)
+    // Make sure learned words are on disk
+    AllWords::Instance() -> FlushJournal();
+
+    // Errors still queued
+    AsyncMessageLogger::Stop();
+
+    // Calls recorded
+    if (!trace_filename.isEmpty())
+    {
+        RingTracer::SetEnabled(false);
+        RingTracer::Dump(trace_filename);
+    }
+    if (CallProfiler::IsEnabled())
     {
-        AllWords::Instance() -> DumpNewWords();
+        CallProfiler::SetEnabled(false);
+        CallProfiler::PrintReport();
     }
 
     // Done here
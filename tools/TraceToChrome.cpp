@@ -0,0 +1,267 @@
+// TraceToChrome.cpp
+// Converts a ring tracer dump (see src/RingTracer.h) to the Chrome trace
+// event JSON format, which chrome://tracing and ui.perfetto.dev can open.
+// Only uses the standard library.
+//
+// Usage: TraceToChrome <dump> <json>
+//
+// Dump format (all numbers little endian):
+//   magic number (uint32), version (uint32), number of functions (uint32),
+//   number of threads (uint32)
+//   for each function: name length (uint32), name
+//   for each thread: number of events (uint32), then for each event
+//     timestamp in nanoseconds (uint64), payload (uint32), function ID
+//     (uint16), type (uint8: 0 enter, 1 exit, 2 mark)
+
+// System includes
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+
+// Format of the dump (same as RingTracer::DUMP_MAGIC/DUMP_VERSION)
+static const uint32_t DUMP_MAGIC = 0x47575254;
+static const uint32_t DUMP_VERSION = 1;
+
+// Event types
+static const uint8_t EVENT_ENTER = 0;
+static const uint8_t EVENT_EXIT = 1;
+static const uint8_t EVENT_MARK = 2;
+
+// Event as stored in the dump
+struct Event
+{
+    uint64_t m_Timestamp;
+    uint32_t m_Payload;
+    uint16_t m_FunctionID;
+    uint8_t m_Type;
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Read a little endian number
+template < typename T >
+static bool Read(std::istream & mrIn, T & mrValue)
+{
+    unsigned char bytes[sizeof(T)];
+    if (!mrIn.read(reinterpret_cast < char * >(bytes), sizeof(T)))
+    {
+        return false;
+    }
+    mrValue = 0;
+    for (int index = int(sizeof(T)) - 1;
+         index >= 0;
+         index--)
+    {
+        mrValue = T((uint64_t(mrValue) << 8) | bytes[index]);
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Quote a string for JSON
+static std::string Quote(const std::string & mcrText)
+{
+    std::string quoted = "\"";
+    for (const char character : mcrText)
+    {
+        if (character == '"' ||
+            character == '\\')
+        {
+            quoted += '\\';
+            quoted += character;
+        } else if (static_cast < unsigned char >(character) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                unsigned(static_cast < unsigned char >(character)));
+            quoted += escaped;
+        } else
+        {
+            quoted += character;
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    if (mNumParameters != 3)
+    {
+        std::cerr << "Usage: " << mpParameter[0] << " <dump> <json>"
+            << std::endl;
+        return 1;
+    }
+
+    // Header
+    std::ifstream in(mpParameter[1], std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "Could not open \"" << mpParameter[1] << "\"."
+            << std::endl;
+        return 1;
+    }
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t num_functions = 0;
+    uint32_t num_threads = 0;
+    if (!Read(in, magic) ||
+        !Read(in, version) ||
+        !Read(in, num_functions) ||
+        !Read(in, num_threads) ||
+        magic != DUMP_MAGIC ||
+        version != DUMP_VERSION)
+    {
+        std::cerr << "\"" << mpParameter[1] << "\" is not a trace dump."
+            << std::endl;
+        return 1;
+    }
+
+    // Function names
+    std::vector < std::string > function_names;
+    for (uint32_t index = 0;
+         index < num_functions;
+         index++)
+    {
+        uint32_t length = 0;
+        std::string name;
+        if (Read(in, length))
+        {
+            name.resize(length);
+            in.read(&name[0], length);
+        }
+        if (!in)
+        {
+            std::cerr << "Dump is truncated." << std::endl;
+            return 1;
+        }
+        function_names.push_back(name);
+    }
+
+    // Events of all threads
+    std::vector < std::vector < Event > > threads(num_threads);
+    uint64_t start_time = UINT64_MAX;
+    for (std::vector < Event > & events : threads)
+    {
+        uint32_t num_events = 0;
+        if (!Read(in, num_events))
+        {
+            std::cerr << "Dump is truncated." << std::endl;
+            return 1;
+        }
+        events.resize(num_events);
+        for (Event & event : events)
+        {
+            if (!Read(in, event.m_Timestamp) ||
+                !Read(in, event.m_Payload) ||
+                !Read(in, event.m_FunctionID) ||
+                !Read(in, event.m_Type))
+            {
+                std::cerr << "Dump is truncated." << std::endl;
+                return 1;
+            }
+        }
+        if (!events.empty() &&
+            events.front().m_Timestamp < start_time)
+        {
+            start_time = events.front().m_Timestamp;
+        }
+    }
+
+    // Write trace events (timestamps in microseconds since the first event)
+    std::ofstream out(mpParameter[2]);
+    if (!out)
+    {
+        std::cerr << "Could not write \"" << mpParameter[2] << "\"."
+            << std::endl;
+        return 1;
+    }
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first_event = true;
+    auto write_event = [&](const std::string mcPhase, const int mcThread,
+        const uint16_t mcFunctionID, const uint64_t mcTimestamp,
+        const std::string mcExtra)
+    {
+        const std::string name = mcFunctionID < function_names.size() ?
+            function_names[mcFunctionID] : std::string("?");
+        char timestamp[32];
+        std::snprintf(timestamp, sizeof(timestamp), "%.3f",
+            double(mcTimestamp - start_time) / 1000.0);
+        out << (first_event ? "\n" : ",\n")
+            << "{\"name\":" << Quote(name)
+            << ",\"ph\":\"" << mcPhase << "\""
+            << ",\"ts\":" << timestamp
+            << ",\"pid\":1,\"tid\":" << mcThread
+            << mcExtra << "}";
+        first_event = false;
+    };
+    int num_written = 0;
+    for (size_t thread = 0;
+         thread < threads.size();
+         thread++)
+    {
+        // The ring buffer may have overwritten the entry of calls whose exit
+        // we still have; those exits are dropped. Calls still open at the end
+        // are closed at the last timestamp.
+        std::vector < uint16_t > open_calls;
+        uint64_t last_timestamp = start_time;
+        for (const Event & event : threads[thread])
+        {
+            last_timestamp = event.m_Timestamp;
+            if (event.m_Type == EVENT_ENTER)
+            {
+                open_calls.push_back(event.m_FunctionID);
+                write_event("B", int(thread), event.m_FunctionID,
+                    event.m_Timestamp, "");
+            } else if (event.m_Type == EVENT_EXIT)
+            {
+                if (open_calls.empty())
+                {
+                    continue;
+                }
+                open_calls.pop_back();
+                write_event("E", int(thread), event.m_FunctionID,
+                    event.m_Timestamp, "");
+            } else if (event.m_Type == EVENT_MARK)
+            {
+                write_event("i", int(thread), event.m_FunctionID,
+                    event.m_Timestamp, ",\"s\":\"t\",\"args\":{\"payload\":"
+                        + std::to_string(event.m_Payload) + "}");
+            } else
+            {
+                continue;
+            }
+            num_written++;
+        }
+        while (!open_calls.empty())
+        {
+            write_event("E", int(thread), open_calls.back(), last_timestamp,
+                "");
+            open_calls.pop_back();
+        }
+    }
+    out << "\n]}\n";
+    if (!out)
+    {
+        std::cerr << "Could not write \"" << mpParameter[2] << "\"."
+            << std::endl;
+        return 1;
+    }
+
+    std::cout << num_written << " events from " << threads.size()
+        << " threads, " << function_names.size() << " functions."
+        << std::endl;
+    return 0;
+}
@@ -0,0 +1,356 @@
+// WordBlobCompiler.cpp
+// Build time tool: turns the word list into the dictionary blob (see
+// src/WordBlob.h). Only uses the standard library so the build can compile
+// and run it before anything else.
+//
+// Usage: WordBlobCompiler <word list> <blob>
+//
+// Every line of the word list holds a word, optionally followed by its
+// weight (see WordBlob.h); lines starting with "#" are comments.
+
+// Project includes
+#include "WordBlob.h"
+
+// System includes
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+
+// Give up on a hash seed after this many displacements for a single bucket
+static const uint32_t MAXIMUM_DISPLACEMENT = 1u << 20;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Read, validate and deduplicate the word list; every line holds a word,
+// optionally followed by its weight
+static bool ReadWords(const std::string mcFileName,
+    std::vector < std::string > & mrWords, std::vector < float > & mrWeights)
+{
+    std::ifstream in(mcFileName);
+    if (!in)
+    {
+        std::cerr << "Could not open \"" << mcFileName << "\"." << std::endl;
+        return false;
+    }
+
+    // Same rules as reading the list at runtime used to have
+    std::unordered_set < std::string > known;
+    std::vector < std::pair < std::string, float > > entries;
+    std::string line;
+    int line_number = 0;
+    int num_problems = 0;
+    while (std::getline(in, line))
+    {
+        line_number++;
+
+        // Trim and convert to lower case
+        const size_t first = line.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos)
+        {
+            // Ignore empty lines
+            continue;
+        }
+        const size_t last = line.find_last_not_of(" \t\r\n");
+        std::string word = line.substr(first, last - first + 1);
+        std::transform(word.begin(), word.end(), word.begin(),
+            [](const unsigned char mcCharacter)
+            {
+                return char(std::tolower(mcCharacter));
+            });
+
+        // Ignore potential comments
+        if (word[0] == '#')
+        {
+            continue;
+        }
+
+        // Weight, if there is one (finite and not negative)
+        float weight = WordBlob::DEFAULT_WEIGHT;
+        const size_t separator = word.find_first_of(" \t");
+        if (separator != std::string::npos)
+        {
+            const std::string weight_text =
+                word.substr(word.find_first_not_of(" \t", separator));
+            word.resize(separator);
+            char * weight_end = nullptr;
+            weight = std::strtof(weight_text.c_str(), &weight_end);
+            if (*weight_end != 0 ||
+                !std::isfinite(weight) ||
+                weight < 0)
+            {
+                std::cerr << mcFileName << ":" << line_number
+                    << ": invalid weight \"" << weight_text << "\""
+                    << std::endl;
+                num_problems++;
+                continue;
+            }
+        }
+
+        // Make sure there are no invalid characters
+        const bool valid = int(word.size()) <= WordBlob::MAXIMUM_WORD_LENGTH &&
+            std::all_of(word.begin(), word.end(),
+                [](const char mcCharacter)
+                {
+                    return mcCharacter >= 'a' && mcCharacter <= 'z';
+                });
+        if (!valid)
+        {
+            std::cerr << mcFileName << ":" << line_number
+                << ": invalid word \"" << word << "\"" << std::endl;
+            num_problems++;
+            continue;
+        }
+
+        // Make sure there are no duplicates
+        if (!known.insert(word).second)
+        {
+            std::cerr << mcFileName << ":" << line_number
+                << ": duplicate word \"" << word << "\"" << std::endl;
+            num_problems++;
+            continue;
+        }
+
+        entries.push_back(std::make_pair(word, weight));
+    }
+    if (num_problems > 0)
+    {
+        std::cerr << num_problems << " word(s) skipped." << std::endl;
+    }
+
+    // Sort by length, then alphabetically
+    std::sort(entries.begin(), entries.end(),
+        [](const std::pair < std::string, float > & mcrA,
+            const std::pair < std::string, float > & mcrB)
+        {
+            if (mcrA.first.size() != mcrB.first.size())
+            {
+                return mcrA.first.size() < mcrB.first.size();
+            }
+            return mcrA.first < mcrB.first;
+        });
+    for (const std::pair < std::string, float > & entry : entries)
+    {
+        mrWords.push_back(entry.first);
+        mrWeights.push_back(entry.second);
+    }
+
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Find displacements so every word has its own slot; returns false if this
+// seed does not work
+static bool BuildPerfectHash(const std::vector < std::string > & mcrLetters,
+    const uint32_t mcSeed, std::vector < uint32_t > & mrDisplacements,
+    std::vector < uint32_t > & mrSlots)
+{
+    const uint32_t num_words = uint32_t(mcrLetters.size());
+    const uint32_t num_buckets = uint32_t(mrDisplacements.size());
+
+    // Sort words into buckets
+    std::vector < uint64_t > hashes(num_words);
+    std::vector < std::vector < uint32_t > > buckets(num_buckets);
+    for (uint32_t word_id = 0;
+         word_id < num_words;
+         word_id++)
+    {
+        const std::string & letters = mcrLetters[word_id];
+        hashes[word_id] = WordBlob::Hash(
+            reinterpret_cast < const uint8_t * >(letters.data()),
+            int(letters.size()), mcSeed);
+        buckets[WordBlob::GetBucket(hashes[word_id], num_buckets)]
+            .push_back(word_id);
+    }
+
+    // Place large buckets first, while there are many free slots
+    std::vector < uint32_t > order(num_buckets);
+    for (uint32_t bucket = 0;
+         bucket < num_buckets;
+         bucket++)
+    {
+        order[bucket] = bucket;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&](const uint32_t mcA, const uint32_t mcB)
+        {
+            return buckets[mcA].size() > buckets[mcB].size();
+        });
+
+    // Try displacements until all words of a bucket land in free slots
+    const uint32_t no_word = 0xffffffff;
+    mrSlots.assign(num_words, no_word);
+    std::vector < uint32_t > slots;
+    for (const uint32_t bucket : order)
+    {
+        const std::vector < uint32_t > & word_ids = buckets[bucket];
+        if (word_ids.empty())
+        {
+            mrDisplacements[bucket] = 0;
+            continue;
+        }
+        uint32_t displacement = 0;
+        for (;
+             displacement < MAXIMUM_DISPLACEMENT;
+             displacement++)
+        {
+            slots.clear();
+            bool free = true;
+            for (const uint32_t word_id : word_ids)
+            {
+                const uint32_t slot = WordBlob::GetSlot(hashes[word_id],
+                    displacement, num_words);
+                if (mrSlots[slot] != no_word ||
+                    std::find(slots.begin(), slots.end(), slot) != slots.end())
+                {
+                    free = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (free)
+            {
+                break;
+            }
+        }
+        if (displacement == MAXIMUM_DISPLACEMENT)
+        {
+            return false;
+        }
+        mrDisplacements[bucket] = displacement;
+        for (size_t index = 0;
+             index < word_ids.size();
+             index++)
+        {
+            mrSlots[slots[index]] = word_ids[index];
+        }
+    }
+
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+int main(int mNumParameters, char * mpParameter[])
+{
+    if (mNumParameters != 3)
+    {
+        std::cerr << "Usage: " << mpParameter[0] << " <word list> <blob>"
+            << std::endl;
+        return 1;
+    }
+
+    // Words, as letter codes
+    std::vector < std::string > words;
+    std::vector < float > weights;
+    if (!ReadWords(mpParameter[1], words, weights))
+    {
+        return 1;
+    }
+    std::vector < std::string > letters(words);
+    for (std::string & word : letters)
+    {
+        for (char & letter : word)
+        {
+            letter = char(letter - 'a');
+        }
+    }
+    const uint32_t num_words = uint32_t(words.size());
+
+    // Perfect hash; try other seeds in the (unlikely) case we get stuck
+    const uint32_t num_buckets =
+        num_words / WordBlob::WORDS_PER_BUCKET + 1;
+    std::vector < uint32_t > displacements(num_buckets);
+    std::vector < uint32_t > slots;
+    uint32_t seed = 0;
+    while (!BuildPerfectHash(letters, seed, displacements, slots))
+    {
+        seed++;
+    }
+
+    // Partitions
+    std::vector < uint32_t > partitions(
+        3 * (WordBlob::MAXIMUM_WORD_LENGTH + 1), 0);
+    uint32_t letter_offset = 0;
+    for (uint32_t word_id = 0;
+         word_id < num_words;
+         word_id++)
+    {
+        const int length = int(words[word_id].size());
+        uint32_t * partition = &partitions[3 * length];
+        if (partition[WordBlob::Partition_NumberOfWords] == 0)
+        {
+            partition[WordBlob::Partition_LetterOffset] = letter_offset;
+            partition[WordBlob::Partition_FirstWordID] = word_id;
+        }
+        partition[WordBlob::Partition_NumberOfWords]++;
+        letter_offset += length;
+    }
+
+    // Put everything together
+    std::vector < uint32_t > numbers = {
+        WordBlob::MAGIC,
+        WordBlob::VERSION,
+        num_words,
+        uint32_t(WordBlob::MAXIMUM_WORD_LENGTH),
+        seed,
+        num_buckets };
+    numbers.insert(numbers.end(), partitions.begin(), partitions.end());
+    numbers.insert(numbers.end(), displacements.begin(),
+        displacements.end());
+    numbers.insert(numbers.end(), slots.begin(), slots.end());
+    std::vector < uint8_t > blob(4 * (numbers.size() + weights.size()));
+    for (size_t index = 0;
+         index < numbers.size();
+         index++)
+    {
+        WordBlob::Write(&blob[4 * index], numbers[index]);
+    }
+    for (size_t index = 0;
+         index < weights.size();
+         index++)
+    {
+        WordBlob::WriteFloat(&blob[4 * (numbers.size() + index)],
+            weights[index]);
+    }
+    for (const uint32_t word_id : slots)
+    {
+        const std::string & word = letters[word_id];
+        blob.push_back(WordBlob::GetFingerprint(WordBlob::Hash(
+            reinterpret_cast < const uint8_t * >(word.data()),
+            int(word.size()), seed)));
+    }
+    blob.resize((blob.size() + 3) / 4 * 4, 0);
+    for (const std::string & word : letters)
+    {
+        blob.insert(blob.end(), word.begin(), word.end());
+    }
+
+    // Write blob
+    std::ofstream out(mpParameter[2], std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast < const char * >(blob.data()), blob.size());
+    out.close();
+    if (!out)
+    {
+        std::cerr << "Could not write \"" << mpParameter[2] << "\"."
+            << std::endl;
+        std::remove(mpParameter[2]);
+        return 1;
+    }
+
+    return 0;
+}